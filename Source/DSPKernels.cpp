@@ -0,0 +1,67 @@
+#include "DSPKernelsImpl.h"
+#include <juce_core/juce_core.h>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+static constexpr DSPKernels baselineKernels = makeKernels(DSPKernels::Isa::sse2, "SSE2");
+#else
+static constexpr DSPKernels baselineKernels = makeKernels(DSPKernels::Isa::generic, "Generic");
+#endif
+
+// Set by the build when the AVX2/AVX-512 translation units get their code generation flags
+#if FDNR_X86_KERNELS
+extern const DSPKernels dspKernelsAVX2;
+extern const DSPKernels dspKernelsAVX512;
+
+ #if defined(_MSC_VER)
+  #include <intrin.h>
+ #else
+  #include <cpuid.h>
+ #endif
+
+// Both variants convert half floats with F16C, which JUCE doesn't report
+static bool hasF16C()
+{
+    unsigned int info[4] = {};
+   #if defined(_MSC_VER)
+    __cpuid(reinterpret_cast<int*>(info), 1);
+   #else
+    __get_cpuid(1, &info[0], &info[1], &info[2], &info[3]);
+   #endif
+    return (info[2] & (1u << 29)) != 0;
+}
+#endif
+
+const DSPKernels& DSPKernels::getBaseline()
+{
+    return baselineKernels;
+}
+
+const DSPKernels* DSPKernels::getVariant(Isa isa)
+{
+    if (isa == baselineKernels.isa)
+        return &baselineKernels;
+
+   #if FDNR_X86_KERNELS
+    if (isa == Isa::avx2 && juce::SystemStats::hasAVX2() && juce::SystemStats::hasFMA3() && hasF16C())
+        return &dspKernelsAVX2;
+
+    if (isa == Isa::avx512 && juce::SystemStats::hasAVX512F() && hasF16C())
+        return &dspKernelsAVX512;
+   #endif
+
+    return nullptr;
+}
+
+const DSPKernels& DSPKernels::get()
+{
+    static const DSPKernels& best = []() -> const DSPKernels&
+    {
+        for (auto isa : { Isa::avx512, Isa::avx2 })
+            if (auto* kernels = getVariant(isa))
+                return *kernels;
+
+        return baselineKernels;
+    }();
+
+    return best;
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <cstdint>
+
+// Hot DSP kernels, compiled once per instruction set and picked at runtime by CPUID.
+// Every variant is built from the same source (DSPKernelsImpl.h) without FP contraction,
+// so all of them produce identical output.
+struct DSPKernels
+{
+    enum class Isa { generic, sse2, avx2, avx512 };
+
+    Isa isa;
+    const char* name;
+
+    // Bank of damped feedback combs. lines holds numSamples rows of numLines delayed samples;
+    // each row is replaced by the values to write back, and its sum goes to output.
+    // damp and feedback are ramped by their step before every sample.
+    void (*combBank) (float* lines, const float* input, float* output, float* filterState, int numLines, int numSamples,
+                      float damp, float dampStep, float feedback, float feedbackStep);
+
+    // Same, with the filter state and line sum carried in double precision (offline renders)
+    void (*combBankPrecise) (float* lines, const float* input, float* output, float* filterState, int numLines, int numSamples,
+                             float damp, float dampStep, float feedback, float feedbackStep);
+
+    // Four delay lines fed back through a Hadamard matrix. lines[j] holds numSamples + 1
+    // delayed samples of line j, oldest first, and its first numSamples are replaced by the
+    // values to write back: input[t] with signs + - + -, plus the Hadamard mix of every line
+    // through its two-tap lowpass, gains[j] * d[t] + lowpassGains[j] * d[t + 1].
+    void (*velvetLines) (float* const* lines, const float* input, const float* gains, const float* lowpassGains, int numSamples);
+
+    // Sparse +-1 taps: dest[i] = the sum of positive[k][i] less the sum of negative[k][i],
+    // over tapsPerSign taps of each sign
+    void (*velvetTaps) (float* dest, const float* const* positive, const float* const* negative, int tapsPerSign, int numSamples);
+
+    // dest = dest * dryGain + wet * wetGain
+    void (*mix) (float* dest, const float* wet, float dryGain, float wetGain, int numSamples);
+
+    // Mid/side rebalance of a stereo pair in place
+    void (*midSide) (float* left, float* right, float midGain, float sideGain, int numSamples);
+
+    // The output stage in one pass: dest = dest * dryGain + wet * wetGain, or dest = wet
+    // exactly for dryGain 0 and wetGain 1. Returns the largest magnitude written, the
+    // limiter's block peak. wet is left as it was.
+    float (*mixPeak) (float* dest, const float* wet, float dryGain, float wetGain, int numSamples);
+
+    // Same for a stereo pair, with midSide's rebalance applied to the wet pair on the way
+    float (*mixMidSidePeak) (float* left, float* right, const float* wetLeft, const float* wetRight,
+                             float midGain, float sideGain, float dryGain, float wetGain, int numSamples);
+
+    // Per-sample peak across channels, the input of the envelope detectors
+    void (*maxAbs) (float* dest, const float* const* channels, int numChannels, int numSamples);
+
+    // True if any sample is NaN, infinite, or larger in magnitude than limit
+    bool (*outOfRange) (const float* samples, int numSamples, float limit);
+
+    // 16-bit delay memory. Half floats round to nearest even. Int16 spans +-range, with
+    // triangular dither hashed from ditherIndex + i, so the bits don't depend on how a line
+    // is split into blocks.
+    void (*encodeHalf) (uint16_t* dest, const float* src, int numSamples);
+    void (*decodeHalf) (float* dest, const uint16_t* src, int numSamples);
+    void (*encodeInt16) (int16_t* dest, const float* src, int numSamples, float range, uint32_t ditherIndex);
+    void (*decodeInt16) (float* dest, const int16_t* src, int numSamples, float range);
+
+    // Best variant for this CPU, chosen once on first use
+    static const DSPKernels& get();
+
+    // The variant every CPU of this architecture can run (SSE2 on x86)
+    static const DSPKernels& getBaseline();
+
+    // A specific variant, or nullptr if it wasn't built or this CPU can't run it
+    static const DSPKernels* getVariant(Isa isa);
+};
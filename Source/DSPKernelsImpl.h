@@ -0,0 +1,472 @@
+#pragma once
+#include "DSPKernels.h"
+#include <cstring>
+
+// Half float conversion instructions, in the AVX2 and AVX-512 variants (MSVC has no macro for
+// them, its /arch:AVX2 allows them)
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+ #define FDNR_F16C 1
+ #include <immintrin.h>
+#else
+ #define FDNR_F16C 0
+#endif
+
+// Kernel bodies, included by one translation unit per instruction set. Everything is in an
+// anonymous namespace and stays clear of standard library inlines, so the linker can never
+// merge a copy built for one ISA with a copy built for another.
+namespace
+{
+    inline float absValue(float x) { return x < 0.0f ? -x : x; }
+    inline float maxValue(float a, float b) { return a < b ? b : a; }
+
+    inline uint32_t floatBits(float x) { uint32_t bits; std::memcpy(&bits, &x, sizeof(bits)); return bits; }
+    inline float bitsToFloat(uint32_t bits) { float x; std::memcpy(&x, &bits, sizeof(x)); return x; }
+
+    // As a mask rather than a branch, which keeps the conversion loops vectorisable
+    inline uint32_t selectBits(bool condition, uint32_t a, uint32_t b)
+    {
+        const uint32_t mask = 0u - (uint32_t)condition;
+        return (a & mask) | (b & ~mask);
+    }
+
+    // Accumulator is float for playback, double for the offline profile: each expression is
+    // evaluated at that precision and rounded once, when it is stored back as float. Keeping
+    // the stored state float means the result doesn't depend on how the block is split.
+    template <int NumLines, typename Accumulator>
+    void combBankFixed(float* lines, const float* input, float* output, float* filterState, int numSamples,
+                       float damp, float dampStep, float feedback, float feedbackStep)
+    {
+        float state[(size_t)NumLines];
+        for (int k = 0; k < NumLines; ++k)
+            state[k] = filterState[k];
+
+        for (int t = 0; t < numSamples; ++t)
+        {
+            damp += dampStep;
+            feedback += feedbackStep;
+
+            const float in = input[t];
+            const Accumulator keep = 1.0f - damp;
+            float* row = lines + t * NumLines;
+
+            // Summed in line order so every variant rounds the same way
+            Accumulator sum = 0;
+            for (int k = 0; k < NumLines; ++k)
+                sum += row[k];
+            output[t] = (float)sum;
+
+            for (int k = 0; k < NumLines; ++k)
+            {
+                state[k] = (float)(row[k] * keep + (Accumulator)state[k] * damp);
+                row[k] = (float)(in + (Accumulator)state[k] * feedback);
+            }
+        }
+
+        for (int k = 0; k < NumLines; ++k)
+            filterState[k] = state[k];
+    }
+
+    template <typename Accumulator>
+    void combBankGeneric(float* lines, const float* input, float* output, float* filterState, int numLines, int numSamples,
+                         float damp, float dampStep, float feedback, float feedbackStep)
+    {
+        // Half a bank under load shedding, a bank, and the offline double bank
+        if (numLines == 4)
+        {
+            combBankFixed<4, Accumulator>(lines, input, output, filterState, numSamples, damp, dampStep, feedback, feedbackStep);
+            return;
+        }
+
+        if (numLines == 8)
+        {
+            combBankFixed<8, Accumulator>(lines, input, output, filterState, numSamples, damp, dampStep, feedback, feedbackStep);
+            return;
+        }
+
+        if (numLines == 16)
+        {
+            combBankFixed<16, Accumulator>(lines, input, output, filterState, numSamples, damp, dampStep, feedback, feedbackStep);
+            return;
+        }
+
+        for (int t = 0; t < numSamples; ++t)
+        {
+            damp += dampStep;
+            feedback += feedbackStep;
+
+            const float in = input[t];
+            const Accumulator keep = 1.0f - damp;
+            float* row = lines + t * numLines;
+
+            Accumulator sum = 0;
+            for (int k = 0; k < numLines; ++k)
+                sum += row[k];
+            output[t] = (float)sum;
+
+            for (int k = 0; k < numLines; ++k)
+            {
+                filterState[k] = (float)(row[k] * keep + (Accumulator)filterState[k] * damp);
+                row[k] = (float)(in + (Accumulator)filterState[k] * feedback);
+            }
+        }
+    }
+
+    void combBank(float* lines, const float* input, float* output, float* filterState, int numLines, int numSamples,
+                  float damp, float dampStep, float feedback, float feedbackStep)
+    {
+        combBankGeneric<float>(lines, input, output, filterState, numLines, numSamples, damp, dampStep, feedback, feedbackStep);
+    }
+
+    void combBankPrecise(float* lines, const float* input, float* output, float* filterState, int numLines, int numSamples,
+                         float damp, float dampStep, float feedback, float feedbackStep)
+    {
+        combBankGeneric<double>(lines, input, output, filterState, numLines, numSamples, damp, dampStep, feedback, feedbackStep);
+    }
+
+    // The velvet kernels work in runs of velvetRun samples through local arrays: all loads of
+    // a run come before its stores, so the loops vectorise without alias checks between the
+    // many pointers
+    constexpr int velvetRun = 8;
+
+    void velvetLines(float* const* lines, const float* input, const float* gains, const float* lowpassGains, int numSamples)
+    {
+        float* d0 = lines[0];
+        float* d1 = lines[1];
+        float* d2 = lines[2];
+        float* d3 = lines[3];
+        const float g0 = gains[0], g1 = gains[1], g2 = gains[2], g3 = gains[3];
+        const float l0 = lowpassGains[0], l1 = lowpassGains[1], l2 = lowpassGains[2], l3 = lowpassGains[3];
+
+        // Each sample is written after the one after it was read, so the lines update in place
+        auto run = [&](int t, int count)
+        {
+            float w0[velvetRun], w1[velvetRun], w2[velvetRun], w3[velvetRun];
+
+            for (int i = 0; i < count; ++i)
+            {
+                const float f0 = d0[t + i] * g0 + d0[t + i + 1] * l0;
+                const float f1 = d1[t + i] * g1 + d1[t + i + 1] * l1;
+                const float f2 = d2[t + i] * g2 + d2[t + i + 1] * l2;
+                const float f3 = d3[t + i] * g3 + d3[t + i + 1] * l3;
+
+                const float sum01 = f0 + f1, diff01 = f0 - f1;
+                const float sum23 = f2 + f3, diff23 = f2 - f3;
+                const float in = input[t + i];
+
+                w0[i] = (sum01 + sum23) + in;
+                w1[i] = (diff01 + diff23) - in;
+                w2[i] = (sum01 - sum23) + in;
+                w3[i] = (diff01 - diff23) - in;
+            }
+
+            // A line at a time, each a single vector store
+            const auto bytes = (size_t)count * sizeof(float);
+            std::memcpy(d0 + t, w0, bytes);
+            std::memcpy(d1 + t, w1, bytes);
+            std::memcpy(d2 + t, w2, bytes);
+            std::memcpy(d3 + t, w3, bytes);
+        };
+
+        int t = 0;
+        for (; t + velvetRun <= numSamples; t += velvetRun)
+            run(t, velvetRun);
+
+        if (t < numSamples)
+            run(t, numSamples - t);
+    }
+
+    // Pairwise, so the adds don't wait on each other, in the same order in every variant
+    template <int Count>
+    inline float sumTree(const float* const* spans, int i)
+    {
+        if constexpr (Count == 1)
+            return spans[0][i];
+        else
+            return sumTree<Count / 2>(spans, i) + sumTree<Count / 2>(spans + Count / 2, i);
+    }
+
+    template <int TapsPerSign>
+    void velvetTapsFixed(float* dest, const float* const* positive, const float* const* negative, int numSamples)
+    {
+        const float* p[(size_t)TapsPerSign];
+        const float* n[(size_t)TapsPerSign];
+        for (int k = 0; k < TapsPerSign; ++k)
+        {
+            p[k] = positive[k];
+            n[k] = negative[k];
+        }
+
+        auto run = [&](int t, int count)
+        {
+            float sum[velvetRun];
+
+            for (int i = 0; i < count; ++i)
+                sum[i] = sumTree<TapsPerSign>(p, t + i) - sumTree<TapsPerSign>(n, t + i);
+
+            for (int i = 0; i < count; ++i)
+                dest[t + i] = sum[i];
+        };
+
+        int t = 0;
+        for (; t + velvetRun <= numSamples; t += velvetRun)
+            run(t, velvetRun);
+
+        if (t < numSamples)
+            run(t, numSamples - t);
+    }
+
+    void velvetTaps(float* dest, const float* const* positive, const float* const* negative, int tapsPerSign, int numSamples)
+    {
+        if (tapsPerSign == 2)
+        {
+            velvetTapsFixed<2>(dest, positive, negative, numSamples);
+            return;
+        }
+
+        if (tapsPerSign == 4)
+        {
+            velvetTapsFixed<4>(dest, positive, negative, numSamples);
+            return;
+        }
+
+        if (tapsPerSign == 8)
+        {
+            velvetTapsFixed<8>(dest, positive, negative, numSamples);
+            return;
+        }
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            float sum = 0.0f;
+            for (int k = 0; k < tapsPerSign; ++k)
+                sum += positive[k][i];
+            for (int k = 0; k < tapsPerSign; ++k)
+                sum -= negative[k][i];
+            dest[i] = sum;
+        }
+    }
+
+    void mix(float* dest, const float* wet, float dryGain, float wetGain, int numSamples)
+    {
+        for (int i = 0; i < numSamples; ++i)
+            dest[i] = dest[i] * dryGain + wet[i] * wetGain;
+    }
+
+    void midSide(float* left, float* right, float midGain, float sideGain, int numSamples)
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float m = (left[i] + right[i]) * midGain;
+            const float s = (left[i] - right[i]) * sideGain;
+            left[i] = m + s;
+            right[i] = m - s;
+        }
+    }
+
+    // Running peaks, one per position in a run of peakLanes samples, so the loops carry no
+    // reduction and vectorise like maxAbs. The order of a max doesn't change its result.
+    constexpr int peakLanes = 16;
+
+    inline float reducePeaks(const float* peaks)
+    {
+        float peak = 0.0f;
+        for (int j = 0; j < peakLanes; ++j)
+            peak = maxValue(peak, peaks[j]);
+        return peak;
+    }
+
+    template <bool FullWet>
+    inline float mixSample(float dry, float wet, float dryGain, float wetGain)
+    {
+        return FullWet ? wet : dry * dryGain + wet * wetGain;
+    }
+
+    template <bool FullWet>
+    float mixPeakLoop(float* dest, const float* wet, float dryGain, float wetGain, int numSamples)
+    {
+        float peaks[peakLanes] = {};
+
+        auto step = [&](int i, int j)
+        {
+            const float y = mixSample<FullWet>(dest[i], wet[i], dryGain, wetGain);
+            dest[i] = y;
+            peaks[j] = maxValue(peaks[j], absValue(y));
+        };
+
+        int i = 0;
+        for (; i + peakLanes <= numSamples; i += peakLanes)
+            for (int j = 0; j < peakLanes; ++j)
+                step(i + j, j);
+
+        for (int j = 0; i < numSamples; ++i, ++j)
+            step(i, j);
+
+        return reducePeaks(peaks);
+    }
+
+    template <bool FullWet>
+    float mixMidSidePeakLoop(float* left, float* right, const float* wetLeft, const float* wetRight,
+                             float midGain, float sideGain, float dryGain, float wetGain, int numSamples)
+    {
+        float peaks[peakLanes] = {};
+
+        auto step = [&](int i, int j)
+        {
+            const float m = (wetLeft[i] + wetRight[i]) * midGain;
+            const float s = (wetLeft[i] - wetRight[i]) * sideGain;
+            const float l = mixSample<FullWet>(left[i], m + s, dryGain, wetGain);
+            const float r = mixSample<FullWet>(right[i], m - s, dryGain, wetGain);
+            left[i] = l;
+            right[i] = r;
+            peaks[j] = maxValue(peaks[j], maxValue(absValue(l), absValue(r)));
+        };
+
+        int i = 0;
+        for (; i + peakLanes <= numSamples; i += peakLanes)
+            for (int j = 0; j < peakLanes; ++j)
+                step(i + j, j);
+
+        for (int j = 0; i < numSamples; ++i, ++j)
+            step(i, j);
+
+        return reducePeaks(peaks);
+    }
+
+    float mixPeak(float* dest, const float* wet, float dryGain, float wetGain, int numSamples)
+    {
+        return dryGain == 0.0f && wetGain == 1.0f ? mixPeakLoop<true>(dest, wet, dryGain, wetGain, numSamples)
+                                                  : mixPeakLoop<false>(dest, wet, dryGain, wetGain, numSamples);
+    }
+
+    float mixMidSidePeak(float* left, float* right, const float* wetLeft, const float* wetRight,
+                         float midGain, float sideGain, float dryGain, float wetGain, int numSamples)
+    {
+        return dryGain == 0.0f && wetGain == 1.0f
+                   ? mixMidSidePeakLoop<true>(left, right, wetLeft, wetRight, midGain, sideGain, dryGain, wetGain, numSamples)
+                   : mixMidSidePeakLoop<false>(left, right, wetLeft, wetRight, midGain, sideGain, dryGain, wetGain, numSamples);
+    }
+
+    void maxAbs(float* dest, const float* const* channels, int numChannels, int numSamples)
+    {
+        for (int i = 0; i < numSamples; ++i)
+            dest[i] = 0.0f;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const float* src = channels[ch];
+            for (int i = 0; i < numSamples; ++i)
+                dest[i] = maxValue(dest[i], absValue(src[i]));
+        }
+    }
+
+    // Magnitudes compared as integers, which ranks NaN and infinity (every exponent bit set)
+    // over any finite value. An OR of the flags, so there is no early exit to stop the loop
+    // from vectorising.
+    bool outOfRange(const float* samples, int numSamples, float limit)
+    {
+        const uint32_t limitBits = floatBits(absValue(limit));
+        uint32_t over = 0;
+
+        for (int i = 0; i < numSamples; ++i)
+            over |= (uint32_t)((floatBits(samples[i]) & 0x7fffffffu) > limitBits);
+
+        return over != 0;
+    }
+
+    // Branch-free so the loops vectorise. Integer ops and single float adds, so every
+    // variant produces the same bits as the F16C instructions, NaN payloads aside.
+    void encodeHalf(uint16_t* dest, const float* src, int numSamples)
+    {
+        // 0.5, its ulp is the smallest half subnormal
+        const uint32_t subnormalMagic = 0x3f000000u;
+        int i = 0;
+
+       #if FDNR_F16C
+        for (; i + 8 <= numSamples; i += 8)
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT));
+       #endif
+
+        for (; i < numSamples; ++i)
+        {
+            uint32_t bits = floatBits(src[i]);
+            const uint32_t sign = (bits >> 16) & 0x8000u;
+            bits &= 0x7fffffffu;
+
+            // Rebias the exponent and round the mantissa to 10 bits, ties to even
+            const uint32_t normal = (bits + 0xc8000fffu + ((bits >> 13) & 1u)) >> 13;
+
+            // Below the smallest normal half, the float add rounds onto the subnormal grid
+            const uint32_t subnormal = floatBits(bitsToFloat(bits) + bitsToFloat(subnormalMagic)) - subnormalMagic;
+
+            const uint32_t special = selectBits(bits > 0x7f800000u, 0x7e00u, 0x7c00u);
+            uint32_t half = selectBits(bits < 0x38800000u, subnormal, normal);
+            half = selectBits(bits >= 0x47800000u, special, half);
+            dest[i] = (uint16_t)(half | sign);
+        }
+    }
+
+    void decodeHalf(float* dest, const uint16_t* src, int numSamples)
+    {
+        // 2^-14, the smallest normal half
+        const uint32_t subnormalMagic = 0x38800000u;
+        int i = 0;
+
+       #if FDNR_F16C
+        for (; i + 8 <= numSamples; i += 8)
+            _mm256_storeu_ps(dest + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i))));
+       #endif
+
+        for (; i < numSamples; ++i)
+        {
+            const uint32_t half = src[i];
+            const uint32_t exponent = half & 0x7c00u;
+            const uint32_t bits = (half & 0x7fffu) << 13;
+
+            const uint32_t normal = bits + 0x38000000u;
+            const uint32_t special = bits + 0x70000000u;
+            const uint32_t subnormal = floatBits(bitsToFloat(bits + subnormalMagic) - bitsToFloat(subnormalMagic));
+
+            const uint32_t result = selectBits(exponent == 0, subnormal, selectBits(exponent == 0x7c00u, special, normal));
+            dest[i] = bitsToFloat(result | ((half & 0x8000u) << 16));
+        }
+    }
+
+    void encodeInt16(int16_t* dest, const float* src, int numSamples, float range, uint32_t ditherIndex)
+    {
+        const float scale = 32768.0f / range;
+
+        // Adding and taking away 1.5 * 2^23 rounds to the nearest integer
+        const float roundingMagic = 12582912.0f;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            uint32_t hash = (ditherIndex + (uint32_t)i) * 0x9e3779b1u;
+            hash ^= hash >> 16;
+            hash *= 0x85ebca6bu;
+            hash ^= hash >> 13;
+
+            // Difference of two uniform 16 bit values, triangular over +-1 step
+            const float dither = ((float)(int)(hash >> 16) - (float)(int)(hash & 0xffffu)) * (1.0f / 65536.0f);
+
+            float x = src[i] * scale + dither;
+            x = bitsToFloat(selectBits(x < -32768.0f, floatBits(-32768.0f), floatBits(x)));
+            x = bitsToFloat(selectBits(x > 32767.0f, floatBits(32767.0f), floatBits(x)));
+            x = (x + roundingMagic) - roundingMagic;
+            dest[i] = (int16_t)(int)x;
+        }
+    }
+
+    void decodeInt16(float* dest, const int16_t* src, int numSamples, float range)
+    {
+        const float scale = range / 32768.0f;
+
+        for (int i = 0; i < numSamples; ++i)
+            dest[i] = (float)src[i] * scale;
+    }
+
+    constexpr DSPKernels makeKernels(DSPKernels::Isa isa, const char* name)
+    {
+        return { isa, name, combBank, combBankPrecise, velvetLines, velvetTaps, mix, midSide, mixPeak, mixMidSidePeak, maxAbs,
+                 outOfRange, encodeHalf, decodeHalf, encodeInt16, decodeInt16 };
+    }
+}
@@ -0,0 +1,6 @@
+// Built with AVX2/FMA/F16C code generation; only reached after a CPUID check.
+#if defined(__AVX2__)
+#include "DSPKernelsImpl.h"
+
+extern const DSPKernels dspKernelsAVX2 = makeKernels(DSPKernels::Isa::avx2, "AVX2");
+#endif
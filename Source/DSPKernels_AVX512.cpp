@@ -0,0 +1,6 @@
+// Built with AVX-512F/F16C code generation; only reached after a CPUID check.
+#if defined(__AVX512F__)
+#include "DSPKernelsImpl.h"
+
+extern const DSPKernels dspKernelsAVX512 = makeKernels(DSPKernels::Isa::avx512, "AVX-512");
+#endif
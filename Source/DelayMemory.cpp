@@ -0,0 +1,120 @@
+#include "DelayMemory.h"
+
+void DelayMemory::reserve(DelayArena& arena, DelayStorage newStorage, int newSize, uint32_t ditherSeed)
+{
+    storage = newStorage;
+    size = juce::jmax(1, newSize);
+    length = size;
+    data = nullptr;
+
+    // Spread the seeds so neighbouring rings start far apart in the dither sequence
+    ditherIndex = ditherSeed * 0x9e3779b9u;
+
+    arena.rings.push_back(this);
+}
+
+void DelayMemory::setLength(int newLength)
+{
+    jassert(newLength > 0 && newLength <= size);
+    length = juce::jlimit(1, size, newLength);
+}
+
+void DelayMemory::clear()
+{
+    clear(0, size);
+}
+
+void DelayMemory::clear(int start, int count)
+{
+    jassert(start >= 0 && start + count <= size);
+
+    // Zero is all bits clear in every format. Before the arena is allocated there is nothing
+    // to clear, it hands the memory out zeroed.
+    if (data != nullptr)
+        std::memset(static_cast<char*>(data) + getBytes() / (size_t)size * (size_t)start, 0,
+                    getBytes() / (size_t)size * (size_t)count);
+}
+
+void DelayMemory::read(float* dest, int position, int numSamples) const
+{
+    jassert(numSamples <= length && position >= 0 && position < length);
+
+    const auto first = juce::jmin(numSamples, length - position);
+    readSpan(dest, position, first);
+
+    if (first < numSamples)
+        readSpan(dest + first, 0, numSamples - first);
+}
+
+void DelayMemory::write(const float* src, int position, int numSamples)
+{
+    jassert(numSamples <= length && position >= 0 && position < length);
+
+    const auto first = juce::jmin(numSamples, length - position);
+    writeSpan(src, position, first);
+
+    if (first < numSamples)
+        writeSpan(src + first, 0, numSamples - first);
+}
+
+void DelayMemory::readSpan(float* dest, int start, int count) const
+{
+    switch (storage)
+    {
+        case DelayStorage::float32:
+            std::copy_n(static_cast<const float*>(data) + start, count, dest);
+            break;
+
+        case DelayStorage::float16:
+            kernels->decodeHalf(dest, static_cast<const uint16_t*>(data) + start, count);
+            break;
+
+        case DelayStorage::int16:
+            kernels->decodeInt16(dest, static_cast<const int16_t*>(data) + start, count, int16Range);
+            break;
+    }
+}
+
+void DelayMemory::writeSpan(const float* src, int start, int count)
+{
+    switch (storage)
+    {
+        case DelayStorage::float32:
+            std::copy_n(src, count, static_cast<float*>(data) + start);
+            break;
+
+        case DelayStorage::float16:
+            kernels->encodeHalf(static_cast<uint16_t*>(data) + start, src, count);
+            break;
+
+        case DelayStorage::int16:
+            kernels->encodeInt16(static_cast<int16_t*>(data) + start, src, count, int16Range, ditherIndex);
+            ditherIndex += (uint32_t)count;
+            break;
+    }
+}
+
+//==============================================================================
+void DelayArena::beginLayout()
+{
+    rings.clear();
+}
+
+void DelayArena::allocate()
+{
+    auto roundUp = [](size_t n) { return (n + alignment - 1) & ~(alignment - 1); };
+
+    bytes = 0;
+    for (auto* ring : rings)
+        bytes += roundUp(ring->getBytes());
+
+    // Over-allocated by a cache line so the first ring can start on one
+    block.assign(bytes + alignment, 0);
+    auto address = roundUp(reinterpret_cast<size_t>(block.data()));
+
+    for (auto* ring : rings)
+    {
+        ring->data = reinterpret_cast<void*>(address);
+        address += roundUp(ring->getBytes());
+    }
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include <juce_dsp/juce_dsp.h>
+#include "DSPKernels.h"
+
+class DelayArena;
+
+// Sample format of long delay memory. The 16-bit formats halve the memory and the traffic
+// through it, for a noise floor: float16 stays about 66 dB under the signal, dithered int16
+// sits at a fixed floor around -84 dBFS.
+enum class DelayStorage { float32, float16, int16 };
+
+// One ring of delayed samples in a DelayStorage format, its memory a slice of a DelayArena.
+// It is read and written in spans, so the conversions run through the vectorised DSPKernels.
+class DelayMemory
+{
+public:
+    void setKernels(const DSPKernels& newKernels) { kernels = &newKernels; }
+
+    // Takes newSize samples from the arena, all of them used as the ring. The memory is there,
+    // zeroed, once the arena is allocated. ditherSeed keeps the int16 dither of rings apart.
+    void reserve(DelayArena& arena, DelayStorage newStorage, int newSize, uint32_t ditherSeed = 0);
+
+    // Peak level int16 storage holds, louder samples clip. Set before anything is written.
+    void setInt16Range(float newRange) { int16Range = newRange; }
+
+    DelayStorage getStorage() const { return storage; }
+    int getSize() const { return size; }
+
+    // Uses only the first newLength samples as the ring, within the reserved size
+    void setLength(int newLength);
+    int getLength() const { return length; }
+
+    void clear();
+
+    // Zeroes count samples from start, without wrapping
+    void clear(int start, int count);
+
+    // numSamples from position on, wrapping at the length. numSamples must not exceed it.
+    void read(float* dest, int position, int numSamples) const;
+    void write(const float* src, int position, int numSamples);
+
+    // The samples of float32 storage, for lines processed a sample at a time
+    float* getFloats()
+    {
+        jassert(storage == DelayStorage::float32);
+        return static_cast<float*>(data);
+    }
+
+private:
+    friend class DelayArena;
+
+    size_t getBytes() const { return (size_t)size * (storage == DelayStorage::float32 ? sizeof(float) : sizeof(uint16_t)); }
+    void readSpan(float* dest, int start, int count) const;
+    void writeSpan(const float* src, int start, int count);
+
+    const DSPKernels* kernels = &DSPKernels::get();
+    DelayStorage storage = DelayStorage::float32;
+
+    // float32 samples, or 16-bit patterns (int16 as two's complement). Null until the arena
+    // is allocated.
+    void* data = nullptr;
+
+    int size = 0, length = 0;
+    float int16Range = 4.0f;
+    uint32_t ditherIndex = 0;
+};
+
+// All of one processor's delay memory in a single block. Each ring starts on a cache line of
+// its own, in the order the rings were reserved, which the stages keep to the order the signal
+// goes through them: the read and write heads of consecutive rings walk forward through
+// neighbouring memory, which the hardware prefetchers follow.
+class DelayArena
+{
+public:
+    static constexpr size_t alignment = 64;
+
+    // Forgets the rings, before the stages reserve theirs again
+    void beginLayout();
+
+    // One zeroed block for every ring reserved since beginLayout()
+    void allocate();
+
+    size_t getBytes() const { return bytes; }
+
+private:
+    friend class DelayMemory;
+
+    std::vector<DelayMemory*> rings;
+    std::vector<char> block;
+    size_t bytes = 0;
+};
@@ -0,0 +1,261 @@
+#include "EarlyReflections.h"
+#include "ReverbModes.h"
+#include <cmath>
+
+namespace
+{
+    struct TapPattern
+    {
+        float spreadMs; // Time of the last reflection
+        float decay;    // Gain ratio between consecutive reflections
+        int numTaps;
+    };
+
+    // One entry per mode, in the order of ReverbModes
+    const TapPattern tapPatterns[] = {
+        { 28.0f, 0.80f, 6 }, // TwinStar
+        { 45.0f, 0.88f, 8 }, // SeaSerpent
+        { 22.0f, 0.70f, 8 }, // HorseMan
+        { 60.0f, 0.75f, 4 }, // Archer - sparse, distinct
+        { 80.0f, 0.92f, 8 }, // VoidMaker
+        { 55.0f, 0.85f, 7 }, // GalaxySpiral
+        { 12.0f, 0.90f, 5 }, // HarpString - tight, resonant
+        { 18.0f, 0.65f, 6 }, // GoatHorn
+        { 70.0f, 0.90f, 8 }, // NebulaCloud
+        { 50.0f, 0.70f, 3 }, // Triangle - three geometric echoes
+        { 40.0f, 0.85f, 8 }, // CloudMajor
+        { 42.0f, 0.80f, 8 }, // CloudMinor
+        { 48.0f, 0.82f, 7 }, // QueenChair
+        { 15.0f, 0.60f, 5 }, // HunterBelt
+        { 35.0f, 0.85f, 6 }, // WaterBearer
+        { 65.0f, 0.90f, 2 }, // TwoFish - two distinct echoes
+        { 25.0f, 0.75f, 6 }, // ScorpionTail
+        { 32.0f, 0.78f, 6 }, // BalanceScale
+        { 38.0f, 0.80f, 7 }, // LionHeart
+        { 26.0f, 0.72f, 5 }, // Maiden
+        { 77.0f, 0.85f, 7 }  // SevenSisters
+    };
+
+    constexpr int numPatterns = (int) (sizeof(tapPatterns) / sizeof(tapPatterns[0]));
+    static_assert(numPatterns == ReverbModes::numModes, "one tap pattern per mode");
+
+    // Irregular spacing so reflections don't build a comb
+    const float tapRatios[EarlyReflections::maxTaps] = { 0.13f, 0.21f, 0.34f, 0.43f, 0.55f, 0.68f, 0.84f, 1.0f };
+    const float tapSigns[EarlyReflections::maxTaps] = { 1.0f, -1.0f, 1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f };
+    const float stereoSpread[EarlyReflections::maxTaps] = { 1.07f, 0.93f, 1.05f, 0.96f, 1.09f, 0.94f, 1.03f, 0.97f };
+
+    // Diffuser lengths in samples at 44.1 kHz (primes)
+    const int diffuserTunings[EarlyReflections::numDiffusers] = { 71, 113, 163, 223 };
+
+    int ringSizeFor(int minimumSize)
+    {
+        return juce::nextPowerOfTwo(juce::jmax(2, minimumSize));
+    }
+
+    void addFromRing(float* dest, const float* ring, int ringMask, int start, float gain, int numSamples)
+    {
+        auto first = juce::jmin(numSamples, ringMask + 1 - start);
+        juce::FloatVectorOperations::addWithMultiply(dest, ring + start, gain, first);
+
+        if (first < numSamples)
+            juce::FloatVectorOperations::addWithMultiply(dest + first, ring, gain, numSamples - first);
+    }
+
+    void writeToRing(float* ring, int ringMask, int start, const float* src, int numSamples)
+    {
+        auto first = juce::jmin(numSamples, ringMask + 1 - start);
+        juce::FloatVectorOperations::copy(ring + start, src, first);
+
+        if (first < numSamples)
+            juce::FloatVectorOperations::copy(ring, src + first, numSamples - first);
+    }
+}
+
+void EarlyReflections::prepare(const juce::dsp::ProcessSpec& spec, DelayArena& arena)
+{
+    sampleRate = spec.sampleRate;
+    maxBlockSize = (int) spec.maximumBlockSize;
+
+    auto maxDelay = (int) std::ceil(maxSpreadMs * 1.1f * sampleRate / 1000.0);
+    auto ringSize = ringSizeFor(maxDelay + maxBlockSize);
+    ringMask = ringSize - 1;
+
+    channels.resize(spec.numChannels);
+
+    // Each channel's ring, then the diffusers it feeds
+    for (auto& state : channels)
+    {
+        state.ring.reserve(arena, DelayStorage::float32, ringSize);
+
+        for (int i = 0; i < numDiffusers; ++i)
+        {
+            auto& ap = state.diffusers[i];
+            ap.delay = (unsigned int) juce::jmax(1, juce::roundToInt(diffuserTunings[i] * sampleRate / 44100.0));
+            ap.buffer.reserve(arena, DelayStorage::float32, ringSizeFor((int) ap.delay + 1));
+            ap.mask = (unsigned int) ap.buffer.getSize() - 1;
+        }
+    }
+
+    currentMode = -1;
+    setMode(0);
+    reset();
+}
+
+void EarlyReflections::reset()
+{
+    for (auto& state : channels)
+    {
+        state.ring.clear();
+
+        for (auto& ap : state.diffusers)
+            ap.buffer.clear();
+    }
+
+    writePos = 0;
+    diffusePos = 0;
+    clearChannel = 0;
+    clearPosition = 0;
+}
+
+int EarlyReflections::clearSome(int maxSamples)
+{
+    int cleared = 0;
+
+    while (cleared < maxSamples && clearChannel < channels.size())
+    {
+        auto& ring = channels[clearChannel].ring;
+        auto count = juce::jmin((size_t) (maxSamples - cleared), (size_t) ring.getSize() - clearPosition);
+
+        ring.clear((int) clearPosition, (int) count);
+        clearPosition += count;
+        cleared += (int) count;
+
+        if (clearPosition == (size_t) ring.getSize())
+        {
+            ++clearChannel;
+            clearPosition = 0;
+        }
+    }
+
+    // The diffusers are short, they go in one step at the end
+    if (cleared < maxSamples)
+    {
+        for (auto& state : channels)
+            for (auto& ap : state.diffusers)
+                ap.buffer.clear();
+
+        writePos = 0;
+        diffusePos = 0;
+        clearChannel = 0;
+    }
+
+    return cleared;
+}
+
+void EarlyReflections::setMode(int modeIndex)
+{
+    modeIndex = juce::jlimit(0, numPatterns - 1, modeIndex);
+
+    if (modeIndex == currentMode)
+        return;
+
+    currentMode = modeIndex;
+    updateTaps();
+}
+
+void EarlyReflections::setDiffusion(float amount)
+{
+    diffusionCoeff = 0.75f * juce::jlimit(0.0f, 1.0f, amount);
+}
+
+void EarlyReflections::updateTaps()
+{
+    const auto& pattern = tapPatterns[currentMode];
+    numTaps = juce::jlimit(0, maxTaps, pattern.numTaps);
+
+    // Normalise so the stage keeps roughly the input's energy
+    float energy = 1.0f;
+    float gain = 1.0f;
+    for (int t = 0; t < numTaps; ++t)
+    {
+        gain *= pattern.decay;
+        energy += gain * gain;
+    }
+    directGain = 1.0f / std::sqrt(energy);
+
+    auto lastRatio = numTaps > 0 ? tapRatios[numTaps - 1] : 1.0f;
+    auto maxDelay = ringMask + 1 - maxBlockSize;
+
+    for (size_t ch = 0; ch < channels.size(); ++ch)
+    {
+        auto& state = channels[ch];
+        gain = directGain;
+
+        for (int t = 0; t < numTaps; ++t)
+        {
+            auto ms = pattern.spreadMs * tapRatios[t] / lastRatio;
+            if (ch % 2 == 1)
+                ms *= stereoSpread[t];
+
+            gain *= pattern.decay;
+            state.tapDelays[t] = juce::jlimit(1, maxDelay, juce::roundToInt(ms * sampleRate / 1000.0));
+            state.tapGains[t] = gain * tapSigns[t];
+        }
+    }
+}
+
+float EarlyReflections::diffuse(ChannelState& state, float input)
+{
+    auto x = input;
+
+    for (auto& ap : state.diffusers)
+    {
+        auto* buffer = ap.buffer.getFloats();
+        auto delayed = buffer[(diffusePos - ap.delay) & ap.mask];
+        auto v = x + diffusionCoeff * delayed;
+        buffer[diffusePos & ap.mask] = v;
+        x = delayed - diffusionCoeff * v;
+    }
+
+    return x;
+}
+
+int EarlyReflections::getLongestTap() const
+{
+    int longest = 0;
+    for (const auto& state : channels)
+        for (int t = 0; t < numTaps; ++t)
+            longest = std::max(longest, state.tapDelays[t]);
+
+    return longest;
+}
+
+void EarlyReflections::process(const juce::dsp::AudioBlock<float>& block)
+{
+    const auto numSamples = (int) block.getNumSamples();
+    const auto numChannels = juce::jmin(block.getNumChannels(), channels.size());
+    jassert(numSamples <= maxBlockSize);
+
+    auto startDiffusePos = diffusePos;
+
+    for (size_t ch = 0; ch < numChannels; ++ch)
+    {
+        auto& state = channels[ch];
+        auto* samples = block.getChannelPointer(ch);
+        auto* ring = state.ring.getFloats();
+
+        // Taps are whole spans of the ring, so each one is a single vectorised multiply-add
+        writeToRing(ring, ringMask, writePos, samples, numSamples);
+        juce::FloatVectorOperations::multiply(samples, directGain, numSamples);
+
+        for (int t = 0; t < numTaps; ++t)
+            addFromRing(samples, ring, ringMask, (writePos - state.tapDelays[t]) & ringMask, state.tapGains[t], numSamples);
+
+        diffusePos = startDiffusePos;
+        for (int i = 0; i < numSamples; ++i, ++diffusePos)
+            samples[i] = diffuse(state, samples[i]);
+    }
+
+    writePos = (writePos + numSamples) & ringMask;
+    diffusePos = startDiffusePos + (unsigned int) numSamples;
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <juce_dsp/juce_dsp.h>
+#include "DelayMemory.h"
+
+// Early reflection stage: a mode-specific multi-tap pattern read from one ring buffer
+// per channel, followed by a short allpass diffusion cascade.
+class EarlyReflections
+{
+public:
+    static constexpr int maxTaps = 8;
+    static constexpr int numDiffusers = 4;
+    static constexpr float maxSpreadMs = 100.0f;
+
+    // The rings are reserved in the arena, and usable once it is allocated
+    void prepare(const juce::dsp::ProcessSpec& spec, DelayArena& arena);
+    void reset();
+
+    // Zeroes up to maxSamples more of the reflection rings, carrying on where the last call
+    // stopped. Returns how many were zeroed, fewer than maxSamples once everything is clear.
+    int clearSome(int maxSamples);
+
+    // Rebuilds the tap layout only when the mode or sample rate changed.
+    void setMode(int modeIndex);
+    // 0..1, maps to the allpass coefficient of the diffusion cascade.
+    void setDiffusion(float amount);
+
+    // Delay of the last reflection of the current mode, in samples, over all channels
+    int getLongestTap() const;
+
+    void process(const juce::dsp::AudioBlock<float>& block);
+
+private:
+    struct Allpass
+    {
+        DelayMemory buffer;
+        unsigned int mask = 0;
+        unsigned int delay = 1;
+    };
+
+    struct ChannelState
+    {
+        DelayMemory ring;
+        int tapDelays[maxTaps] = {};
+        float tapGains[maxTaps] = {};
+        Allpass diffusers[numDiffusers];
+    };
+
+    void updateTaps();
+    float diffuse(ChannelState& state, float input);
+
+    std::vector<ChannelState> channels;
+
+    double sampleRate = 44100.0;
+    int maxBlockSize = 0;
+    int ringMask = 0;
+    int writePos = 0;
+
+    int currentMode = -1;
+    int numTaps = 0;
+    float directGain = 1.0f;
+
+    float diffusionCoeff = 0.0f;
+    unsigned int diffusePos = 0;
+
+    // Progress of clearSome()
+    size_t clearChannel = 0, clearPosition = 0;
+};
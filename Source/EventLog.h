@@ -0,0 +1,127 @@
+#pragma once
+#include <juce_core/juce_core.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#if JUCE_WINDOWS
+ #include <process.h>
+#else
+ #include <unistd.h>
+#endif
+
+// Diagnostic events from one plugin instance: resets, prepares, oversized blocks, mode and
+// engine switches, deadline overruns. The audio thread pushes fixed-size binary events into a
+// ring without locks, allocation or syscalls, and EventLogWriter drains them into a log file
+// from its own thread. One producer and one consumer; when the ring is full the event is
+// dropped and counted, the audio thread never waits.
+class EventLog
+{
+public:
+    enum class Type : int32_t
+    {
+        prepare,        // intValue block size, value sample rate
+        clear,
+        oversizedBlock, // intValue block size, value the prepared size
+        modeChange,     // intValue mode
+        engineChange,   // intValue engine
+        qualityTier,    // intValue tier
+        overrun,        // intValue block size, value processing time over the deadline
+        recovery        // intValue recoveries so far
+    };
+
+    struct Event
+    {
+        int64_t ticks;  // juce::Time::getHighResolutionTicks()
+        Type type;
+        int32_t intValue;
+        double value;
+    };
+
+    // A power of two. Drained several times a second, so it only fills if something is
+    // very wrong.
+    static constexpr uint32_t capacity = 1024;
+
+    EventLog() : instanceId(nextInstanceId.fetch_add(1)) {}
+
+    int getInstanceId() const { return instanceId; }
+
+    // Instance IDs start over in every process, this tells apart instances in different hosts
+    // or plugin sandboxes
+    static int getProcessId()
+    {
+       #if JUCE_WINDOWS
+        return _getpid();
+       #else
+        return (int)getpid();
+       #endif
+    }
+
+    // Events pushed while disabled are ignored
+    void setEnabled(bool shouldBeEnabled) { enabled.store(shouldBeEnabled, std::memory_order_relaxed); }
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    // Producer side, wait-free
+    void push(Type type, int64_t ticks, int32_t intValue = 0, double value = 0.0)
+    {
+        if (! isEnabled())
+            return;
+
+        const auto write = writeIndex.load(std::memory_order_relaxed);
+
+        if (write - readIndex.load(std::memory_order_acquire) >= capacity)
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        events[write & (capacity - 1)] = { ticks, type, intValue, value };
+        writeIndex.store(write + 1, std::memory_order_release);
+    }
+
+    // Consumer side. Calls handler on each event in order, returns how many there were.
+    template <typename Handler>
+    int drain(Handler&& handler)
+    {
+        const auto read = readIndex.load(std::memory_order_relaxed);
+        const auto write = writeIndex.load(std::memory_order_acquire);
+
+        for (auto i = read; i != write; ++i)
+            handler(events[i & (capacity - 1)]);
+
+        readIndex.store(write, std::memory_order_release);
+        return (int)(write - read);
+    }
+
+    // Events lost to a full ring since the last call
+    uint32_t takeDroppedCount() { return dropped.exchange(0, std::memory_order_relaxed); }
+
+    static const char* getTypeName(Type type)
+    {
+        switch (type)
+        {
+            case Type::prepare: return "prepare";
+            case Type::clear: return "clear";
+            case Type::oversizedBlock: return "oversized block";
+            case Type::modeChange: return "mode";
+            case Type::engineChange: return "engine";
+            case Type::qualityTier: return "quality tier";
+            case Type::overrun: return "deadline overrun";
+            case Type::recovery: return "recovery";
+            default: return "";
+        }
+    }
+
+private:
+    static inline std::atomic<int> nextInstanceId { 1 };
+
+    const int instanceId;
+    std::atomic<bool> enabled { false };
+
+    std::array<Event, capacity> events {};
+
+    // Free-running, wrapped on access. On separate cache lines so producer and consumer
+    // don't share one.
+    alignas(64) std::atomic<uint32_t> writeIndex { 0 };
+    alignas(64) std::atomic<uint32_t> readIndex { 0 };
+    alignas(64) std::atomic<uint32_t> dropped { 0 };
+};
@@ -0,0 +1,146 @@
+#include "EventLogWriter.h"
+
+EventLogWriter::EventLogWriter()
+    : juce::Thread("FDNR Event Log"),
+      startTicks(juce::Time::getHighResolutionTicks()),
+      startMillis(juce::Time::currentTimeMillis()),
+      ticksPerMilli((double)juce::Time::getHighResolutionTicksPerSecond() / 1000.0)
+{
+    startThread(juce::Thread::Priority::background);
+}
+
+EventLogWriter::~EventLogWriter()
+{
+    stopThread(2000);
+
+    const juce::ScopedLock sl(lock);
+    for (auto* log : logs)
+        drain(*log);
+}
+
+void EventLogWriter::add(EventLog& log)
+{
+    const juce::ScopedLock sl(lock);
+    logs.addIfNotAlreadyThere(&log);
+}
+
+void EventLogWriter::remove(EventLog& log)
+{
+    const juce::ScopedLock sl(lock);
+    drain(log);
+    logs.removeFirstMatchingValue(&log);
+}
+
+juce::File EventLogWriter::getLogFile()
+{
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+        .getChildFile("Stancsz Audio")
+        .getChildFile("FND Reverb")
+        .getChildFile("events-" + juce::String(EventLog::getProcessId()) + ".log");
+}
+
+void EventLogWriter::deleteOldLogs()
+{
+    const auto cutoff = juce::Time::getCurrentTime() - juce::RelativeTime::days(maxAgeDays);
+
+    for (const auto& file : getLogFile().getParentDirectory().findChildFiles(juce::File::findFiles, false, "events-*.log"))
+        if (file.getLastModificationTime() < cutoff)
+            file.deleteFile();
+}
+
+void EventLogWriter::run()
+{
+    while (! threadShouldExit())
+    {
+        {
+            const juce::ScopedLock sl(lock);
+            for (auto* log : logs)
+                drain(*log);
+
+            if (stream != nullptr)
+                stream->flush();
+        }
+
+        wait(drainIntervalMs);
+    }
+}
+
+void EventLogWriter::drain(EventLog& log)
+{
+    const int id = log.getInstanceId();
+
+    log.drain([this, id](const EventLog::Event& e) {
+        juce::String text(EventLog::getTypeName(e.type));
+
+        switch (e.type)
+        {
+            case EventLog::Type::prepare:
+                text << " sampleRate=" << e.value << " blockSize=" << e.intValue;
+                break;
+            case EventLog::Type::oversizedBlock:
+                text << " numSamples=" << e.intValue << " prepared=" << (int)e.value;
+                break;
+            case EventLog::Type::overrun:
+                text << " numSamples=" << e.intValue << " load=" << juce::String(e.value, 2);
+                break;
+            case EventLog::Type::modeChange:
+            case EventLog::Type::engineChange:
+            case EventLog::Type::qualityTier:
+            case EventLog::Type::recovery:
+                text << " " << e.intValue;
+                break;
+            case EventLog::Type::clear:
+            default:
+                break;
+        }
+
+        writeLine(id, e.ticks, text);
+    });
+
+    if (const auto dropped = log.takeDroppedCount())
+        writeLine(id, juce::Time::getHighResolutionTicks(), "dropped " + juce::String(dropped) + " events");
+}
+
+void EventLogWriter::writeLine(int instanceId, juce::int64 ticks, const juce::String& text)
+{
+    if (stream != nullptr && stream->getPosition() >= maxFileBytes)
+        rotate();
+
+    if (stream == nullptr)
+    {
+        const auto file = getLogFile();
+        file.getParentDirectory().createDirectory();
+        deleteOldLogs();
+        stream = std::make_unique<juce::FileOutputStream>(file);
+
+        if (stream->failedToOpen())
+        {
+            stream.reset();
+            return;
+        }
+    }
+
+    const auto millis = startMillis + (juce::int64)((double)(ticks - startTicks) / ticksPerMilli);
+    const juce::Time time(millis);
+
+    *stream << time.formatted("%Y-%m-%d %H:%M:%S.") << juce::String(time.getMilliseconds()).paddedLeft('0', 3)
+            << " [" << instanceId << "] " << text << juce::newLine;
+}
+
+void EventLogWriter::rotate()
+{
+    stream.reset();
+
+    // events-<process>.log becomes events-<process>.1.log, that becomes .2.log, and so on
+    const auto file = getLogFile();
+    const auto numbered = [&file](int n) {
+        return file.getSiblingFile(file.getFileNameWithoutExtension() + "." + juce::String(n) + file.getFileExtension());
+    };
+
+    numbered(numFiles - 1).deleteFile();
+
+    for (int n = numFiles - 2; n > 0; --n)
+        numbered(n).moveFileTo(numbered(n + 1));
+
+    file.moveFileTo(numbered(1));
+}
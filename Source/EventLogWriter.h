@@ -0,0 +1,48 @@
+#pragma once
+#include <juce_core/juce_core.h>
+#include "EventLog.h"
+
+// Drains the event logs of every plugin instance in the process into one text log, a line per
+// event with the wall-clock time and the instance ID. Shared through a
+// juce::SharedResourcePointer, so it lives as long as some instance does. Each process has its
+// own file, so hosts and plugin sandboxes don't write over each other. It is opened on the
+// first event and rotated once it grows past maxFileBytes, keeping numFiles of them. Logs of
+// any process left alone for maxAgeDays are deleted then.
+class EventLogWriter : private juce::Thread
+{
+public:
+    static constexpr int drainIntervalMs = 250;
+    static constexpr juce::int64 maxFileBytes = 1 << 20;
+    static constexpr int numFiles = 4;
+    static constexpr int maxAgeDays = 7;
+
+    EventLogWriter();
+    ~EventLogWriter() override;
+
+    // Off the audio thread. Events still in the ring are written before remove() returns.
+    void add(EventLog& log);
+    void remove(EventLog& log);
+
+    // events-<process>.log in the user's application data folder, older ones are
+    // events-<process>.1.log and on. See EventLog::getProcessId().
+    static juce::File getLogFile();
+
+private:
+    void run() override;
+
+    // Caller holds lock
+    void drain(EventLog& log);
+    void writeLine(int instanceId, juce::int64 ticks, const juce::String& text);
+    void rotate();
+    static void deleteOldLogs();
+
+    juce::CriticalSection lock;
+    juce::Array<EventLog*> logs;
+    std::unique_ptr<juce::FileOutputStream> stream;
+
+    // Ticks to wall-clock time
+    const juce::int64 startTicks, startMillis;
+    const double ticksPerMilli;
+
+    JUCE_DECLARE_NON_COPYABLE (EventLogWriter)
+};
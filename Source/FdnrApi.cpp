@@ -0,0 +1,140 @@
+#include "FdnrApi.h"
+#include "ReverbProcessor.h"
+#include "ReverbModes.h"
+#include <algorithm>
+#include <cstring>
+
+struct fdnr_reverb
+{
+    ReverbProcessor processor;
+    ReverbParameters params;
+    int numChannels = 0, maxBlockSize = 0;
+};
+
+namespace
+{
+    // Nothing may be thrown across the C interface
+    template <typename Function>
+    int catchAll(Function&& function)
+    {
+        try
+        {
+            return function();
+        }
+        catch (...)
+        {
+            return -1;
+        }
+    }
+}
+
+fdnr_reverb* fdnr_create(void)
+{
+    try
+    {
+        return new fdnr_reverb();
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+
+void fdnr_destroy(fdnr_reverb* reverb)
+{
+    delete reverb;
+}
+
+int fdnr_prepare(fdnr_reverb* reverb, double sample_rate, int max_block_size, int num_channels)
+{
+    if (reverb == nullptr || ! (sample_rate >= 8000.0 && sample_rate <= 768000.0)
+        || max_block_size < 1 || num_channels < 1 || num_channels > 2)
+        return -1;
+
+    return catchAll([&] {
+        reverb->numChannels = 0;
+        reverb->processor.prepare({ sample_rate, (juce::uint32)max_block_size, (juce::uint32)num_channels });
+        reverb->processor.setParameters(reverb->params);
+        reverb->numChannels = num_channels;
+        reverb->maxBlockSize = max_block_size;
+        return 0;
+    });
+}
+
+int fdnr_set_params(fdnr_reverb* reverb, const char* const* ids, const float* values, int count)
+{
+    if (reverb == nullptr || count < 0 || (count > 0 && (ids == nullptr || values == nullptr)))
+        return -1;
+
+    return catchAll([&] {
+        std::vector<bool> known((size_t)count);
+
+        for (int i = 0; i < count; ++i)
+        {
+            if (ids[i] != nullptr && std::strcmp(ids[i], "BPM") == 0)
+            {
+                reverb->params.bpm = (double)values[i];
+                known[(size_t)i] = true;
+            }
+        }
+
+        // The last value given for an ID wins
+        reverb->params = ReverbParameters::fromParameterValues([&](juce::StringRef id, float fallback) {
+            float value = fallback;
+            for (int i = 0; i < count; ++i)
+            {
+                if (ids[i] != nullptr && std::strcmp(id, ids[i]) == 0)
+                {
+                    value = values[i];
+                    known[(size_t)i] = true;
+                }
+            }
+            return value;
+        }, reverb->params);
+
+        reverb->processor.setParameters(reverb->params);
+        return (int)std::count(known.begin(), known.end(), false);
+    });
+}
+
+int fdnr_set_mode(fdnr_reverb* reverb, int mode)
+{
+    if (reverb == nullptr || ! juce::isPositiveAndBelow(mode, ReverbModes::numModes))
+        return -1;
+
+    return catchAll([&] {
+        std::vector<const char*> ids { "MODE" };
+        std::vector<float> values { (float)mode };
+
+        for (const auto& setting : ReverbModes::getSettings(mode))
+        {
+            ids.push_back(setting.parameterID);
+            values.push_back(setting.value);
+        }
+
+        return fdnr_set_params(reverb, ids.data(), values.data(), (int)ids.size()) == 0 ? 0 : -1;
+    });
+}
+
+int fdnr_process_planar(fdnr_reverb* reverb, float* const* channels, int num_channels, int num_samples)
+{
+    if (reverb == nullptr || channels == nullptr || num_channels != reverb->numChannels || num_samples < 0)
+        return -1;
+
+    juce::ScopedNoDenormals noDenormals;
+
+    for (int start = 0; start < num_samples; start += reverb->maxBlockSize)
+    {
+        const int length = juce::jmin(reverb->maxBlockSize, num_samples - start);
+        juce::dsp::AudioBlock<float> block(channels, (size_t)num_channels, (size_t)start, (size_t)length);
+        juce::dsp::ProcessContextReplacing<float> context(block);
+        reverb->processor.process(context);
+    }
+
+    return 0;
+}
+
+int fdnr_get_latency(const fdnr_reverb* reverb)
+{
+    return reverb != nullptr ? reverb->processor.getLatencySamples() : 0;
+}
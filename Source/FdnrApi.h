@@ -0,0 +1,40 @@
+#pragma once
+
+/* C interface to the reverb in the fdnr_dsp library, for hosts and renderers that don't use
+   JUCE or C++. Calls on one instance must not overlap; separate instances are independent.
+   fdnr_process_planar() doesn't allocate or lock, the other calls may. */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct fdnr_reverb fdnr_reverb;
+
+/* NULL if out of memory */
+fdnr_reverb* fdnr_create(void);
+void fdnr_destroy(fdnr_reverb* reverb);
+
+/* Allocates for a stream of 1 or 2 channels and clears the reverb. Returns 0, or -1 if an
+   argument is out of range or memory ran out. */
+int fdnr_prepare(fdnr_reverb* reverb, double sample_rate, int max_block_size, int num_channels);
+
+/* Sets parameters by the plugin's IDs, in its units, as presets store them: "MIX" 0-100,
+   "DELAY" in ms, "MODE" 0-20 and so on. "BPM" sets the tempo for synced pre-delay. The rest
+   keep their values. Returns how many of the IDs weren't known, or -1 if an argument is
+   invalid. */
+int fdnr_set_params(fdnr_reverb* reverb, const char* const* ids, const float* values, int count);
+
+/* Sets a mode and its character, as picking it from the plugin's MODE menu does. Returns 0, or
+   -1 if there is no such mode. */
+int fdnr_set_mode(fdnr_reverb* reverb, int mode);
+
+/* Processes num_samples of each channel in place. Blocks longer than the prepared size are
+   split. Returns 0, or -1 if not prepared for num_channels. */
+int fdnr_process_planar(fdnr_reverb* reverb, float* const* channels, int num_channels, int num_samples);
+
+/* Delay of the output in samples, from the limiter's lookahead */
+int fdnr_get_latency(const fdnr_reverb* reverb);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,244 @@
+#include "FlightRecorder.h"
+#include "EventLog.h"
+#include <type_traits>
+
+namespace
+{
+    constexpr char captureMagic[8] = { 'F', 'D', 'N', 'R', 'R', 'E', 'C', '1' };
+    constexpr uint32_t captureVersion = 1;
+    constexpr size_t headerBytes = 4096;
+
+    static_assert(std::is_trivially_copyable<ReverbParameters>::value, "parameters are stored as bytes");
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "counters are shared through the file");
+
+    size_t alignedSize(size_t bytes) { return (bytes + 63) & ~(size_t)63; }
+
+    juce::File getCaptureFolder()
+    {
+        return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+            .getChildFile("Stancsz Audio")
+            .getChildFile("FND Reverb");
+    }
+
+    // Copies into and out of a ring of capacity samples, starting at a free-running position
+    void writeRing(float* ring, uint64_t capacity, uint64_t position, const float* source, int numSamples)
+    {
+        const auto start = (size_t)(position % capacity);
+        const auto first = (size_t)juce::jmin((uint64_t)numSamples, capacity - start);
+        std::memcpy(ring + start, source, first * sizeof(float));
+        std::memcpy(ring, source + first, ((size_t)numSamples - first) * sizeof(float));
+    }
+
+    void readRing(const float* ring, uint64_t capacity, uint64_t position, float* destination, int numSamples)
+    {
+        const auto start = (size_t)(position % capacity);
+        const auto first = (size_t)juce::jmin((uint64_t)numSamples, capacity - start);
+        std::memcpy(destination, ring + start, first * sizeof(float));
+        std::memcpy(destination + first, ring, ((size_t)numSamples - first) * sizeof(float));
+    }
+}
+
+struct FlightRecorder::Header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t parametersBytes;   // sizeof(ReverbParameters), a capture only replays in a build that agrees
+    double sampleRate;
+    int32_t numChannels, maxBlockSize, delayStorage, reserved;
+    uint64_t audioCapacity, blockCapacity;
+
+    // Published after each block's record and audio are in place
+    std::atomic<uint64_t> framesWritten, blocksWritten;
+};
+
+struct FlightRecorder::BlockRecord
+{
+    uint64_t firstFrame;
+    int32_t numSamples, flags;
+    ReverbParameters params;
+};
+
+FlightRecorder::FlightRecorder() = default;
+FlightRecorder::~FlightRecorder() = default;
+
+bool FlightRecorder::open(const juce::File& file, const juce::dsp::ProcessSpec& spec, DelayStorage storage, double seconds,
+                          int minBlockSamples)
+{
+    close();
+    jassert(minBlockSamples > 0);
+
+    numChannels = (int)spec.numChannels;
+    audioCapacity = (uint64_t)std::ceil(seconds * spec.sampleRate) + spec.maximumBlockSize;
+    blockCapacity = (audioCapacity + (uint64_t)minBlockSamples - 1) / (uint64_t)minBlockSamples + 1;
+
+    const auto blockBytes = alignedSize(blockCapacity * sizeof(BlockRecord));
+    const auto audioBytes = (size_t)audioCapacity * (size_t)(2 * numChannels) * sizeof(float);
+    const auto totalBytes = headerBytes + blockBytes + audioBytes;
+
+    // Sized before mapping, a mapping doesn't grow the file
+    file.getParentDirectory().createDirectory();
+    {
+        juce::FileOutputStream stream(file);
+        if (! stream.openedOk() || ! stream.setPosition((juce::int64)totalBytes) || stream.truncate().failed())
+            return false;
+    }
+
+    mapping = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readWrite);
+    if (mapping->getData() == nullptr || mapping->getSize() != totalBytes)
+    {
+        mapping.reset();
+        return false;
+    }
+
+    // Every page touched now rather than on the audio thread
+    auto* base = static_cast<char*>(mapping->getData());
+    std::memset(base, 0, totalBytes);
+
+    header = reinterpret_cast<Header*>(base);
+    blocks = reinterpret_cast<BlockRecord*>(base + headerBytes);
+    audio = reinterpret_cast<float*>(base + headerBytes + blockBytes);
+
+    std::memcpy(header->magic, captureMagic, sizeof(captureMagic));
+    header->version = captureVersion;
+    header->parametersBytes = (uint32_t)sizeof(ReverbParameters);
+    header->sampleRate = spec.sampleRate;
+    header->numChannels = numChannels;
+    header->maxBlockSize = (int32_t)spec.maximumBlockSize;
+    header->delayStorage = (int32_t)storage;
+    header->audioCapacity = audioCapacity;
+    header->blockCapacity = blockCapacity;
+    header->framesWritten.store(0);
+    header->blocksWritten.store(0);
+
+    frame = 0;
+    blockSamples = 0;
+    return true;
+}
+
+void FlightRecorder::close()
+{
+    mapping.reset();
+    header = nullptr;
+    blocks = nullptr;
+    audio = nullptr;
+}
+
+void FlightRecorder::recordInput(const juce::dsp::AudioBlock<float>& block, const ReverbParameters& params, int flags)
+{
+    if (header == nullptr)
+        return;
+
+    frame = header->framesWritten.load(std::memory_order_relaxed);
+    blockSamples = (int)juce::jmin((uint64_t)block.getNumSamples(), audioCapacity);
+
+    auto& record = blocks[header->blocksWritten.load(std::memory_order_relaxed) % blockCapacity];
+    record.firstFrame = frame;
+    record.numSamples = blockSamples;
+    record.flags = flags;
+    record.params = params;
+
+    const int channels = juce::jmin(numChannels, (int)block.getNumChannels());
+    for (int ch = 0; ch < channels; ++ch)
+        writeRing(audio + (size_t)ch * audioCapacity, audioCapacity, frame, block.getChannelPointer((size_t)ch), blockSamples);
+}
+
+void FlightRecorder::recordOutput(const juce::dsp::AudioBlock<float>& block)
+{
+    if (header == nullptr)
+        return;
+
+    const int channels = juce::jmin(numChannels, (int)block.getNumChannels());
+    for (int ch = 0; ch < channels; ++ch)
+        writeRing(audio + (size_t)(numChannels + ch) * audioCapacity, audioCapacity, frame, block.getChannelPointer((size_t)ch), blockSamples);
+
+    header->framesWritten.store(frame + (uint64_t)blockSamples, std::memory_order_release);
+    header->blocksWritten.fetch_add(1, std::memory_order_release);
+}
+
+juce::File FlightRecorder::getDefaultFile(int instanceId)
+{
+    return getCaptureFolder().getChildFile("flight-" + juce::String(EventLog::getProcessId()) + "-" + juce::String(instanceId) + ".fdnrrec");
+}
+
+void FlightRecorder::deleteOldCaptures(juce::RelativeTime maxAge)
+{
+    const auto cutoff = juce::Time::getCurrentTime() - maxAge;
+
+    for (const auto& file : getCaptureFolder().findChildFiles(juce::File::findFiles, false, "flight-*.fdnrrec"))
+        if (file.getLastModificationTime() < cutoff)
+            file.deleteFile();
+}
+
+//==============================================================================
+bool FlightRecording::open(const juce::File& file)
+{
+    if (! file.existsAsFile())
+    {
+        error = "no such file";
+        return false;
+    }
+
+    mapping = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly);
+    const auto size = mapping->getSize();
+    const auto* base = static_cast<const char*>(mapping->getData());
+    header = reinterpret_cast<const FlightRecorder::Header*>(base);
+
+    if (base == nullptr || size < headerBytes || std::memcmp(header->magic, captureMagic, sizeof(captureMagic)) != 0)
+    {
+        error = "not a flight recorder capture";
+        return false;
+    }
+
+    if (header->version != captureVersion || header->parametersBytes != sizeof(ReverbParameters))
+    {
+        error = "captured by a different version of the plugin";
+        return false;
+    }
+
+    sampleRate = header->sampleRate;
+    numChannels = header->numChannels;
+    maxBlockSize = header->maxBlockSize;
+    storage = (DelayStorage)header->delayStorage;
+    audioCapacity = header->audioCapacity;
+    blockCapacity = header->blockCapacity;
+
+    const auto blockBytes = alignedSize(blockCapacity * sizeof(FlightRecorder::BlockRecord));
+    if (size != headerBytes + blockBytes + (size_t)audioCapacity * (size_t)(2 * numChannels) * sizeof(float))
+    {
+        error = "capture is truncated";
+        return false;
+    }
+
+    blocks = reinterpret_cast<const FlightRecorder::BlockRecord*>(base + headerBytes);
+    audio = reinterpret_cast<const float*>(base + headerBytes + blockBytes);
+
+    // The oldest blocks whose records or audio have been written over are dropped
+    const auto framesWritten = header->framesWritten.load(std::memory_order_acquire);
+    endBlock = header->blocksWritten.load(std::memory_order_acquire);
+    firstBlock = endBlock > blockCapacity ? endBlock - blockCapacity : 0;
+
+    while (firstBlock < endBlock && framesWritten - getBlock(firstBlock).firstFrame > audioCapacity)
+        ++firstBlock;
+
+    return true;
+}
+
+FlightRecording::Block FlightRecording::getBlock(uint64_t index) const
+{
+    const auto& record = blocks[index % blockCapacity];
+
+    Block block;
+    block.firstFrame = record.firstFrame;
+    block.numSamples = record.numSamples;
+    block.flags = record.flags;
+    block.params = record.params;
+    return block;
+}
+
+void FlightRecording::readAudio(const Block& block, bool output, juce::AudioBuffer<float>& destination) const
+{
+    const int channels = juce::jmin(numChannels, destination.getNumChannels());
+    for (int ch = 0; ch < channels; ++ch)
+        readRing(audio + (size_t)((output ? numChannels : 0) + ch) * audioCapacity, audioCapacity, block.firstFrame,
+                 destination.getWritePointer(ch), block.numSamples);
+}
@@ -0,0 +1,113 @@
+#pragma once
+#include <juce_dsp/juce_dsp.h>
+#include <atomic>
+#include <memory>
+#include "ReverbProcessor.h"
+
+// Flight recorder: the last seconds of input, output and per-block ReverbParameters of one
+// processor, written into a memory-mapped ring file. The audio thread only copies into mapped
+// memory, so it makes no syscalls, and what was written survives a crash of the host.
+// FlightRecording reads a capture back for replay (Tools/FlightReplay).
+//
+// File layout: a header page, then a ring of block records, then the audio as planar rings,
+// the input channels followed by the output channels.
+class FlightRecorder
+{
+public:
+    static constexpr double defaultSeconds = 30.0;
+
+    // Block flags, with the quality tier from bit 8 up
+    enum Flags
+    {
+        clearFlag   = 1 << 0,   // ReverbProcessor::clear() was called before the block
+        offlineFlag = 1 << 1,   // Quality::offline
+        tierShift   = 8
+    };
+
+    FlightRecorder();
+    ~FlightRecorder();
+
+    // Off the audio thread. Creates or replaces the file and touches all of it, so the audio
+    // thread doesn't fault pages in. Recording starts from the first block after. The block
+    // ring has a record for every minBlockSamples of audio, the processor's sub-block size:
+    // only host blocks shorter than that make it wrap before the audio does.
+    bool open(const juce::File& file, const juce::dsp::ProcessSpec& spec, DelayStorage storage, double seconds = defaultSeconds,
+              int minBlockSamples = ReverbProcessor::defaultSubBlockSize);
+    void close();
+    bool isOpen() const { return mapping != nullptr; }
+
+    // Audio thread, either side of ReverbProcessor::process() on the same block
+    void recordInput(const juce::dsp::AudioBlock<float>& block, const ReverbParameters& params, int flags);
+    void recordOutput(const juce::dsp::AudioBlock<float>& block);
+
+    // flight-<process>-<instance>.fdnrrec in the user's application data folder, see
+    // EventLog::getProcessId()
+    static juce::File getDefaultFile(int instanceId);
+
+    // Deletes the captures in that folder not written to for longer than maxAge. A capture
+    // still being recorded is recent, or on Windows can't be deleted.
+    static void deleteOldCaptures(juce::RelativeTime maxAge = juce::RelativeTime::days(1));
+
+private:
+    struct Header;
+    struct BlockRecord;
+
+    std::unique_ptr<juce::MemoryMappedFile> mapping;
+    Header* header = nullptr;
+    BlockRecord* blocks = nullptr;
+    float* audio = nullptr;
+    int numChannels = 0;
+    uint64_t audioCapacity = 0, blockCapacity = 0;
+
+    // Block between recordInput() and recordOutput()
+    uint64_t frame = 0;
+    int blockSamples = 0;
+
+    friend class FlightRecording;
+    JUCE_DECLARE_NON_COPYABLE (FlightRecorder)
+};
+
+// Read-only view of a capture
+class FlightRecording
+{
+public:
+    struct Block
+    {
+        uint64_t firstFrame = 0;
+        int numSamples = 0;
+        int flags = 0;
+        ReverbParameters params;
+    };
+
+    // False with a reason in getError() if the file isn't a capture this build can replay
+    bool open(const juce::File& file);
+    const juce::String& getError() const { return error; }
+
+    double getSampleRate() const { return sampleRate; }
+    int getNumChannels() const { return numChannels; }
+    int getMaxBlockSize() const { return maxBlockSize; }
+    DelayStorage getDelayStorage() const { return storage; }
+
+    // Blocks still whole in the rings, as [first, end). The reverb's state before the first
+    // is lost unless it is the first block after prepare().
+    uint64_t getFirstBlock() const { return firstBlock; }
+    uint64_t getEndBlock() const { return endBlock; }
+    bool startsAtPrepare() const { return firstBlock == 0; }
+
+    Block getBlock(uint64_t index) const;
+
+    // A block's input or output, into the start of each channel of destination
+    void readAudio(const Block& block, bool output, juce::AudioBuffer<float>& destination) const;
+
+private:
+    std::unique_ptr<juce::MemoryMappedFile> mapping;
+    const FlightRecorder::Header* header = nullptr;
+    const FlightRecorder::BlockRecord* blocks = nullptr;
+    const float* audio = nullptr;
+
+    juce::String error;
+    double sampleRate = 0.0;
+    int numChannels = 0, maxBlockSize = 0;
+    DelayStorage storage = DelayStorage::float32;
+    uint64_t audioCapacity = 0, blockCapacity = 0, firstBlock = 0, endBlock = 0;
+};
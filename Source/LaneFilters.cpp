@@ -0,0 +1,332 @@
+#include "LaneFilters.h"
+#include <cmath>
+
+using namespace LaneFilters;
+
+namespace
+{
+    constexpr int chunkSize = 64;
+}
+
+// Samples are transposed into registers in chunks. Going through a buffer keeps the scalar
+// writes away from the vector reads that follow them.
+struct LaneFilters::ChannelGroup
+{
+    float* data[laneCount];
+    int numChannels;
+
+    ChannelGroup(const juce::dsp::AudioBlock<float>& block, int group, int totalChannels)
+    {
+        const int first = group * laneCount;
+        numChannels = std::min(laneCount, totalChannels - first);
+        for (int l = 0; l < numChannels; ++l)
+            data[l] = block.getChannelPointer((size_t)(first + l));
+    }
+
+    // Unused lanes are zero
+    void load(Lanes* frames, int start, int numSamples) const
+    {
+        alignas(Lanes::SIMDRegisterSize) float interleaved[chunkSize * laneCount] = {};
+        for (int l = 0; l < numChannels; ++l)
+            for (int t = 0; t < numSamples; ++t)
+                interleaved[t * laneCount + l] = data[l][start + t];
+
+        for (int t = 0; t < numSamples; ++t)
+            frames[t] = Lanes::fromRawArray(interleaved + t * laneCount);
+    }
+
+    void store(const Lanes* frames, int start, int numSamples) const
+    {
+        alignas(Lanes::SIMDRegisterSize) float interleaved[chunkSize * laneCount];
+        for (int t = 0; t < numSamples; ++t)
+            frames[t].copyToRawArray(interleaved + t * laneCount);
+
+        for (int l = 0; l < numChannels; ++l)
+            for (int t = 0; t < numSamples; ++t)
+                data[l][start + t] = interleaved[t * laneCount + l];
+    }
+};
+
+//==============================================================================
+void BiquadCascade::prepare(int channels, int stages)
+{
+    jassert(stages > 0 && stages <= maxStages);
+    numChannels = channels;
+    numStages = stages;
+
+    // Pass-through until the stages are set
+    coefficients.assign((size_t)(numStages * 5), Lanes::expand(0.0f));
+    for (int k = 0; k < numStages; ++k)
+        coefficients[(size_t)(k * 5)] = Lanes::expand(1.0f);
+
+    state.assign((size_t)(getNumGroups(numChannels) * numStages * 2), Lanes::expand(0.0f));
+}
+
+void BiquadCascade::reset()
+{
+    std::fill(state.begin(), state.end(), Lanes::expand(0.0f));
+}
+
+void BiquadCascade::setStage(int stage, const float* newCoefficients)
+{
+    jassert(stage >= 0 && stage < numStages);
+    for (int i = 0; i < 5; ++i)
+        coefficients[(size_t)(stage * 5 + i)] = Lanes::expand(newCoefficients[i]);
+}
+
+void BiquadCascade::process(const juce::dsp::AudioBlock<float>& block)
+{
+    const auto channels = std::min((int)block.getNumChannels(), numChannels);
+    const auto numSamples = (int)block.getNumSamples();
+
+    for (int group = 0; group < getNumGroups(channels); ++group)
+    {
+        ChannelGroup lanes(block, group, channels);
+        auto* groupState = state.data() + group * numStages * 2;
+
+        switch (numStages)
+        {
+            case 1: processGroup<1>(lanes, numSamples, groupState); break;
+            case 2: processGroup<2>(lanes, numSamples, groupState); break;
+            case 3: processGroup<3>(lanes, numSamples, groupState); break;
+            case 4: processGroup<4>(lanes, numSamples, groupState); break;
+            default: break;
+        }
+    }
+}
+
+template <int NumStages>
+void BiquadCascade::processGroup(const ChannelGroup& lanes, int numSamples, Lanes* groupState)
+{
+    Lanes b0[(size_t)NumStages], b1[(size_t)NumStages], b2[(size_t)NumStages], a1[(size_t)NumStages], a2[(size_t)NumStages];
+    Lanes s1[(size_t)NumStages], s2[(size_t)NumStages];
+
+    for (int k = 0; k < NumStages; ++k)
+    {
+        const auto* c = coefficients.data() + k * 5;
+        b0[k] = c[0]; b1[k] = c[1]; b2[k] = c[2]; a1[k] = c[3]; a2[k] = c[4];
+        s1[k] = groupState[k * 2];
+        s2[k] = groupState[k * 2 + 1];
+    }
+
+    Lanes frames[chunkSize];
+
+    for (int start = 0; start < numSamples; start += chunkSize)
+    {
+        const int n = std::min(chunkSize, numSamples - start);
+        lanes.load(frames, start, n);
+
+        for (int t = 0; t < n; ++t)
+        {
+            auto x = frames[t];
+
+            for (int k = 0; k < NumStages; ++k)
+            {
+                const auto y = b0[k] * x + s1[k];
+                s1[k] = b1[k] * x - a1[k] * y + s2[k];
+                s2[k] = b2[k] * x - a2[k] * y;
+                x = y;
+            }
+
+            frames[t] = x;
+        }
+
+        lanes.store(frames, start, n);
+    }
+
+    for (int k = 0; k < NumStages; ++k)
+    {
+        groupState[k * 2] = s1[k];
+        groupState[k * 2 + 1] = s2[k];
+    }
+}
+
+//==============================================================================
+void MultiBandDynamicEq::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    sampleRate = spec.sampleRate;
+    numChannels = (int)spec.numChannels;
+    state.assign((size_t)(numChannels * 2), Lanes::expand(0.0f));
+    makeupPerSample.assign(spec.maximumBlockSize, Lanes::expand(0.0f));
+
+    attack = Lanes::expand(1.0f - std::exp(-1.0f / (0.005f * (float)sampleRate)));
+    release = Lanes::expand(1.0f - std::exp(-1.0f / (0.1f * (float)sampleRate)));
+
+    for (int b = 0; b < maxBands; ++b)
+    {
+        updateFilter(b);
+        staticMakeup[b] = juce::Decibels::decibelsToGain(bands[b].gain) - 1.0f;
+        thresholdGain[b] = juce::Decibels::decibelsToGain(bands[b].threshold, -1000.0f);
+    }
+
+    // Spare lanes, if the registers are wider, run a copy of the last band at no gain
+    for (int lane = maxBands; lane < laneCount; ++lane)
+    {
+        g.set((size_t)lane, g.get(maxBands - 1));
+        damping.set((size_t)lane, damping.get(maxBands - 1));
+        norm.set((size_t)lane, norm.get(maxBands - 1));
+    }
+
+    reset();
+}
+
+void MultiBandDynamicEq::reset()
+{
+    const auto zero = Lanes::expand(0.0f);
+    std::fill(state.begin(), state.end(), zero);
+
+    detectorS1 = zero;
+    detectorS2 = zero;
+    envelope = zero;
+
+    makeup = zero;
+    makeupStep = zero;
+    samplesToUpdate = 0;
+}
+
+void MultiBandDynamicEq::setNumBands(int newNumBands)
+{
+    numBands = juce::jlimit(1, maxBands, newNumBands);
+}
+
+void MultiBandDynamicEq::setBand(int index, const Band& band)
+{
+    jassert(index >= 0 && index < maxBands);
+    auto& current = bands[index];
+
+    // Called every sub-block, so only what changed is worked out again
+    if (band.frequency != current.frequency || band.resonance != current.resonance)
+    {
+        current.frequency = band.frequency;
+        current.resonance = band.resonance;
+        updateFilter(index);
+    }
+
+    if (band.gain != current.gain)
+    {
+        current.gain = band.gain;
+        staticMakeup[index] = juce::Decibels::decibelsToGain(current.gain) - 1.0f;
+    }
+
+    if (band.threshold != current.threshold)
+    {
+        current.threshold = band.threshold;
+        thresholdGain[index] = juce::Decibels::decibelsToGain(current.threshold, -1000.0f);
+    }
+
+    current.depth = band.depth;
+}
+
+void MultiBandDynamicEq::updateFilter(int index)
+{
+    const auto& band = bands[index];
+    const auto gain = (float)std::tan(juce::MathConstants<double>::pi * band.frequency / sampleRate);
+    const auto r2 = (float)(1.0 / band.resonance);
+
+    g.set((size_t)index, gain);
+    damping.set((size_t)index, gain + r2);
+    norm.set((size_t)index, (float)(1.0 / (1.0 + r2 * gain + gain * gain)));
+}
+
+void MultiBandDynamicEq::updateTargets()
+{
+    alignas(Lanes::SIMDRegisterSize) float levels[laneCount];
+    alignas(Lanes::SIMDRegisterSize) float targets[laneCount] = {};
+    envelope.copyToRawArray(levels);
+
+    for (int b = 0; b < numBands; ++b)
+    {
+        const auto& band = bands[b];
+        const auto level = levels[b] + 0.00001f;
+
+        // Under the threshold only the static gain applies
+        if (level <= thresholdGain[b] || band.depth == 0.0f)
+        {
+            targets[b] = staticMakeup[b];
+            continue;
+        }
+
+        const auto excessDb = std::max(0.0f, juce::Decibels::gainToDecibels(level) - band.threshold);
+        const auto dynamicGain = band.depth * std::min(1.0f, excessDb / 20.0f);
+        targets[b] = juce::Decibels::decibelsToGain(band.gain + dynamicGain) - 1.0f;
+    }
+
+    makeupStep = (Lanes::fromRawArray(targets) - makeup) * Lanes::expand(1.0f / (float)gainInterval);
+}
+
+void MultiBandDynamicEq::process(const juce::dsp::AudioBlock<float>& block, const float* detector)
+{
+    const auto channels = std::min((int)block.getNumChannels(), numChannels);
+    const auto numSamples = (int)block.getNumSamples();
+    jassert(numSamples <= (int)makeupPerSample.size());
+
+    const auto zero = Lanes::expand(0.0f);
+
+    // 1. Detectors, envelopes and gains of all bands, once for every channel
+    for (int t = 0; t < numSamples; ++t)
+    {
+        const auto x = Lanes::expand(detector[t]);
+
+        const auto yHP = norm * (x - detectorS1 * damping - detectorS2);
+        const auto yBP = yHP * g + detectorS1;
+        detectorS1 = yHP * g + yBP;
+        const auto yLP = yBP * g + detectorS2;
+        detectorS2 = yBP * g + yLP;
+
+        // Attack when the level rises, release when it falls
+        const auto difference = Lanes::max(yBP, zero - yBP) - envelope;
+        envelope = envelope + (Lanes::max(difference, zero) * attack + Lanes::min(difference, zero) * release);
+
+        if (samplesToUpdate == 0)
+        {
+            updateTargets();
+            samplesToUpdate = gainInterval;
+        }
+
+        --samplesToUpdate;
+        makeup = makeup + makeupStep;
+        makeupPerSample[(size_t)t] = makeup;
+    }
+
+    // 2. Every band's bandpass, scaled, added to each channel
+    for (int ch = 0; ch < channels; ++ch)
+    {
+        auto* data = block.getChannelPointer((size_t)ch);
+        auto s1 = state[(size_t)(ch * 2)];
+        auto s2 = state[(size_t)(ch * 2 + 1)];
+
+        alignas(Lanes::SIMDRegisterSize) float boosts[chunkSize * laneCount];
+
+        for (int start = 0; start < numSamples; start += chunkSize)
+        {
+            const int n = std::min(chunkSize, numSamples - start);
+
+            for (int t = 0; t < n; ++t)
+            {
+                const auto x = Lanes::expand(data[start + t]);
+
+                const auto yHP = norm * (x - s1 * damping - s2);
+                const auto yBP = yHP * g + s1;
+                s1 = yHP * g + yBP;
+                const auto yLP = yBP * g + s2;
+                s2 = yBP * g + yLP;
+
+                (makeupPerSample[(size_t)(start + t)] * yBP).copyToRawArray(boosts + t * laneCount);
+            }
+
+            for (int t = 0; t < n; ++t)
+            {
+                const auto* boost = boosts + t * laneCount;
+
+                float sum = boost[0];
+                for (int b = 1; b < maxBands; ++b)
+                    sum += boost[b];
+
+                data[start + t] += sum;
+            }
+        }
+
+        state[(size_t)(ch * 2)] = s1;
+        state[(size_t)(ch * 2 + 1)] = s2;
+    }
+}
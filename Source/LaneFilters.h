@@ -0,0 +1,95 @@
+#pragma once
+#include <juce_dsp/juce_dsp.h>
+
+// Multichannel filters with the channels as lanes of a SIMD register: one register carries
+// a sample of every channel in the group (4 channels with SSE/NEON, so a stereo pair shares
+// one), and all of them go through the filter in a single pass.
+namespace LaneFilters
+{
+    using Lanes = juce::dsp::SIMDRegister<float>;
+    constexpr int laneCount = (int)Lanes::SIMDNumElements;
+
+    inline int getNumGroups(int numChannels) { return (numChannels + laneCount - 1) / laneCount; }
+
+    // Up to laneCount channels of a block, moved in and out of registers
+    struct ChannelGroup;
+}
+
+// Biquad cascade (transposed direct form II), every stage applied to a sample before the
+// next one is read
+class BiquadCascade
+{
+public:
+    static constexpr int maxStages = 4;
+
+    void prepare(int numChannels, int numStages);
+    void reset();
+
+    // b0 b1 b2 a1 a2, normalised by a0 (the raw coefficients of a juce IIR::Coefficients)
+    void setStage(int stage, const float* coefficients);
+
+    void process(const juce::dsp::AudioBlock<float>& block);
+
+private:
+    template <int NumStages>
+    void processGroup(const LaneFilters::ChannelGroup& lanes, int numSamples, LaneFilters::Lanes* state);
+
+    std::vector<LaneFilters::Lanes> coefficients, state;
+    int numChannels = 0, numStages = 0;
+};
+
+// Up to four peaking bands whose boost or cut follows the level in that band, the bands as
+// the lanes of a register. One state variable kernel runs every band's detector on a shared
+// detector signal, another adds every band's bandpass to each channel. Each band has the
+// same response as juce::dsp::StateVariableTPTFilter in bandpass mode.
+class MultiBandDynamicEq
+{
+public:
+    static constexpr int maxBands = 4;
+    static_assert(maxBands <= LaneFilters::laneCount, "every band needs a lane");
+
+    struct Band
+    {
+        float frequency = 1000.0f;
+        float resonance = 1.0f;
+        float gain = 0.0f;          // dB, static
+        float depth = 0.0f;         // dB, reached 20 dB over the threshold
+        float threshold = -20.0f;   // dB
+    };
+
+    void prepare(const juce::dsp::ProcessSpec& spec);
+    void reset();
+
+    // Bands past the count fade out, and stay silent
+    void setNumBands(int newNumBands);
+    void setBand(int index, const Band& band);
+
+    // The detector signal has one value per sample, shared by all channels
+    void process(const juce::dsp::AudioBlock<float>& block, const float* detector);
+
+private:
+    void updateFilter(int index);
+    void updateTargets();
+
+    // Gains are worked out every gainInterval samples and ramped in between
+    static constexpr int gainInterval = 8;
+
+    Band bands[maxBands];
+    float thresholdGain[maxBands] = {}, staticMakeup[maxBands] = {};
+    int numBands = 1;
+
+    // Per band filter coefficients, and the per band detector envelope
+    LaneFilters::Lanes g, damping, norm;
+    LaneFilters::Lanes detectorS1, detectorS2, envelope;
+    LaneFilters::Lanes attack, release;
+
+    // Gain ramp, the bandpass of each band is added scaled by makeup
+    LaneFilters::Lanes makeup, makeupStep;
+    int samplesToUpdate = 0;
+    std::vector<LaneFilters::Lanes> makeupPerSample;
+
+    std::vector<LaneFilters::Lanes> state;
+    int numChannels = 0;
+
+    double sampleRate = 44100.0;
+};
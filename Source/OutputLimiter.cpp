@@ -0,0 +1,333 @@
+#include "OutputLimiter.h"
+#include <cmath>
+
+void OutputLimiter::setLookahead(float newLookaheadMs)
+{
+    lookaheadMs = std::max(0.0f, newLookaheadMs);
+}
+
+namespace
+{
+    // Modified Bessel function of the first kind, order 0, for the Kaiser window
+    double besselI0(double x)
+    {
+        double sum = 1.0, term = 1.0;
+        for (int k = 1; k < 32; ++k)
+        {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+        }
+        return sum;
+    }
+}
+
+void OutputLimiter::makeInterpolator()
+{
+    static_assert(Lanes::SIMDNumElements >= oversampling, "the interpolator phases need a lane each");
+    constexpr int laneCount = (int)Lanes::SIMDNumElements;
+    constexpr double pi = juce::MathConstants<double>::pi;
+
+    // Kaiser windowed sinc, flat to within 0.1% up to 0.35 of the sample rate. Phase 0 falls
+    // on the centre tap and is the sample itself, lanes past the last phase repeat it.
+    const double beta = 5.5, halfWidth = numTaps / 2;
+    alignas(Lanes::SIMDRegisterSize) float coefficients[numTaps][laneCount] = {};
+    interpolatorBound = 0.0f;
+
+    for (int p = 0; p < oversampling; ++p)
+    {
+        double phase[numTaps], sum = 0.0;
+        for (int j = 0; j < numTaps; ++j)
+        {
+            const double u = j - centreTap - (double)p / oversampling;
+            const double x = u / halfWidth;
+            const double sinc = u == 0.0 ? 1.0 : std::sin(pi * u) / (pi * u);
+            const double window = besselI0(beta * std::sqrt(std::max(0.0, 1.0 - x * x))) / besselI0(beta);
+            phase[j] = sinc * window;
+            sum += phase[j];
+        }
+
+        // Unity gain at DC, and the largest output a phase can give for a given input peak
+        float absSum = 0.0f;
+        for (int j = 0; j < numTaps; ++j)
+        {
+            coefficients[j][p] = (float)(phase[j] / sum);
+            absSum += std::abs(coefficients[j][p]);
+        }
+
+        interpolatorBound = std::max(interpolatorBound, absSum);
+    }
+
+    for (int j = 0; j < numTaps; ++j)
+    {
+        for (int p = oversampling; p < laneCount; ++p)
+            coefficients[j][p] = coefficients[j][0];
+
+        taps[j] = Lanes::fromRawArray(coefficients[j]);
+    }
+
+    // Headroom for rounding in the interpolator itself
+    interpolatorBound *= 1.001f;
+}
+
+void OutputLimiter::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    sampleRate = spec.sampleRate;
+
+    // The interpolator looks numTaps - 1 - centreTap samples ahead of the sample it rates
+    lookahead = std::max(1, juce::roundToInt(lookaheadMs * sampleRate / 1000.0));
+    latency = lookahead - 1 + numTaps - 1 - centreTap;
+
+    const auto numChannels = (size_t)spec.numChannels;
+    const auto maxBlock = (size_t)spec.maximumBlockSize;
+
+    const int ringSize = juce::nextPowerOfTwo(latency + (int)maxBlock + 1);
+    ringMask = ringSize - 1;
+    delayRings.assign(numChannels, std::vector<float>((size_t)ringSize, 0.0f));
+    history.assign(numTaps - 1 + maxBlock, 0.0f);
+    truePeaks.assign(maxBlock, Lanes::expand(0.0f));
+
+    required.assign(maxBlock, 1.0f);
+    gains.assign(maxBlock, 1.0f);
+
+    const int queueCapacity = juce::nextPowerOfTwo(lookahead + 1);
+    queueMask = queueCapacity - 1;
+    queueIndex.assign((size_t)queueCapacity, 0);
+    queueValue.assign((size_t)queueCapacity, 1.0f);
+
+    box.assign((size_t)lookahead, 1.0f);
+
+    makeInterpolator();
+    setThreshold(thresholdDb);
+    setRelease(releaseMs);
+    reset();
+}
+
+void OutputLimiter::reset()
+{
+    for (auto& ring : delayRings)
+        std::fill(ring.begin(), ring.end(), 0.0f);
+    ringPos = 0;
+    uncheckedSamples = 0;
+
+    queueHead = 0;
+    queueSize = 0;
+    sampleIndex = 0;
+
+    std::fill(box.begin(), box.end(), 1.0f);
+    boxSum = (double)lookahead;
+    boxPos = 0;
+    boxBelowUnity = 0;
+
+    envelope = 1.0f;
+}
+
+void OutputLimiter::setThreshold(float newThresholdDb)
+{
+    const auto newThreshold = juce::Decibels::decibelsToGain(newThresholdDb);
+
+    // What is already in the delay line was only checked against the old threshold
+    if (newThreshold < threshold)
+        uncheckedSamples = latency;
+
+    thresholdDb = newThresholdDb;
+    threshold = newThreshold;
+}
+
+void OutputLimiter::setRelease(float newReleaseMs)
+{
+    releaseMs = std::max(1.0f, newReleaseMs);
+    releaseCoeff = 1.0f - std::exp(-1.0f / (releaseMs * 0.001f * (float)sampleRate));
+}
+
+void OutputLimiter::process(const juce::dsp::AudioBlock<float>& block)
+{
+    const auto numChannels = std::min(block.getNumChannels(), delayRings.size());
+    const auto numSamples = (int)block.getNumSamples();
+    float blockPeak = 0.0f;
+
+    // Only the detector needs it
+    if (enabled)
+    {
+        for (size_t ch = 0; ch < numChannels; ++ch)
+        {
+            const auto* in = block.getChannelPointer(ch);
+            blockPeak = std::max(blockPeak, std::max(juce::FloatVectorOperations::findMaximum(in, numSamples),
+                                                     -juce::FloatVectorOperations::findMinimum(in, numSamples)));
+        }
+    }
+
+    process(block, blockPeak);
+}
+
+void OutputLimiter::process(const juce::dsp::AudioBlock<float>& block, float blockPeak)
+{
+    const auto numChannels = (int)std::min(block.getNumChannels(), delayRings.size());
+    const auto numSamples = (int)block.getNumSamples();
+    jassert(numSamples <= (int)gains.size());
+
+    // 1. Input into the delay rings
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        const auto* in = block.getChannelPointer((size_t)ch);
+        auto* ring = delayRings[(size_t)ch].data();
+
+        const int first = std::min(numSamples, ringMask + 1 - ringPos);
+        std::copy(in, in + first, ring + ringPos);
+        std::copy(in + first, in + numSamples, ring);
+    }
+
+    // 2. The gain each sample needs to stay under the threshold
+    const bool reducing = enabled && findRequiredGains(block, numChannels, numSamples, blockPeak);
+
+    // 3. Held, released and smoothed. With nothing to limit and no reduction left the gain
+    // is exactly 1 and is skipped altogether.
+    const bool idle = ! reducing && isIdle();
+
+    if (idle)
+    {
+        sampleIndex += numSamples;
+    }
+    else
+    {
+        for (int t = 0; t < numSamples; ++t)
+            gains[(size_t)t] = nextGain(reducing ? required[(size_t)t] : 1.0f);
+    }
+
+    // Samples that went in while disabled can still be over the threshold, anything checked
+    // since only is if the gain is down
+    if (! enabled)
+        uncheckedSamples = latency;
+    const bool clip = enabled && (! idle || uncheckedSamples > 0);
+    uncheckedSamples = std::max(0, uncheckedSamples - numSamples);
+
+    // 4. Delayed output
+    const int readPos = (ringPos - latency) & ringMask;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto* out = block.getChannelPointer((size_t)ch);
+        const auto* ring = delayRings[(size_t)ch].data();
+
+        const int first = std::min(numSamples, ringMask + 1 - readPos);
+        std::copy(ring + readPos, ring + readPos + first, out);
+        std::copy(ring, ring + numSamples - first, out + first);
+
+        if (! idle)
+            juce::FloatVectorOperations::multiply(out, gains.data(), numSamples);
+
+        if (clip)
+            juce::FloatVectorOperations::clip(out, out, -threshold, threshold, numSamples);
+    }
+
+    ringPos = (ringPos + numSamples) & ringMask;
+}
+
+bool OutputLimiter::findRequiredGains(const juce::dsp::AudioBlock<float>& block, int numChannels, int numSamples, float blockPeak)
+{
+    // Nothing can go over the threshold unless the loudest sample the interpolator reads,
+    // times the largest sum of its taps, does. It reads numTaps - 1 samples from before the
+    // block, still in the delay ring.
+    const int historyPos = (ringPos - (numTaps - 1)) & ringMask;
+    float peak = blockPeak;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        const auto* ring = delayRings[(size_t)ch].data();
+        for (int i = 0; i < numTaps - 1; ++i)
+            peak = std::max(peak, std::abs(ring[(historyPos + i) & ringMask]));
+    }
+
+    if (peak * interpolatorBound <= threshold)
+        return false;
+
+    // True peak around each sample, the four phases at once, the loudest channel wins
+    const auto zero = Lanes::expand(0.0f);
+    std::fill(truePeaks.begin(), truePeaks.begin() + numSamples, zero);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        // History and block in one run
+        auto* run = history.data();
+        const auto* ring = delayRings[(size_t)ch].data();
+        const auto* in = block.getChannelPointer((size_t)ch);
+        for (int i = 0; i < numTaps - 1; ++i)
+            run[i] = ring[(historyPos + i) & ringMask];
+        std::copy(in, in + numSamples, run + numTaps - 1);
+
+        for (int t = 0; t < numSamples; ++t)
+        {
+            auto sum = taps[0] * Lanes::expand(run[t]);
+            for (int j = 1; j < numTaps; ++j)
+                sum = sum + taps[j] * Lanes::expand(run[t + j]);
+
+            auto& truePeak = truePeaks[(size_t)t];
+            truePeak = Lanes::max(truePeak, Lanes::max(sum, zero - sum));
+        }
+    }
+
+    for (int t = 0; t < numSamples; ++t)
+    {
+        alignas(Lanes::SIMDRegisterSize) float phases[Lanes::SIMDNumElements];
+        truePeaks[(size_t)t].copyToRawArray(phases);
+
+        float peakAtT = phases[0];
+        for (int p = 1; p < oversampling; ++p)
+            peakAtT = std::max(peakAtT, phases[p]);
+
+        required[(size_t)t] = peakAtT > threshold ? threshold / peakAtT : 1.0f;
+    }
+
+    return true;
+}
+
+float OutputLimiter::nextGain(float requiredGain)
+{
+    const auto index = sampleIndex++;
+
+    // Sliding minimum: a larger gain queued before this one can never be the minimum again
+    if (requiredGain < 1.0f)
+    {
+        while (queueSize > 0 && queueValue[(size_t)((queueHead + queueSize - 1) & queueMask)] >= requiredGain)
+            --queueSize;
+
+        const auto back = (size_t)((queueHead + queueSize) & queueMask);
+        queueIndex[back] = index;
+        queueValue[back] = requiredGain;
+        ++queueSize;
+    }
+
+    while (queueSize > 0 && queueIndex[(size_t)queueHead] <= index - lookahead)
+    {
+        queueHead = (queueHead + 1) & queueMask;
+        --queueSize;
+    }
+
+    const float held = queueSize > 0 ? queueValue[(size_t)queueHead] : 1.0f;
+
+    // Instant attack, the moving average turns it into a ramp over the lookahead
+    if (held < envelope)
+    {
+        envelope = held;
+    }
+    else
+    {
+        envelope += (held - envelope) * releaseCoeff;
+        if (held == 1.0f && envelope > 0.99999f)
+            envelope = 1.0f;
+    }
+
+    const float oldest = box[(size_t)boxPos];
+    box[(size_t)boxPos] = envelope;
+    boxPos = boxPos + 1 == lookahead ? 0 : boxPos + 1;
+    boxBelowUnity += (envelope < 1.0f ? 1 : 0) - (oldest < 1.0f ? 1 : 0);
+
+    // Back to exactly 1 once the window is clear, so the running sum can't drift
+    if (boxBelowUnity == 0)
+    {
+        boxSum = (double)lookahead;
+        return 1.0f;
+    }
+
+    boxSum += (double)envelope - (double)oldest;
+    return (float)(boxSum / lookahead);
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <juce_dsp/juce_dsp.h>
+#include <cstdint>
+
+// True-peak lookahead limiter for the output. Inter-sample peaks are estimated at 4x with a
+// polyphase interpolator whose four phases are the lanes of one SIMD register. The gain each
+// peak calls for is held over the lookahead window by a sliding minimum (a monotonic queue,
+// O(1) per sample), released, then smoothed by a moving average as long as the window, so it
+// is fully down by the time the delayed peak comes out. All channels share one gain.
+class OutputLimiter
+{
+public:
+    // In milliseconds, takes effect on the next prepare()
+    void setLookahead(float lookaheadMs);
+
+    void prepare(const juce::dsp::ProcessSpec& spec);
+    void reset();
+
+    void setThreshold(float thresholdDb);
+    void setRelease(float releaseMs);
+
+    // Disabled, the signal is only delayed, so the latency doesn't change
+    void setEnabled(bool shouldBeEnabled) { enabled = shouldBeEnabled; }
+
+    // Delay from input to output: the lookahead plus the interpolator's centre tap
+    int getLatencySamples() const { return latency; }
+
+    void process(const juce::dsp::AudioBlock<float>& block);
+
+    // Same, with the block's largest magnitude across channels already known, so the
+    // detector doesn't have to scan the block for it
+    void process(const juce::dsp::AudioBlock<float>& block, float blockPeak);
+
+private:
+    using Lanes = juce::dsp::SIMDRegister<float>;
+
+    static constexpr int oversampling = 4;
+    static constexpr int numTaps = 12;
+    static constexpr int centreTap = numTaps / 2 - 1;
+
+    void makeInterpolator();
+    bool findRequiredGains(const juce::dsp::AudioBlock<float>& block, int numChannels, int numSamples, float blockPeak);
+    bool isIdle() const { return queueSize == 0 && envelope == 1.0f && boxBelowUnity == 0; }
+    float nextGain(float required);
+
+    // Interpolator coefficients, lane p of tap j is the phase p / 4 of the way past the centre
+    Lanes taps[numTaps];
+    float interpolatorBound = 1.0f;
+
+    std::vector<std::vector<float>> delayRings;
+    int ringMask = 0, ringPos = 0, uncheckedSamples = 0;
+
+    // Interpolator input, and the gain each sample needs
+    std::vector<float> history, required, gains;
+    std::vector<Lanes> truePeaks;
+
+    // Sliding minimum over the lookahead, gains of 1 aren't stored
+    std::vector<int64_t> queueIndex;
+    std::vector<float> queueValue;
+    int queueMask = 0, queueHead = 0, queueSize = 0;
+    int64_t sampleIndex = 0;
+
+    // Moving average of the released gain
+    std::vector<float> box;
+    double boxSum = 0.0;
+    int boxPos = 0, boxBelowUnity = 0;
+
+    float envelope = 1.0f, releaseCoeff = 0.0f;
+
+    double sampleRate = 44100.0;
+    float lookaheadMs = 1.0f, thresholdDb = -0.1f, releaseMs = 100.0f;
+    float threshold = 1.0f;
+    int lookahead = 1, latency = 0;
+    bool enabled = true;
+};
@@ -5,89 +5,198 @@ FDNRAudioProcessorEditor::FDNRAudioProcessorEditor (FDNRAudioProcessor& p)
     : AudioProcessorEditor (&p), audioProcessor (p)
 {
     setLookAndFeel(&lookAndFeel);
+    setSize(1150, 600);
+}
 
-    // Mix Group
-    addSlider(mixSlider, mixAtt, "MIX", "MIX");
-    addSlider(msBalanceSlider, msBalanceAtt, "MS_BALANCE", "M/S WIDTH");
-    addSlider(duckingSlider, duckingAtt, "DUCKING", "DUCKING");
-    addToggle(limiterButton, limiterAtt, "LIMITER", "LIMITER");
-
-    // Time Group
-    addSlider(delaySlider, delayAtt, "DELAY", "DELAY");
-    addSlider(feedbackSlider, feedbackAtt, "FEEDBACK", "FEEDBACK");
-    addSlider(densitySlider, densityAtt, "DENSITY", "DENSITY");
-    addSlider(diffusionSlider, diffusionAtt, "DIFFUSION", "DIFFUSION");
-
-    // Mod Group
-    addSlider(widthSlider, widthAtt, "WIDTH", "WIDTH");
-    addSlider(warpSlider, warpAtt, "WARP", "WARP");
-    addSlider(modRateSlider, modRateAtt, "MODRATE", "RATE");
-    addSlider(modDepthSlider, modDepthAtt, "MODDEPTH", "DEPTH");
-    addSlider(saturationSlider, saturationAtt, "SATURATION", "SAT");
-    addSlider(gateThreshSlider, gateThreshAtt, "GATE_THRESH", "GATE");
-
-    // Filter Group
-    addSlider(dynFreqSlider, dynFreqAtt, "DYNFREQ", "DYN FREQ");
-    addSlider(dynQSlider, dynQAtt, "DYNQ", "DYN Q");
-    addSlider(dynGainSlider, dynGainAtt, "DYNGAIN", "DYN GAIN");
-    addSlider(dynThreshSlider, dynThreshAtt, "DYNTHRESH", "DYN THR");
-    addSlider(eqLowSlider, eqLowAtt, "EQ3_LOW", "LOW");
-    addSlider(eqMidSlider, eqMidAtt, "EQ3_MID", "MID");
-    addSlider(eqHighSlider, eqHighAtt, "EQ3_HIGH", "HIGH");
-
-    // Utility Group
-    preDelaySyncBox.addItemList({"Free", "1/4", "1/8", "1/16"}, 1);
-    preDelaySyncBox.setTextWhenNothingSelected("Default");
-    addComboBox(preDelaySyncBox, preDelaySyncAtt, "PREDELAY_SYNC", "SYNC");
-
-    addAndMakeVisible(abSwitchButton);
-    abSwitchButton.setButtonText("A/B");
-    abSwitchButton.setToggleState(audioProcessor.isStateA, juce::dontSendNotification);
-    abSwitchButton.onClick = [this]() {
-        audioProcessor.toggleAB();
-        abSwitchButton.setToggleState(audioProcessor.isStateA, juce::dontSendNotification);
-        abSwitchButton.setButtonText(audioProcessor.isStateA ? "A" : "B");
-    };
-    abSwitchButton.setButtonText(audioProcessor.isStateA ? "A" : "B");
-
-    addAndMakeVisible(modeComboBox);
-    modeComboBox.addItemList(audioProcessor.getAPVTS().getParameter("MODE")->getAllValueStrings(), 1);
-    modeComboBox.setTextWhenNothingSelected("Default");
-    modeAtt = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(audioProcessor.getAPVTS(), "MODE", modeComboBox);
-    modeComboBox.setJustificationType(juce::Justification::centred);
-
-    modeLabel.setText("MODE", juce::dontSendNotification);
-    modeLabel.setJustificationType(juce::Justification::centred);
-    modeLabel.setColour(juce::Label::textColourId, juce::Colour(0xFF80FFEA));
-    modeLabel.setFont(juce::Font(12.0f, juce::Font::bold));
-    addAndMakeVisible(modeLabel);
-    modeLabel.attachToComponent(&modeComboBox, false);
-
-    addAndMakeVisible(clearButton);
-    clearButton.onClick = [this]() { audioProcessor.clearTriggered = true; audioProcessor.resetAllParametersToDefault(); };
-
-    addAndMakeVisible(savePresetButton);
-    savePresetButton.onClick = [this]() {
-        fileChooser = std::make_unique<juce::FileChooser>("Save", juce::File::getSpecialLocation(juce::File::userHomeDirectory), "*.json");
-        fileChooser->launchAsync(juce::FileBrowserComponent::saveMode, [this](const juce::FileChooser& c) { audioProcessor.savePreset(c.getResult().withFileExtension("json")); });
-    };
+FDNRAudioProcessorEditor::~FDNRAudioProcessorEditor() { setLookAndFeel(nullptr); }
 
-    addAndMakeVisible(loadPresetButton);
-    loadPresetButton.onClick = [this]() {
-        fileChooser = std::make_unique<juce::FileChooser>("Load", juce::File::getSpecialLocation(juce::File::userHomeDirectory), "*.json");
-        fileChooser->launchAsync(juce::FileBrowserComponent::openMode, [this](const juce::FileChooser& c) { audioProcessor.loadPreset(c.getResult()); });
-    };
+void FDNRAudioProcessorEditor::handleAsyncUpdate()
+{
+    buildGroup(nextGroup++);
+    resized();
 
+    if (! isFullyBuilt())
+        triggerAsyncUpdate();
+}
 
+void FDNRAudioProcessorEditor::finishBuilding()
+{
+    cancelPendingUpdate();
 
-    modeComboBox.onChange = [this]() { audioProcessor.setParametersForMode(modeComboBox.getSelectedId() - 1); };
+    while (! isFullyBuilt())
+        buildGroup(nextGroup++);
 
-    setSize(1150, 600);
+    resized();
 }
 
-FDNRAudioProcessorEditor::~FDNRAudioProcessorEditor() { setLookAndFeel(nullptr); }
+void FDNRAudioProcessorEditor::buildGroup(int index)
+{
+    switch (index)
+    {
+        case 0:
+        {
+            mixGroup = std::make_unique<MixGroup>();
+            auto& g = *mixGroup;
+            addSlider(g.mix, "MIX", "MIX");
+            addSlider(g.msBalance, "MS_BALANCE", "M/S WIDTH");
+            addSlider(g.ducking, "DUCKING", "DUCKING");
+            addToggle(g.limiter, "LIMITER", "LIMITER");
+            break;
+        }
+
+        case 1:
+        {
+            timeGroup = std::make_unique<TimeGroup>();
+            auto& g = *timeGroup;
+            addSlider(g.delay, "DELAY", "DELAY");
+            addSlider(g.feedback, "FEEDBACK", "FEEDBACK");
+            addSlider(g.density, "DENSITY", "DENSITY");
+            addSlider(g.diffusion, "DIFFUSION", "DIFFUSION");
+            break;
+        }
+
+        case 2:
+        {
+            modGroup = std::make_unique<ModGroup>();
+            auto& g = *modGroup;
+            addSlider(g.width, "WIDTH", "WIDTH");
+            addSlider(g.warp, "WARP", "WARP");
+            addSlider(g.modRate, "MODRATE", "RATE");
+            addSlider(g.modDepth, "MODDEPTH", "DEPTH");
+            addSlider(g.saturation, "SATURATION", "SAT");
+            addSlider(g.gateThresh, "GATE_THRESH", "GATE");
+            break;
+        }
+
+        case 3:
+        {
+            filterGroup = std::make_unique<FilterGroup>();
+            auto& g = *filterGroup;
+            // The DYN knobs are attached to whichever band is picked for editing
+            addSlider(g.dynFreq, {}, "DYN FREQ");
+            addSlider(g.dynQ, {}, "DYN Q");
+            addSlider(g.dynGain, {}, "DYN GAIN");
+            addSlider(g.dynThresh, {}, "DYN THR");
+            addSlider(g.eqLow, "EQ3_LOW", "LOW");
+            addSlider(g.eqMid, "EQ3_MID", "MID");
+            addSlider(g.eqHigh, "EQ3_HIGH", "HIGH");
+
+            g.dynBands.addItemList(audioProcessor.getAPVTS().getParameter("DYNBANDS")->getAllValueStrings(), 1);
+            g.dynBands.setJustificationType(juce::Justification::centred);
+            g.dynBands.setTooltip("DYN BANDS");
+            addAndMakeVisible(g.dynBands);
+            comboBoxAttachments.push_back(std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(audioProcessor.getAPVTS(), "DYNBANDS", g.dynBands));
+
+            for (int b = 0; b < MultiBandDynamicEq::maxBands; ++b)
+                g.dynEditBand.addItem("Edit " + juce::String(b + 1), b + 1);
+            g.dynEditBand.setJustificationType(juce::Justification::centred);
+            g.dynEditBand.setTooltip("DYN BAND SHOWN");
+            g.dynEditBand.onChange = [this]() { showDynBand(filterGroup->dynEditBand.getSelectedId() - 1); };
+            addAndMakeVisible(g.dynEditBand);
+            g.dynEditBand.setSelectedId(1, juce::dontSendNotification);
+            showDynBand(0);
+            break;
+        }
+
+        case 4:
+        {
+            utilityGroup = std::make_unique<UtilityGroup>();
+            auto& g = *utilityGroup;
+
+            g.preDelaySync.addItemList({"Free", "1/4", "1/8", "1/16"}, 1);
+            g.preDelaySync.setTextWhenNothingSelected("Default");
+            addComboBox(g.preDelaySync, "PREDELAY_SYNC", "SYNC");
+
+            g.eco.addItemList({"Off", "Half", "Quarter", "Auto"}, 1);
+            g.eco.setTextWhenNothingSelected("Off");
+            addComboBox(g.eco, "ECO", "ECO");
+
+            addAndMakeVisible(g.abSwitch);
+            g.abSwitch.setToggleState(audioProcessor.isStateA, juce::dontSendNotification);
+            g.abSwitch.onClick = [this]() {
+                auto& button = utilityGroup->abSwitch;
+                audioProcessor.toggleAB();
+                button.setToggleState(audioProcessor.isStateA, juce::dontSendNotification);
+                button.setButtonText(audioProcessor.isStateA ? "A" : "B");
+            };
+            g.abSwitch.setButtonText(audioProcessor.isStateA ? "A" : "B");
+
+            addAndMakeVisible(g.mode);
+            g.mode.addItemList(audioProcessor.getAPVTS().getParameter("MODE")->getAllValueStrings(), 1);
+            g.mode.setTextWhenNothingSelected("Default");
+            comboBoxAttachments.push_back(std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(audioProcessor.getAPVTS(), "MODE", g.mode));
+            g.mode.setJustificationType(juce::Justification::centred);
+
+            g.modeLabel.setText("MODE", juce::dontSendNotification);
+            g.modeLabel.setJustificationType(juce::Justification::centred);
+            g.modeLabel.setColour(juce::Label::textColourId, juce::Colour(0xFF80FFEA));
+            g.modeLabel.setFont(EditorFonts::accentLabel());
+            addAndMakeVisible(g.modeLabel);
+            g.modeLabel.attachToComponent(&g.mode, false);
+
+            addAndMakeVisible(g.memory);
+            g.memory.addItemList(audioProcessor.getAPVTS().getParameter("MEMORY")->getAllValueStrings(), 1);
+            g.memory.setJustificationType(juce::Justification::centred);
+            g.memory.setTooltip("Delay memory format. 16-bit halves the memory of the pre-delay and tail for a little noise.");
+            comboBoxAttachments.push_back(std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(audioProcessor.getAPVTS(), "MEMORY", g.memory));
+
+            addAndMakeVisible(g.engine);
+            g.engine.addItemList(audioProcessor.getAPVTS().getParameter("ENGINE")->getAllValueStrings(), 1);
+            g.engine.setJustificationType(juce::Justification::centred);
+            g.engine.setTooltip("Late tail engine. Velvet is a velvet-noise tail at a fraction of the CPU.");
+            comboBoxAttachments.push_back(std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(audioProcessor.getAPVTS(), "ENGINE", g.engine));
+
+            addToggle(g.adaptive, "ADAPTIVE", "ADAPTIVE");
+            g.adaptive.setTooltip("Lower the quality while the CPU can't keep up");
+
+            addToggle(g.eventLog, "EVENT_LOG", "LOG");
+            g.eventLog.setTooltip("Log resets, block size changes, mode switches and overruns to " + EventLogWriter::getLogFile().getFullPathName());
+
+            addToggle(g.flightRecorder, "FLIGHT_RECORDER", "REC");
+            g.flightRecorder.setTooltip("Keep the last " + juce::String((int)FlightRecorder::defaultSeconds) + " seconds of audio and settings in "
+                                        + FlightRecorder::getDefaultFile(0).getParentDirectory().getFullPathName() + " for FlightReplay. Turning it on clears the reverb.");
+
+            g.qualityTier.setJustificationType(juce::Justification::centredLeft);
+            g.qualityTier.setColour(juce::Label::textColourId, juce::Colour(0xFF80FFEA));
+            g.qualityTier.setFont(EditorFonts::controlLabel());
+            addAndMakeVisible(g.qualityTier);
+
+            // The processor sets the tier, this only shows it
+            if (auto* tier = audioProcessor.getAPVTS().getParameter("QUALITY_TIER"))
+            {
+                qualityTierAttachment = std::make_unique<juce::ParameterAttachment>(*tier, [this](float value) {
+                    const auto name = juce::String(QualityController::getTierName(juce::roundToInt(value)));
+                    utilityGroup->qualityTier.setText("QUALITY: " + name.toUpperCase(), juce::dontSendNotification);
+                });
+                qualityTierAttachment->sendInitialUpdate();
+            }
+
+            addAndMakeVisible(g.clear);
+            g.clear.onClick = [this]() { audioProcessor.clearTriggered = true; audioProcessor.resetAllParametersToDefault(); };
+
+            addAndMakeVisible(g.savePreset);
+            g.savePreset.onClick = [this]() {
+                fileChooser = std::make_unique<juce::FileChooser>("Save", juce::File::getSpecialLocation(juce::File::userHomeDirectory), "*.json");
+                fileChooser->launchAsync(juce::FileBrowserComponent::saveMode, [this](const juce::FileChooser& c) { audioProcessor.savePreset(c.getResult().withFileExtension("json")); });
+            };
+
+            addAndMakeVisible(g.loadPreset);
+            g.loadPreset.onClick = [this]() {
+                fileChooser = std::make_unique<juce::FileChooser>("Load", juce::File::getSpecialLocation(juce::File::userHomeDirectory), "*.json");
+                fileChooser->launchAsync(juce::FileBrowserComponent::openMode, [this](const juce::FileChooser& c) { audioProcessor.loadPreset(c.getResult()); });
+            };
+
+            // Set after the attachment, which selects the current mode without applying its preset
+            g.mode.onChange = [this]() { audioProcessor.setParametersForMode(utilityGroup->mode.getSelectedId() - 1); };
+            break;
+        }
+
+        default:
+            break;
+    }
+}
 
-void FDNRAudioProcessorEditor::addSlider(juce::Slider& slider, std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment>& attachment, const juce::String& paramID, const juce::String& name)
+void FDNRAudioProcessorEditor::addSlider(juce::Slider& slider, const juce::String& paramID, const juce::String& name)
 {
     slider.setSliderStyle(juce::Slider::RotaryHorizontalVerticalDrag);
     slider.setTextBoxStyle(juce::Slider::TextBoxAbove, false, 60, 14);
@@ -99,42 +208,63 @@ void FDNRAudioProcessorEditor::addSlider(juce::Slider& slider, std::unique_ptr<j
     label->setText(name, juce::dontSendNotification);
     label->setJustificationType(juce::Justification::centred);
     label->setColour(juce::Label::textColourId, juce::Colours::white);
-    label->setFont(juce::Font(11.0f, juce::Font::bold));
+    label->setFont(EditorFonts::controlLabel());
     label->attachToComponent(&slider, false);
     addAndMakeVisible(*label);
     labels.push_back(std::move(label));
 
     if (audioProcessor.getAPVTS().getParameter(paramID))
-        attachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.getAPVTS(), paramID, slider);
+        sliderAttachments.push_back(std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.getAPVTS(), paramID, slider));
 }
 
-void FDNRAudioProcessorEditor::addComboBox(juce::ComboBox& box, std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment>& attachment, const juce::String& paramID, const juce::String& name)
+void FDNRAudioProcessorEditor::addComboBox(juce::ComboBox& box, const juce::String& paramID, const juce::String& name)
 {
     box.setJustificationType(juce::Justification::centred);
     addAndMakeVisible(box);
     if (audioProcessor.getAPVTS().getParameter(paramID))
-        attachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(audioProcessor.getAPVTS(), paramID, box);
+        comboBoxAttachments.push_back(std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(audioProcessor.getAPVTS(), paramID, box));
 
     auto label = std::make_unique<juce::Label>();
     label->setText(name, juce::dontSendNotification);
     label->setJustificationType(juce::Justification::centred);
     label->setColour(juce::Label::textColourId, juce::Colours::white);
-    label->setFont(juce::Font(11.0f, juce::Font::bold));
+    label->setFont(EditorFonts::controlLabel());
     label->attachToComponent(&box, false);
     addAndMakeVisible(*label);
     labels.push_back(std::move(label));
 }
 
-void FDNRAudioProcessorEditor::addToggle(juce::ToggleButton& button, std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment>& attachment, const juce::String& paramID, const juce::String& name)
+void FDNRAudioProcessorEditor::addToggle(juce::ToggleButton& button, const juce::String& paramID, const juce::String& name)
 {
     button.setButtonText(name);
     addAndMakeVisible(button);
     if (audioProcessor.getAPVTS().getParameter(paramID))
-        attachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(audioProcessor.getAPVTS(), paramID, button);
+        buttonAttachments.push_back(std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(audioProcessor.getAPVTS(), paramID, button));
+}
+
+void FDNRAudioProcessorEditor::showDynBand(int band)
+{
+    auto& g = *filterGroup;
+    auto& apvts = audioProcessor.getAPVTS();
+
+    // The old attachments go first, so they don't write the new band's values to the old one
+    dynBandAttachments.clear();
+
+    const std::pair<juce::Slider*, const char*> knobs[] = {
+        { &g.dynFreq, "FREQ" }, { &g.dynQ, "Q" }, { &g.dynGain, "GAIN" }, { &g.dynThresh, "THRESH" }
+    };
+
+    for (auto& [slider, setting] : knobs)
+        dynBandAttachments.push_back(std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+            apvts, FDNRAudioProcessor::getDynBandParameterID(band, setting), *slider));
 }
 
 void FDNRAudioProcessorEditor::paint(juce::Graphics& g)
 {
+    // The panels are on screen, the controls follow
+    if (nextGroup == 0 && ! isUpdatePending())
+        triggerAsyncUpdate();
+
     juce::ColourGradient bgGradient(juce::Colour(0xFF101010), 0, 0, juce::Colour(0xFF202028), 0, (float)getHeight(), false);
     g.setGradientFill(bgGradient);
     g.fillAll();
@@ -143,10 +273,10 @@ void FDNRAudioProcessorEditor::paint(juce::Graphics& g)
     titleArea.removeFromTop(15); // Top margin
 
     g.setColour(juce::Colours::white);
-    g.setFont(juce::Font("Futura", 24.0f, juce::Font::bold));
+    g.setFont(EditorFonts::title());
     g.drawText("FND Reverb", titleArea.removeFromTop(25), juce::Justification::centred, false);
     
-    g.setFont(juce::Font("Futura", 13.0f, juce::Font::plain));
+    g.setFont(EditorFonts::subtitle());
     g.drawText("Stancsz Audio", titleArea, juce::Justification::centred, false);
 
     auto area = getLocalBounds().reduced(15);
@@ -169,7 +299,7 @@ void FDNRAudioProcessorEditor::paint(juce::Graphics& g)
 
         auto header = r.removeFromTop(30);
         g.setColour(juce::Colour(0xFF80FFEA));
-        g.setFont(juce::Font(16.0f, juce::Font::bold));
+        g.setFont(EditorFonts::groupTitle());
         g.drawText(titles[i], header, juce::Justification::centred, false);
     }
 }
@@ -188,60 +318,73 @@ void FDNRAudioProcessorEditor::resized()
     };
 
     // 1. MIX / LEVEL
+    if (mixGroup != nullptr)
     {
+        auto& g = *mixGroup;
         auto r = getGroup(0);
         auto top = r.removeFromTop(r.getHeight() * 0.32f);
-        mixSlider.setBounds(top.reduced(10));
+        g.mix.setBounds(top.reduced(10));
 
         int h = r.getHeight() / 3;
-        msBalanceSlider.setBounds(r.removeFromTop(h).reduced(15, 4));
-        duckingSlider.setBounds(r.removeFromTop(h).reduced(15, 4));
+        g.msBalance.setBounds(r.removeFromTop(h).reduced(15, 4));
+        g.ducking.setBounds(r.removeFromTop(h).reduced(15, 4));
         
         auto limiterRow = r.removeFromTop(h);
         int buttonWidth = 80;
         int buttonHeight = (limiterRow.getHeight() - 8) / 2;
-        limiterButton.setBounds(limiterRow.getCentreX() - buttonWidth / 2, 
-                                limiterRow.getCentreY() - buttonHeight / 2, 
-                                buttonWidth, 
-                                buttonHeight);
+        g.limiter.setBounds(limiterRow.getCentreX() - buttonWidth / 2, 
+                            limiterRow.getCentreY() - buttonHeight / 2, 
+                            buttonWidth, 
+                            buttonHeight);
     }
 
     // 2. TIME / SIZE
+    if (timeGroup != nullptr)
     {
+        auto& g = *timeGroup;
         auto r = getGroup(1);
         auto top = r.removeFromTop(r.getHeight() * 0.32f);
-        delaySlider.setBounds(top.reduced(10));
+        g.delay.setBounds(top.reduced(10));
 
         int h = r.getHeight() / 3;
-        feedbackSlider.setBounds(r.removeFromTop(h).reduced(15, 4));
-        densitySlider.setBounds(r.removeFromTop(h).reduced(15, 4));
-        diffusionSlider.setBounds(r.removeFromTop(h).reduced(15, 4));
+        g.feedback.setBounds(r.removeFromTop(h).reduced(15, 4));
+        g.density.setBounds(r.removeFromTop(h).reduced(15, 4));
+        g.diffusion.setBounds(r.removeFromTop(h).reduced(15, 4));
     }
 
     // 3. MODULATION
+    if (modGroup != nullptr)
     {
+        auto& g = *modGroup;
         auto r = getGroup(2);
         auto top = r.removeFromTop(r.getHeight() * 0.32f);
-        widthSlider.setBounds(top.reduced(10));
+        g.width.setBounds(top.reduced(10));
 
         int rowH = r.getHeight() / 3;
         int colW = r.getWidth() / 2;
 
         auto row1 = r.removeFromTop(rowH);
-        warpSlider.setBounds(row1.removeFromLeft(colW).reduced(5, 4));
-        modRateSlider.setBounds(row1.reduced(5, 4));
+        g.warp.setBounds(row1.removeFromLeft(colW).reduced(5, 4));
+        g.modRate.setBounds(row1.reduced(5, 4));
 
         auto row2 = r.removeFromTop(rowH);
-        modDepthSlider.setBounds(row2.removeFromLeft(colW).reduced(5, 4));
-        saturationSlider.setBounds(row2.reduced(5, 4));
+        g.modDepth.setBounds(row2.removeFromLeft(colW).reduced(5, 4));
+        g.saturation.setBounds(row2.reduced(5, 4));
 
         auto row3 = r.removeFromTop(rowH);
-        gateThreshSlider.setBounds(row3.removeFromLeft(colW).reduced(5, 4));
+        g.gateThresh.setBounds(row3.removeFromLeft(colW).reduced(5, 4));
     }
 
     // 4. FILTERS / EQ
+    if (filterGroup != nullptr)
     {
+        auto& g = *filterGroup;
         auto r = getGroup(3);
+
+        auto bandRow = r.removeFromTop(24);
+        g.dynEditBand.setBounds(bandRow.removeFromLeft(bandRow.getWidth() / 2).reduced(4, 0));
+        g.dynBands.setBounds(bandRow.reduced(4, 0));
+
         int rowHeight = r.getHeight() / 3;
         
         auto placeTight = [&](juce::Slider& s, juce::Rectangle<int> zone) {
@@ -258,48 +401,62 @@ void FDNRAudioProcessorEditor::resized()
         auto row1 = r.removeFromTop(rowHeight);
         int halfW = row1.getWidth() / 2;
         
-        placeTight(dynFreqSlider, row1.removeFromLeft(halfW).reduced(2));
-        placeTight(dynQSlider, row1.reduced(2));
+        placeTight(g.dynFreq, row1.removeFromLeft(halfW).reduced(2));
+        placeTight(g.dynQ, row1.reduced(2));
 
         auto row2 = r.removeFromTop(rowHeight);
         
-        placeTight(dynGainSlider, row2.removeFromLeft(halfW).reduced(2));
-        placeTight(dynThreshSlider, row2.reduced(2));
+        placeTight(g.dynGain, row2.removeFromLeft(halfW).reduced(2));
+        placeTight(g.dynThresh, row2.reduced(2));
 
         auto row3 = r;
         int thirdW = row3.getWidth() / 3;
         
-        placeTight(eqLowSlider, row3.removeFromLeft(thirdW).reduced(2));
-        placeTight(eqMidSlider, row3.removeFromLeft(thirdW).reduced(2));
-        placeTight(eqHighSlider, row3.reduced(2));
+        placeTight(g.eqLow, row3.removeFromLeft(thirdW).reduced(2));
+        placeTight(g.eqMid, row3.removeFromLeft(thirdW).reduced(2));
+        placeTight(g.eqHigh, row3.reduced(2));
     }
 
     // 5. UTILITY
+    if (utilityGroup != nullptr)
     {
+        auto& g = *utilityGroup;
         auto r = getGroup(4);
-        int h = r.getHeight() / 4;
+        int h = r.getHeight() / 5;
 
-        modeComboBox.setBounds(r.removeFromTop(h).reduced(5, 15));
-        preDelaySyncBox.setBounds(r.removeFromTop(h).reduced(5, 15));
+        g.mode.setBounds(r.removeFromTop(h).reduced(5, 15));
+        g.preDelaySync.setBounds(r.removeFromTop(h).reduced(5, 15));
+        g.eco.setBounds(r.removeFromTop(h).reduced(5, 15));
 
         auto row3 = r.removeFromTop(h);
         int w = row3.getWidth() / 2;
         
         auto b1 = row3.removeFromLeft(w).reduced(5);
-        abSwitchButton.setBounds(b1.getX(), b1.getCentreY() - b1.getHeight() / 4, b1.getWidth(), b1.getHeight() / 2);
+        g.abSwitch.setBounds(b1.getX(), b1.getCentreY() - b1.getHeight() / 4, b1.getWidth(), b1.getHeight() / 2);
         
         auto b2 = row3.reduced(5);
-        savePresetButton.setBounds(b2.getX(), b2.getCentreY() - b2.getHeight() / 4, b2.getWidth(), b2.getHeight() / 2);
+        g.savePreset.setBounds(b2.getX(), b2.getCentreY() - b2.getHeight() / 4, b2.getWidth(), b2.getHeight() / 2);
 
         auto row4 = r.removeFromTop(h);
         
         auto b3 = row4.removeFromLeft(w).reduced(5);
-        loadPresetButton.setBounds(b3.getX(), b3.getCentreY() - b3.getHeight() / 4, b3.getWidth(), b3.getHeight() / 2);
+        g.loadPreset.setBounds(b3.getX(), b3.getCentreY() - b3.getHeight() / 4, b3.getWidth(), b3.getHeight() / 2);
         
         auto b4 = row4.reduced(5);
-        clearButton.setBounds(b4.getX(), b4.getCentreY() - b4.getHeight() / 4, b4.getWidth(), b4.getHeight() / 2);
+        g.clear.setBounds(b4.getX(), b4.getCentreY() - b4.getHeight() / 4, b4.getWidth(), b4.getHeight() / 2);
     }
 
     // Bottom Bar
-
+    if (utilityGroup != nullptr)
+    {
+        auto& g = *utilityGroup;
+        auto r = bottomBar.reduced(10, 12);
+
+        g.flightRecorder.setBounds(r.removeFromRight(70));
+        g.eventLog.setBounds(r.removeFromRight(70));
+        g.adaptive.setBounds(r.removeFromRight(110));
+        g.qualityTier.setBounds(r.removeFromRight(140));
+        g.memory.setBounds(r.removeFromRight(150).reduced(5, 0));
+        g.engine.setBounds(r.removeFromRight(120).reduced(5, 0));
+    }
 }
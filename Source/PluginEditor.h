@@ -1,8 +1,44 @@
 #pragma once
 
 #include <juce_gui_basics/juce_gui_basics.h>
+#include <array>
 #include "PluginProcessor.h"
 
+// Fonts are resolved once per process and shared by every editor, instead of being looked
+// up by name each time a label is painted
+struct EditorFonts
+{
+    static const juce::Font& label()        { return get(0); }  // Verdana 12 bold, LookAndFeel labels
+    static const juce::Font& controlLabel() { return get(1); }  // 11 bold, captions under the controls
+    static const juce::Font& accentLabel()  { return get(2); }  // 12 bold
+    static const juce::Font& groupTitle()   { return get(3); }  // 16 bold
+    static const juce::Font& title()        { return get(4); }  // Futura 24 bold
+    static const juce::Font& subtitle()     { return get(5); }  // Futura 13
+
+private:
+    static const juce::Font& get(int index)
+    {
+        static const std::array<juce::Font, 6> fonts = []
+        {
+            // FontOptions, as JUCE 8 deprecates the name, height and style constructors
+            std::array<juce::Font, 6> result { juce::Font(juce::FontOptions("Verdana", 12.0f, juce::Font::bold)),
+                                               juce::Font(juce::FontOptions(11.0f, juce::Font::bold)),
+                                               juce::Font(juce::FontOptions(12.0f, juce::Font::bold)),
+                                               juce::Font(juce::FontOptions(16.0f, juce::Font::bold)),
+                                               juce::Font(juce::FontOptions("Futura", 24.0f, juce::Font::bold)),
+                                               juce::Font(juce::FontOptions("Futura", 13.0f, juce::Font::plain)) };
+
+            // Resolve the typefaces now, copies share them
+            for (auto& font : result)
+                font.getTypefacePtr();
+
+            return result;
+        }();
+
+        return fonts[(size_t)index];
+    }
+};
+
 class FDNRLookAndFeel : public juce::LookAndFeel_V4
 {
 public:
@@ -86,9 +122,9 @@ public:
         }
     }
 
-    juce::Font getLabelFont (juce::Label& label) override
+    juce::Font getLabelFont (juce::Label&) override
     {
-        return juce::Font("Verdana", 12.0f, juce::Font::bold);
+        return EditorFonts::label();
     }
 
     juce::BorderSize<int> getLabelBorderSize (juce::Label& label) override
@@ -179,7 +215,8 @@ public:
     }
 };
 
-class FDNRAudioProcessorEditor  : public juce::AudioProcessorEditor
+class FDNRAudioProcessorEditor  : public juce::AudioProcessorEditor,
+                                  private juce::AsyncUpdater
 {
 public:
     FDNRAudioProcessorEditor (FDNRAudioProcessor&);
@@ -188,52 +225,75 @@ public:
     void paint (juce::Graphics&) override;
     void resized() override;
 
+    // Controls are built one group per message loop callback after the first paint, so the
+    // window shows up before its controls and attachments exist. This builds the rest now,
+    // e.g. before taking a snapshot.
+    void finishBuilding();
+    bool isFullyBuilt() const { return nextGroup == numGroups; }
+
 private:
     FDNRAudioProcessor& audioProcessor;
     FDNRLookAndFeel lookAndFeel;
 
-    void addSlider(juce::Slider& slider, std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment>& attachment, const juce::String& paramID, const juce::String& name);
-    void addComboBox(juce::ComboBox& box, std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment>& attachment, const juce::String& paramID, const juce::String& name);
-    void addToggle(juce::ToggleButton& button, std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment>& attachment, const juce::String& paramID, const juce::String& name);
+    void handleAsyncUpdate() override;
+    void buildGroup(int index);
 
-    // Sliders & Controls
-    juce::Slider mixSlider, widthSlider, duckingSlider;
-    juce::ComboBox preDelaySyncBox;
+    void addSlider(juce::Slider& slider, const juce::String& paramID, const juce::String& name);
+    void addComboBox(juce::ComboBox& box, const juce::String& paramID, const juce::String& name);
+    void addToggle(juce::ToggleButton& button, const juce::String& paramID, const juce::String& name);
 
-    juce::Slider delaySlider, warpSlider, feedbackSlider, saturationSlider;
+    // Points the DYN knobs at one band of the dynamic EQ
+    void showDynBand(int band);
 
-    juce::Slider densitySlider, modRateSlider, modDepthSlider, diffusionSlider;
-
-    juce::Slider dynFreqSlider, dynQSlider, dynGainSlider, dynThreshSlider;
-
-    juce::Slider eqLowSlider, eqMidSlider, eqHighSlider;
-    juce::Slider msBalanceSlider, gateThreshSlider, abMorphSlider;
-    juce::ToggleButton limiterButton, abSwitchButton;
+    // Groups, in panel order
+    struct MixGroup
+    {
+        juce::Slider mix, msBalance, ducking;
+        juce::ToggleButton limiter;
+    };
 
-    // Attachments
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> mixAtt, widthAtt, duckingAtt;
-    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> preDelaySyncAtt;
+    struct TimeGroup
+    {
+        juce::Slider delay, feedback, density, diffusion;
+    };
 
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> delayAtt, warpAtt, feedbackAtt, saturationAtt;
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> densityAtt, modRateAtt, modDepthAtt, diffusionAtt;
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> dynFreqAtt, dynQAtt, dynGainAtt, dynThreshAtt;
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> eqLowAtt, eqMidAtt, eqHighAtt;
-    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> msBalanceAtt, gateThreshAtt, abMorphAtt;
+    struct ModGroup
+    {
+        juce::Slider width, warp, modRate, modDepth, saturation, gateThresh;
+    };
 
-    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> limiterAtt, abSwitchAtt;
+    struct FilterGroup
+    {
+        juce::Slider dynFreq, dynQ, dynGain, dynThresh, eqLow, eqMid, eqHigh;
+        juce::ComboBox dynBands, dynEditBand;
+    };
 
+    struct UtilityGroup
+    {
+        juce::ComboBox mode, preDelaySync, eco, memory, engine;
+        juce::Label modeLabel;
+        juce::ToggleButton abSwitch, adaptive, eventLog, flightRecorder;
+        juce::Label qualityTier;
+        juce::TextButton clear { "CLEAR" }, savePreset { "SAVE" }, loadPreset { "LOAD" };
+    };
+
+    static constexpr int numGroups = 5;
+    int nextGroup = 0;
+
+    std::unique_ptr<MixGroup> mixGroup;
+    std::unique_ptr<TimeGroup> timeGroup;
+    std::unique_ptr<ModGroup> modGroup;
+    std::unique_ptr<FilterGroup> filterGroup;
+    std::unique_ptr<UtilityGroup> utilityGroup;
+
+    // Declared after the groups so they go before the controls they refer to
     std::vector<std::unique_ptr<juce::Label>> labels;
+    std::vector<std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment>> sliderAttachments;
+    std::vector<std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment>> comboBoxAttachments;
+    std::vector<std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment>> buttonAttachments;
+    std::vector<std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment>> dynBandAttachments;
+    std::unique_ptr<juce::ParameterAttachment> qualityTierAttachment;
 
-    // Mode
-    juce::ComboBox modeComboBox;
-    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> modeAtt;
-    juce::Label modeLabel;
-    juce::Label syncLabel; // Explicit label for sync
-
-    // Buttons
-    juce::TextButton clearButton { "CLEAR" };
-    juce::TextButton savePresetButton { "SAVE" };
-    juce::TextButton loadPresetButton { "LOAD" };
     std::unique_ptr<juce::FileChooser> fileChooser;
     juce::TooltipWindow tooltipWindow;
 
@@ -1,5 +1,6 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "ReverbModes.h"
 
 //==============================================================================
 FDNRAudioProcessor::FDNRAudioProcessor()
@@ -13,10 +14,33 @@ FDNRAudioProcessor::FDNRAudioProcessor()
 {
     stateA = apvts.copyState();
     stateB = apvts.copyState();
+
+    ReverbParameters::fromParameterValues([this](juce::StringRef id, float fallback) {
+        reverbParameterValues.push_back(apvts.getRawParameterValue(id));
+        jassert(reverbParameterValues.back() != nullptr);
+        return fallback;
+    });
+
+    eventLogParameter = apvts.getRawParameterValue("EVENT_LOG");
+    adaptiveParameter = apvts.getRawParameterValue("ADAPTIVE");
+    memoryParameter = apvts.getRawParameterValue("MEMORY");
+    flightRecorderParameter = apvts.getRawParameterValue("FLIGHT_RECORDER");
+    qualityTierParameter = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter("QUALITY_TIER"));
+
+    for (auto* parameter : getParameters())
+        if (auto* withID = dynamic_cast<juce::AudioProcessorParameterWithID*>(parameter))
+            if (! parameter->isAutomatable())
+                settingParameterIDs.add(withID->paramID);
+
+    startTimerHz(10);
+
+    eventLogWriter->add(eventLog);
 }
 
 FDNRAudioProcessor::~FDNRAudioProcessor()
 {
+    stopTimer();
+    eventLogWriter->remove(eventLog);
 }
 
 juce::AudioProcessorValueTreeState::ParameterLayout FDNRAudioProcessor::createParameterLayout()
@@ -32,12 +56,23 @@ juce::AudioProcessorValueTreeState::ParameterLayout FDNRAudioProcessor::createPa
     layout.add(std::make_unique<juce::AudioParameterFloat>("MODRATE", "Mod Rate", 0.0f, 5.0f, 0.5f));
     layout.add(std::make_unique<juce::AudioParameterFloat>("MODDEPTH", "Mod Depth", 0.0f, 100.0f, 50.0f));
 
-    // Dynamic EQ
-    layout.add(std::make_unique<juce::AudioParameterFloat>("DYNFREQ", "Dyn Freq", juce::NormalisableRange<float>(20.0f, 20000.0f, 1.0f, 0.3f), 1000.0f));
-    layout.add(std::make_unique<juce::AudioParameterFloat>("DYNQ", "Dyn Q", 0.1f, 10.0f, 1.0f));
-    layout.add(std::make_unique<juce::AudioParameterFloat>("DYNGAIN", "Dyn Gain", -18.0f, 18.0f, 0.0f));
-    layout.add(std::make_unique<juce::AudioParameterFloat>("DYNDEPTH", "Dyn Depth", -18.0f, 18.0f, 0.0f));
-    layout.add(std::make_unique<juce::AudioParameterFloat>("DYNTHRESH", "Dyn Thresh", -60.0f, 0.0f, -20.0f));
+    // Dynamic EQ, the first band keeps the IDs it had as the only one
+    const ReverbParameters defaults;
+    for (int b = 0; b < MultiBandDynamicEq::maxBands; ++b)
+    {
+        const auto& band = defaults.dynBands[(size_t)b];
+        const auto name = b == 0 ? juce::String("Dyn ") : "Dyn " + juce::String(b + 1) + " ";
+
+        layout.add(std::make_unique<juce::AudioParameterFloat>(getDynBandParameterID(b, "FREQ"), name + "Freq", juce::NormalisableRange<float>(20.0f, 20000.0f, 1.0f, 0.3f), band.frequency));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(getDynBandParameterID(b, "Q"), name + "Q", 0.1f, 10.0f, band.resonance));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(getDynBandParameterID(b, "GAIN"), name + "Gain", -18.0f, 18.0f, band.gain));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(getDynBandParameterID(b, "DEPTH"), name + "Depth", -18.0f, 18.0f, band.depth));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(getDynBandParameterID(b, "THRESH"), name + "Thresh", -60.0f, 0.0f, band.threshold));
+    }
+
+    juce::StringArray bandOptions;
+    bandOptions.add("1 Band"); bandOptions.add("2 Bands"); bandOptions.add("3 Bands"); bandOptions.add("4 Bands");
+    layout.add(std::make_unique<juce::AudioParameterChoice>("DYNBANDS", "Dyn Bands", bandOptions, 0));
 
     // New Features
     layout.add(std::make_unique<juce::AudioParameterFloat>("DUCKING", "Ducking", 0.0f, 100.0f, 0.0f));
@@ -59,17 +94,44 @@ juce::AudioProcessorValueTreeState::ParameterLayout FDNRAudioProcessor::createPa
     layout.add(std::make_unique<juce::AudioParameterFloat>("MS_BALANCE", "M/S Bal", 0.0f, 100.0f, 50.0f));
     layout.add(std::make_unique<juce::AudioParameterBool>("LIMITER", "Limiter", true));
 
+    // Eco: late tail at a reduced internal rate
+    juce::StringArray ecoOptions;
+    ecoOptions.add("Off"); ecoOptions.add("Half"); ecoOptions.add("Quarter"); ecoOptions.add("Auto");
+    layout.add(std::make_unique<juce::AudioParameterChoice>("ECO", "Eco", ecoOptions, 0));
+
+    // Late tail engine, switched under a short fade
+    layout.add(std::make_unique<juce::AudioParameterChoice>("ENGINE", "Tail Engine", juce::StringArray { "Freeverb", "Velvet" }, 0));
+
+    // Delay memory format, in DelayStorage order. Switching it clears the reverb.
+    layout.add(std::make_unique<juce::AudioParameterChoice>("MEMORY", "Delay Memory",
+                                                            juce::StringArray { "32-bit Float", "16-bit Float", "16-bit Dithered" }, 0,
+                                                            juce::AudioParameterChoiceAttributes().withAutomatable(false)));
+
+    // Load shedding. The tier is only ever set by the plugin, to show the host where it is, and
+    // isn't saved with the rest of the state.
+    layout.add(std::make_unique<juce::AudioParameterBool>("ADAPTIVE", "Adaptive Quality", true));
+
+    juce::StringArray tierOptions;
+    for (int tier = 0; tier < QualityController::numTiers; ++tier)
+        tierOptions.add(QualityController::getTierName(tier));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("QUALITY_TIER", "Quality Tier", tierOptions, 0,
+                                                            juce::AudioParameterChoiceAttributes().withAutomatable(false)));
+
+    // Diagnostics, writes the events of each instance to EventLogWriter::getLogFile()
+    layout.add(std::make_unique<juce::AudioParameterBool>("EVENT_LOG", "Event Log", false,
+                                                          juce::AudioParameterBoolAttributes().withAutomatable(false)));
+
+    // Diagnostics, keeps the last seconds of audio and parameters in FlightRecorder::getDefaultFile()
+    layout.add(std::make_unique<juce::AudioParameterBool>("FLIGHT_RECORDER", "Flight Recorder", false,
+                                                          juce::AudioParameterBoolAttributes().withAutomatable(false)));
+
     // A/B Switch
     layout.add(std::make_unique<juce::AudioParameterBool>("AB_SWITCH", "A/B", false));
 
     // Mode
     juce::StringArray modes;
-    modes.add("Twin Star"); modes.add("Sea Serpent"); modes.add("Horse Man"); modes.add("Archer");
-    modes.add("Void Maker"); modes.add("Galaxy Spiral"); modes.add("Harp String"); modes.add("Goat Horn");
-    modes.add("Nebula Cloud"); modes.add("Triangle"); modes.add("Cloud Major"); modes.add("Cloud Minor");
-    modes.add("Queen Chair"); modes.add("Hunter Belt"); modes.add("Water Bearer"); modes.add("Two Fish");
-    modes.add("Scorpion Tail"); modes.add("Balance Scale"); modes.add("Lion Heart"); modes.add("Maiden");
-    modes.add("Seven Sisters");
+    for (int mode = 0; mode < ReverbModes::numModes; ++mode)
+        modes.add(ReverbModes::getName(mode));
 
     layout.add(std::make_unique<juce::AudioParameterChoice>("MODE", "Mode", modes, 0));
 
@@ -144,11 +206,37 @@ void FDNRAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
     spec.maximumBlockSize = samplesPerBlock;
     spec.numChannels = getTotalNumOutputChannels();
 
+    reverbProcessor.setDelayStorage(getDelayStorage());
     reverbProcessor.prepare(spec);
+    setLatencySamples(reverbProcessor.getLatencySamples());
+
+    flightRecorderArmed = isFlightRecorderWanted();
+    if (flightRecorderArmed)
+    {
+        FlightRecorder::deleteOldCaptures();
+        flightRecorder.open(FlightRecorder::getDefaultFile(eventLog.getInstanceId()), spec, getDelayStorage(),
+                            FlightRecorder::defaultSeconds, reverbProcessor.getSubBlockSize());
+    }
+    else
+        flightRecorder.close();
+
+    loadMeasurer.reset(sampleRate, samplesPerBlock);
+    qualityController.reset();
+
+    // Logged again on the next block
+    preparedBlockSize = samplesPerBlock;
+    loggedMode = -1;
+    loggedEngine = -1;
+    ticksPerSample = (double)juce::Time::getHighResolutionTicksPerSecond() / sampleRate;
+
+    eventLog.setEnabled(eventLogParameter->load() > 0.5f);
+    eventLog.push(EventLog::Type::prepare, juce::Time::getHighResolutionTicks(), samplesPerBlock, sampleRate);
+    prepared = true;
 }
 
 void FDNRAudioProcessor::releaseResources()
 {
+    prepared = false;
     reverbProcessor.reset();
 }
 
@@ -176,42 +264,15 @@ bool FDNRAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) con
 void FDNRAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
     juce::ScopedNoDenormals noDenormals;
+    juce::AudioProcessLoadMeasurer::ScopedTimer loadTimer(loadMeasurer, buffer.getNumSamples());
+    const auto blockTicks = juce::Time::getHighResolutionTicks();
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    ReverbParameters params;
-    params.mix = apvts.getRawParameterValue("MIX")->load();
-    params.width = apvts.getRawParameterValue("WIDTH")->load();
-    params.delay = apvts.getRawParameterValue("DELAY")->load();
-    params.warp = apvts.getRawParameterValue("WARP")->load();
-    params.feedback = apvts.getRawParameterValue("FEEDBACK")->load();
-    params.density = apvts.getRawParameterValue("DENSITY")->load();
-    params.modRate = apvts.getRawParameterValue("MODRATE")->load();
-    params.modDepth = apvts.getRawParameterValue("MODDEPTH")->load();
-
-    params.dynFreq = apvts.getRawParameterValue("DYNFREQ")->load();
-    params.dynQ = apvts.getRawParameterValue("DYNQ")->load();
-    params.dynGain = apvts.getRawParameterValue("DYNGAIN")->load();
-    params.dynDepth = apvts.getRawParameterValue("DYNDEPTH")->load();
-    params.dynThresh = apvts.getRawParameterValue("DYNTHRESH")->load();
-
-    params.ducking = apvts.getRawParameterValue("DUCKING")->load();
-    params.preDelaySync = (int)apvts.getRawParameterValue("PREDELAY_SYNC")->load();
-    params.saturation = apvts.getRawParameterValue("SATURATION")->load();
-    params.diffusion = apvts.getRawParameterValue("DIFFUSION")->load();
-    params.gateThresh = apvts.getRawParameterValue("GATE_THRESH")->load();
-
-    params.eq3Low = apvts.getRawParameterValue("EQ3_LOW")->load();
-    params.eq3Mid = apvts.getRawParameterValue("EQ3_MID")->load();
-    params.eq3High = apvts.getRawParameterValue("EQ3_HIGH")->load();
-
-    params.msBalance = apvts.getRawParameterValue("MS_BALANCE")->load();
-    params.limiterOn = (apvts.getRawParameterValue("LIMITER")->load() > 0.5f);
-
-    params.mode = (int)apvts.getRawParameterValue("MODE")->load();
+    auto params = loadReverbParameters();
 
     if (auto* ph = getPlayHead())
     {
@@ -221,16 +282,111 @@ void FDNRAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::M
     }
 
     reverbProcessor.setParameters(params);
+    reverbProcessor.setQuality(isNonRealtime() ? ReverbProcessor::Quality::offline : ReverbProcessor::Quality::realtime);
+
+    eventLog.setEnabled(eventLogParameter->load() > 0.5f);
+    logBlockEvents(params, buffer.getNumSamples(), blockTicks);
+    updateQualityTier(buffer.getNumSamples(), blockTicks);
 
     juce::dsp::AudioBlock<float> block(buffer);
     juce::dsp::ProcessContextReplacing<float> context(block);
 
-    if (clearTriggered.exchange(false))
+    const bool clearing = clearTriggered.exchange(false);
+    if (clearing)
     {
-        reverbProcessor.reset();
+        reverbProcessor.clear();
+        eventLog.push(EventLog::Type::clear, blockTicks);
     }
 
+    // Everything a replay needs to put the processor through the same block
+    flightRecorder.recordInput(block, params, (clearing ? FlightRecorder::clearFlag : 0)
+                                            | (isNonRealtime() ? FlightRecorder::offlineFlag : 0)
+                                            | (qualityTier.load() << FlightRecorder::tierShift));
+
     reverbProcessor.process(context);
+    flightRecorder.recordOutput(block);
+
+    if (eventLog.isEnabled())
+    {
+        const int recoveries = reverbProcessor.getRecoveryCount();
+        if (recoveries != loggedRecoveries)
+            eventLog.push(EventLog::Type::recovery, blockTicks, recoveries);
+        loggedRecoveries = recoveries;
+
+        // Only overruns of this block, the load measurer averages over many
+        const double deadline = buffer.getNumSamples() * ticksPerSample;
+        const double elapsed = (double)(juce::Time::getHighResolutionTicks() - blockTicks);
+        if (! isNonRealtime() && elapsed > deadline)
+            eventLog.push(EventLog::Type::overrun, blockTicks, buffer.getNumSamples(), elapsed / deadline);
+    }
+}
+
+ReverbParameters FDNRAudioProcessor::loadReverbParameters() const
+{
+    size_t index = 0;
+    return ReverbParameters::fromParameterValues([this, &index](juce::StringRef, float) {
+        return reverbParameterValues[index++]->load();
+    });
+}
+
+void FDNRAudioProcessor::logBlockEvents(const ReverbParameters& params, int numSamples, juce::int64 blockTicks)
+{
+    if (! eventLog.isEnabled())
+        return;
+
+    if (numSamples > preparedBlockSize)
+        eventLog.push(EventLog::Type::oversizedBlock, blockTicks, numSamples, preparedBlockSize);
+
+    if (params.mode != loggedMode)
+        eventLog.push(EventLog::Type::modeChange, blockTicks, params.mode);
+
+    if (params.engine != loggedEngine)
+        eventLog.push(EventLog::Type::engineChange, blockTicks, params.engine);
+
+    loggedMode = params.mode;
+    loggedEngine = params.engine;
+}
+
+DelayStorage FDNRAudioProcessor::getDelayStorage() const
+{
+    return (DelayStorage)(int)memoryParameter->load();
+}
+
+bool FDNRAudioProcessor::isFlightRecorderWanted() const
+{
+    return flightRecorderParameter->load() > 0.5f;
+}
+
+void FDNRAudioProcessor::updateQualityTier(int numSamples, juce::int64 blockTicks)
+{
+    // From the load of the blocks before this one. Offline renders have no deadline.
+    if (isNonRealtime() || adaptiveParameter->load() < 0.5f)
+        qualityController.reset();
+    else
+        qualityController.update(loadMeasurer.getLoadAsProportion(), numSamples / getSampleRate());
+
+    const int tier = qualityController.getTier();
+    reverbProcessor.setQualityTier(tier);
+
+    if (tier != qualityTier.exchange(tier))
+        eventLog.push(EventLog::Type::qualityTier, blockTicks, tier);
+}
+
+void FDNRAudioProcessor::timerCallback()
+{
+    // Also puts the tier back after a state or preset has replaced it
+    const int tier = qualityTier.load();
+    if (qualityTierParameter != nullptr && qualityTierParameter->getIndex() != tier)
+        qualityTierParameter->setValueNotifyingHost(qualityTierParameter->convertTo0to1((float)tier));
+
+    if (prepared.load()
+        && (getDelayStorage() != reverbProcessor.getDelayStorage() || isFlightRecorderWanted() != flightRecorderArmed))
+    {
+        // Waits for the current block, and holds the next ones off until the memory is in place
+        suspendProcessing(true);
+        prepareToPlay(getSampleRate(), getBlockSize());
+        suspendProcessing(false);
+    }
 }
 
 //==============================================================================
@@ -247,7 +403,10 @@ juce::AudioProcessorEditor* FDNRAudioProcessor::createEditor()
 //==============================================================================
 void FDNRAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
+    // The load shedding tier is live, a restored one would be stale
     auto state = apvts.copyState();
+    state.removeChild(state.getChildWithProperty("id", "QUALITY_TIER"), nullptr);
+
     std::unique_ptr<juce::XmlElement> xml (state.createXml());
     copyXmlToBinary (*xml, destData);
 }
@@ -258,7 +417,23 @@ void FDNRAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 
     if (xmlState.get() != nullptr)
         if (xmlState->hasTagName (apvts.state.getType()))
-            apvts.replaceState (juce::ValueTree::fromXml (*xmlState));
+            replaceState (juce::ValueTree::fromXml (*xmlState), { "QUALITY_TIER" });
+}
+
+void FDNRAudioProcessor::replaceState(const juce::ValueTree& newState, const juce::StringArray& keptParameterIDs)
+{
+    auto state = newState.createCopy();
+
+    for (const auto& id : keptParameterIDs)
+    {
+        state.removeChild(state.getChildWithProperty("id", id), nullptr);
+
+        const auto current = apvts.state.getChildWithProperty("id", id);
+        if (current.isValid())
+            state.appendChild(current.createCopy(), nullptr);
+    }
+
+    apvts.replaceState(state);
 }
 
 void FDNRAudioProcessor::savePreset(const juce::File& file)
@@ -272,7 +447,8 @@ void FDNRAudioProcessor::savePreset(const juce::File& file)
     {
         if (auto* p = dynamic_cast<juce::AudioProcessorParameterWithID*>(param))
         {
-            paramsObject->setProperty(p->paramID, apvts.getRawParameterValue(p->paramID)->load());
+            if (p->paramID != "QUALITY_TIER")
+                paramsObject->setProperty(p->paramID, apvts.getRawParameterValue(p->paramID)->load());
         }
     }
 
@@ -306,6 +482,10 @@ void FDNRAudioProcessor::loadPreset(const juce::File& file)
                  auto paramID = prop.name.toString();
                  auto value = (float)prop.value;
 
+                 // Set by the plugin alone, older presets saved it
+                 if (paramID == "QUALITY_TIER")
+                     continue;
+
                  // Use getParameterAsValue to ensure the ValueTree is updated, 
                  // which triggers the listeners and updates the UI reliably.
                  auto paramValue = apvts.getParameterAsValue(paramID);
@@ -341,11 +521,17 @@ void FDNRAudioProcessor::resetAllParametersToDefault()
     resetParam("MODRATE", 0.5f);
     resetParam("MODDEPTH", 50.0f);
 
-    resetParam("DYNFREQ", 1000.0f);
-    resetParam("DYNQ", 1.0f);
-    resetParam("DYNGAIN", 0.0f);
-    resetParam("DYNDEPTH", 0.0f);
-    resetParam("DYNTHRESH", -20.0f);
+    const ReverbParameters defaults;
+    for (int b = 0; b < MultiBandDynamicEq::maxBands; ++b)
+    {
+        const auto& band = defaults.dynBands[(size_t)b];
+        resetParam(getDynBandParameterID(b, "FREQ"), band.frequency);
+        resetParam(getDynBandParameterID(b, "Q"), band.resonance);
+        resetParam(getDynBandParameterID(b, "GAIN"), band.gain);
+        resetParam(getDynBandParameterID(b, "DEPTH"), band.depth);
+        resetParam(getDynBandParameterID(b, "THRESH"), band.threshold);
+    }
+    resetParam("DYNBANDS", 0.0f); // 1 band
 
     resetParam("DUCKING", 0.0f);
     resetParam("PREDELAY_SYNC", 0.0f); // Free
@@ -358,6 +544,9 @@ void FDNRAudioProcessor::resetAllParametersToDefault()
     resetParam("EQ3_HIGH", 0.0f);
 
     resetParam("MS_BALANCE", 50.0f);
+    resetParam("ECO", 0.0f); // Off
+    resetParam("ENGINE", 0.0f); // Freeverb
+    resetParam("ADAPTIVE", 1.0f);
 
     if (auto* p = apvts.getParameter("LIMITER")) 
         apvts.getParameterAsValue("LIMITER").setValue(true); // On by default
@@ -371,296 +560,8 @@ void FDNRAudioProcessor::setParametersForMode(int modeIndex)
             param.setValue(val);
     };
 
-    // Helper to reset common modifiers to a "clean" state before applying specific character
-    auto resetModifiers = [&]() {
-        setParam("WARP", 0.0f);
-        setParam("SATURATION", 0.0f);
-        setParam("DUCKING", 0.0f);
-        setParam("GATE_THRESH", -100.0f);
-        setParam("DYNFREQ", 1000.0f);
-        setParam("DYNGAIN", 0.0f);
-    };
-
-    resetModifiers();
-
-    switch (modeIndex)
-    {
-        case TwinStar: // Gemini - Balanced, dual nature, standard hall
-            setParam("MIX", 40.0f);
-            setParam("DELAY", 350.0f);
-            setParam("FEEDBACK", 55.0f);
-            setParam("WIDTH", 100.0f);
-            setParam("DENSITY", 60.0f);
-            setParam("DIFFUSION", 80.0f);
-            setParam("MODRATE", 0.6f);
-            setParam("MODDEPTH", 25.0f);
-            setParam("EQ3_LOW", 0.0f);
-            setParam("EQ3_MID", 0.0f);
-            setParam("EQ3_HIGH", 0.0f);
-            break;
-
-        case SeaSerpent: // Hydra - Deep, submerged, modulated tail
-            setParam("MIX", 55.0f);
-            setParam("DELAY", 850.0f);
-            setParam("FEEDBACK", 88.0f);
-            setParam("WIDTH", 90.0f);
-            setParam("DENSITY", 85.0f);
-            setParam("DIFFUSION", 50.0f);
-            setParam("MODRATE", 0.25f);
-            setParam("MODDEPTH", 75.0f);
-            setParam("EQ3_LOW", 4.0f);
-            setParam("EQ3_HIGH", -6.0f);
-            setParam("WARP", 20.0f);
-            break;
-
-        case HorseMan: // Centaurus - Strong, stable, room-like, woody
-            setParam("MIX", 35.0f);
-            setParam("DELAY", 180.0f);
-            setParam("FEEDBACK", 40.0f);
-            setParam("WIDTH", 75.0f);
-            setParam("DENSITY", 95.0f);
-            setParam("DIFFUSION", 100.0f);
-            setParam("MODRATE", 1.2f);
-            setParam("MODDEPTH", 10.0f);
-            setParam("EQ3_LOW", -1.0f);
-            setParam("EQ3_MID", 2.0f);
-            setParam("EQ3_HIGH", -2.0f);
-            break;
-
-        case Archer: // Sagittarius - Sharp, distant, bright attacks
-            setParam("MIX", 45.0f);
-            setParam("DELAY", 550.0f);
-            setParam("FEEDBACK", 65.0f);
-            setParam("WIDTH", 100.0f);
-            setParam("DENSITY", 30.0f); // Lower density for distinct reflections
-            setParam("DIFFUSION", 40.0f);
-            setParam("MODRATE", 0.8f);
-            setParam("MODDEPTH", 35.0f);
-            setParam("EQ3_HIGH", 4.0f);
-            setParam("SATURATION", 10.0f);
-            break;
-
-        case VoidMaker: // Great Annihilator - Massive, infinite, dark drone
-            setParam("MIX", 100.0f); // Drone territory
-            setParam("DELAY", 1000.0f);
-            setParam("FEEDBACK", 98.0f); // Near freeze
-            setParam("WIDTH", 100.0f);
-            setParam("DENSITY", 100.0f);
-            setParam("DIFFUSION", 100.0f);
-            setParam("MODRATE", 0.15f);
-            setParam("MODDEPTH", 60.0f);
-            setParam("EQ3_LOW", 8.0f);
-            setParam("EQ3_HIGH", -12.0f);
-            setParam("SATURATION", 45.0f);
-            break;
-
-        case GalaxySpiral: // Andromeda - Swirling, vast, spacey
-            setParam("MIX", 50.0f);
-            setParam("DELAY", 600.0f);
-            setParam("FEEDBACK", 80.0f);
-            setParam("WIDTH", 100.0f);
-            setParam("DENSITY", 50.0f);
-            setParam("DIFFUSION", 70.0f);
-            setParam("MODRATE", 2.8f); // Fast swirl
-            setParam("MODDEPTH", 65.0f);
-            setParam("WARP", 30.0f);
-            break;
-
-        case HarpString: // Lyra - Resonant, metallic, comb-filtery
-            setParam("MIX", 40.0f);
-            setParam("DELAY", 60.0f); // Very short for resonance
-            setParam("FEEDBACK", 90.0f);
-            setParam("WIDTH", 60.0f);
-            setParam("DENSITY", 0.0f); // No smoothing
-            setParam("DIFFUSION", 0.0f); // Pure delays
-            setParam("MODRATE", 0.4f);
-            setParam("MODDEPTH", 15.0f);
-            setParam("EQ3_HIGH", 6.0f);
-            break;
-
-        case GoatHorn: // Capricorn - Earthy, dry, distorted plate
-            setParam("MIX", 30.0f);
-            setParam("DELAY", 220.0f);
-            setParam("FEEDBACK", 45.0f);
-            setParam("WIDTH", 80.0f);
-            setParam("DENSITY", 80.0f);
-            setParam("DIFFUSION", 90.0f);
-            setParam("MODRATE", 0.9f);
-            setParam("MODDEPTH", 20.0f);
-            setParam("SATURATION", 35.0f);
-            setParam("EQ3_LOW", 2.0f);
-            setParam("EQ3_MID", 3.0f);
-            setParam("EQ3_HIGH", -4.0f);
-            break;
-
-        case NebulaCloud: // Large Magellanic Cloud - Diffuse, soft, ambient
-            setParam("MIX", 65.0f);
-            setParam("DELAY", 900.0f);
-            setParam("FEEDBACK", 82.0f);
-            setParam("WIDTH", 100.0f);
-            setParam("DENSITY", 100.0f);
-            setParam("DIFFUSION", 100.0f); // Max diffusion
-            setParam("MODRATE", 0.3f);
-            setParam("MODDEPTH", 40.0f);
-            setParam("EQ3_HIGH", -3.0f);
-            break;
-
-        case Triangle: // Triangulum - Simple, geometric, sparse echoes
-            setParam("MIX", 40.0f);
-            setParam("DELAY", 450.0f);
-            setParam("FEEDBACK", 50.0f);
-            setParam("WIDTH", 100.0f);
-            setParam("DENSITY", 10.0f);
-            setParam("DIFFUSION", 20.0f);
-            setParam("MODRATE", 0.0f);
-            setParam("MODDEPTH", 0.0f);
-            break;
-
-        case CloudMajor: // Cirrus Major - Bright, airy, uplifting
-            setParam("MIX", 50.0f);
-            setParam("DELAY", 700.0f);
-            setParam("FEEDBACK", 75.0f);
-            setParam("WIDTH", 100.0f);
-            setParam("DENSITY", 90.0f);
-            setParam("DIFFUSION", 95.0f);
-            setParam("MODRATE", 0.7f);
-            setParam("MODDEPTH", 30.0f);
-            setParam("EQ3_LOW", -5.0f);
-            setParam("EQ3_HIGH", 6.0f);
-            break;
-
-        case CloudMinor: // Cirrus Minor - Dark, moody, mysterious
-            setParam("MIX", 55.0f);
-            setParam("DELAY", 750.0f);
-            setParam("FEEDBACK", 78.0f);
-            setParam("WIDTH", 90.0f);
-            setParam("DENSITY", 90.0f);
-            setParam("DIFFUSION", 95.0f);
-            setParam("MODRATE", 0.5f);
-            setParam("MODDEPTH", 45.0f);
-            setParam("EQ3_LOW", 3.0f);
-            setParam("EQ3_HIGH", -8.0f);
-            break;
-
-        case QueenChair: // Cassiopeia - Regal, wide, rich, complex
-            setParam("MIX", 60.0f);
-            setParam("DELAY", 650.0f);
-            setParam("FEEDBACK", 72.0f);
-            setParam("WIDTH", 100.0f);
-            setParam("DENSITY", 85.0f);
-            setParam("DIFFUSION", 85.0f);
-            setParam("MODRATE", 1.5f);
-            setParam("MODDEPTH", 55.0f); // Rich chorus
-            setParam("EQ3_MID", 2.0f);
-            break;
-
-        case HunterBelt: // Orion - Focused, punchy, tight
-            setParam("MIX", 35.0f);
-            setParam("DELAY", 150.0f);
-            setParam("FEEDBACK", 25.0f);
-            setParam("WIDTH", 60.0f);
-            setParam("DENSITY", 100.0f);
-            setParam("DIFFUSION", 100.0f);
-            setParam("MODRATE", 0.0f);
-            setParam("MODDEPTH", 0.0f);
-            setParam("GATE_THRESH", -30.0f); // Gated effect
-            break;
-
-        case WaterBearer: // Aquarius - Liquid, fluid, flowing
-            setParam("MIX", 70.0f);
-            setParam("DELAY", 500.0f);
-            setParam("FEEDBACK", 65.0f);
-            setParam("WIDTH", 100.0f);
-            setParam("DENSITY", 70.0f);
-            setParam("DIFFUSION", 60.0f);
-            setParam("MODRATE", 3.0f); // Fast liquid modulation
-            setParam("MODDEPTH", 85.0f);
-            setParam("WARP", 15.0f);
-            break;
-
-        case TwoFish: // Pisces - Deep, dual delay lines feel
-            setParam("MIX", 50.0f);
-            setParam("DELAY", 600.0f);
-            setParam("FEEDBACK", 60.0f);
-            setParam("WIDTH", 100.0f);
-            setParam("DENSITY", 40.0f);
-            setParam("DIFFUSION", 50.0f);
-            setParam("MODRATE", 0.4f);
-            setParam("MODDEPTH", 60.0f);
-            setParam("EQ3_LOW", 5.0f);
-            setParam("EQ3_HIGH", -10.0f); // Underwater
-            break;
-
-        case ScorpionTail: // Scorpio - Aggressive, stinging, intense
-            setParam("MIX", 45.0f);
-            setParam("DELAY", 300.0f);
-            setParam("FEEDBACK", 55.0f);
-            setParam("WIDTH", 80.0f);
-            setParam("DENSITY", 80.0f);
-            setParam("DIFFUSION", 80.0f);
-            setParam("MODRATE", 4.0f); // Intense flutter
-            setParam("MODDEPTH", 30.0f);
-            setParam("SATURATION", 80.0f); // Heavy saturation
-            setParam("EQ3_HIGH", 5.0f);
-            break;
-
-        case BalanceScale: // Libra - Perfectly neutral, reference room
-            setParam("MIX", 50.0f);
-            setParam("DELAY", 400.0f);
-            setParam("FEEDBACK", 50.0f);
-            setParam("WIDTH", 100.0f);
-            setParam("DENSITY", 50.0f);
-            setParam("DIFFUSION", 50.0f);
-            setParam("MODRATE", 0.5f);
-            setParam("MODDEPTH", 20.0f);
-            setParam("EQ3_LOW", 0.0f);
-            setParam("EQ3_MID", 0.0f);
-            setParam("EQ3_HIGH", 0.0f);
-            break;
-
-        case LionHeart: // Leo - Warm, bold, mid-forward
-            setParam("MIX", 55.0f);
-            setParam("DELAY", 500.0f);
-            setParam("FEEDBACK", 65.0f);
-            setParam("WIDTH", 90.0f);
-            setParam("DENSITY", 75.0f);
-            setParam("DIFFUSION", 85.0f);
-            setParam("MODRATE", 0.8f);
-            setParam("MODDEPTH", 25.0f);
-            setParam("SATURATION", 25.0f);
-            setParam("EQ3_MID", 4.0f); // Mid boost
-            setParam("EQ3_HIGH", -2.0f);
-            break;
-
-        case Maiden: // Virgo - Clean, pure, pristine
-            setParam("MIX", 40.0f);
-            setParam("DELAY", 350.0f);
-            setParam("FEEDBACK", 45.0f);
-            setParam("WIDTH", 100.0f);
-            setParam("DENSITY", 80.0f);
-            setParam("DIFFUSION", 90.0f);
-            setParam("MODRATE", 0.3f);
-            setParam("MODDEPTH", 10.0f); // Very subtle
-            setParam("SATURATION", 0.0f); // No saturation
-            setParam("EQ3_LOW", -2.0f); // Clean up mud
-            break;
-
-        case SevenSisters: // Pleiades - Shimmering, multi-tap texture
-            setParam("MIX", 60.0f);
-            setParam("DELAY", 777.0f);
-            setParam("FEEDBACK", 77.0f);
-            setParam("WIDTH", 100.0f);
-            setParam("DENSITY", 30.0f); // Grainy
-            setParam("DIFFUSION", 60.0f);
-            setParam("MODRATE", 2.0f);
-            setParam("MODDEPTH", 50.0f);
-            setParam("EQ3_HIGH", 8.0f); // Shimmer brightness
-            break;
-
-        default:
-            setParam("MIX", 50.0f);
-            break;
-    }
+    for (const auto& setting : ReverbModes::getSettings(modeIndex))
+        setParam(setting.parameterID, setting.value);
 }
 
 void FDNRAudioProcessor::toggleAB()
@@ -668,13 +569,13 @@ void FDNRAudioProcessor::toggleAB()
     if (isStateA)
     {
         stateA = apvts.copyState();
-        apvts.replaceState(stateB);
+        replaceState(stateB, settingParameterIDs);
         isStateA = false;
     }
     else
     {
         stateB = apvts.copyState();
-        apvts.replaceState(stateA);
+        replaceState(stateA, settingParameterIDs);
         isStateA = true;
     }
 }
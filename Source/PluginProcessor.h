@@ -3,8 +3,12 @@
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_dsp/juce_dsp.h>
 #include "ReverbProcessor.h"
+#include "EventLog.h"
+#include "EventLogWriter.h"
+#include "FlightRecorder.h"
 
-class FDNRAudioProcessor  : public juce::AudioProcessor
+class FDNRAudioProcessor  : public juce::AudioProcessor,
+                            private juce::Timer
 {
 public:
     //==============================================================================
@@ -47,6 +51,15 @@ public:
     //==============================================================================
     juce::AudioProcessorValueTreeState& getAPVTS() { return apvts; }
 
+    // ID of a dynamic EQ band setting, e.g. "DYNFREQ" for the first band, "DYN2FREQ" for the second
+    static juce::String getDynBandParameterID(int band, const juce::String& setting)
+    {
+        return ReverbParameters::getDynBandParameterID(band, setting);
+    }
+
+    // Current load shedding tier, a QualityController::Tier
+    int getQualityTier() const { return qualityTier.load(); }
+
     // Preset Management
     void savePreset(const juce::File& file);
     void loadPreset(const juce::File& file);
@@ -57,6 +70,52 @@ private:
 
     ReverbProcessor reverbProcessor;
 
+    // Resolved once, so processBlock() only loads atomics. The values ReverbParameters::
+    // fromParameterValues() reads, in the order it reads them, then the plugin's own settings.
+    std::vector<std::atomic<float>*> reverbParameterValues;
+    std::atomic<float>* eventLogParameter = nullptr;
+    std::atomic<float>* adaptiveParameter = nullptr;
+    std::atomic<float>* memoryParameter = nullptr;
+    std::atomic<float>* flightRecorderParameter = nullptr;
+    ReverbParameters loadReverbParameters() const;
+
+    // Load shedding, see QualityController
+    juce::AudioProcessLoadMeasurer loadMeasurer;
+    QualityController qualityController;
+    std::atomic<int> qualityTier { QualityController::full };
+    juce::AudioParameterChoice* qualityTierParameter = nullptr;
+    void updateQualityTier(int numSamples, juce::int64 blockTicks);
+
+    // Replaces the parameter state, the parameters in keptParameterIDs keep their values
+    void replaceState(const juce::ValueTree& newState, const juce::StringArray& keptParameterIDs);
+
+    // The non-automatable settings, which belong to the instance rather than an A/B slot
+    juce::StringArray settingParameterIDs;
+
+    // Diagnostics, see EventLog. The last values logged, so only changes are.
+    EventLog eventLog;
+    juce::SharedResourcePointer<EventLogWriter> eventLogWriter;
+    int preparedBlockSize = 0, loggedMode = -1, loggedEngine = -1, loggedRecoveries = 0;
+    double ticksPerSample = 0.0;
+    void logBlockEvents(const ReverbParameters& params, int numSamples, juce::int64 blockTicks);
+
+    // Opened by prepareToPlay() when wanted, so a capture starts from a cleared reverb
+    FlightRecorder flightRecorder;
+    bool flightRecorderArmed = false;
+    bool isFlightRecorderWanted() const;
+
+    DelayStorage getDelayStorage() const;
+
+    // Between prepareToPlay() and releaseResources(). The sample rate outlives a release, so
+    // it can't tell whether the host still wants the processor prepared.
+    std::atomic<bool> prepared { false };
+
+    // On the message thread, so the host and the parameter listeners are never called from
+    // the audio thread. Shows the tier the audio thread picked through QUALITY_TIER. A new
+    // delay memory format needs new memory, and the flight recorder a new file, so the
+    // processor is prepared again from here when either setting changes.
+    void timerCallback() override;
+
 public:
     // Trigger Clear
     std::atomic<bool> clearTriggered { false };
@@ -72,32 +131,6 @@ private:
     juce::ValueTree stateA;
     juce::ValueTree stateB;
 
-    // Mode Enum
-    enum Mode
-    {
-        TwinStar = 0,        // Gemini
-        SeaSerpent,          // Hydra
-        HorseMan,            // Centaurus
-        Archer,              // Sagittarius
-        VoidMaker,           // Great Annihilator
-        GalaxySpiral,        // Andromeda
-        HarpString,          // Lyra
-        GoatHorn,            // Capricorn
-        NebulaCloud,         // Large Magellanic Cloud
-        Triangle,            // Triangulum
-        CloudMajor,          // Cirrus Major
-        CloudMinor,          // Cirrus Minor
-        QueenChair,          // Cassiopeia
-        HunterBelt,          // Orion
-        WaterBearer,         // Aquarius
-        TwoFish,             // Pisces
-        ScorpionTail,        // Scorpio
-        BalanceScale,        // Libra
-        LionHeart,           // Leo
-        Maiden,              // Virgo
-        SevenSisters         // Pleiades
-    };
-
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FDNRAudioProcessor)
 };
@@ -0,0 +1,148 @@
+#include "PreDelay.h"
+
+void PreDelay::setKernels(const DSPKernels& newKernels)
+{
+    kernels = &newKernels;
+    for (auto& ring : rings)
+        ring.setKernels(newKernels);
+}
+
+void PreDelay::prepare(const juce::dsp::ProcessSpec& spec, int maxDelaySamples, DelayArena& arena)
+{
+    maxDelay = juce::jmax(0, maxDelaySamples);
+    const auto maxBlockSize = juce::jmax(1, (int)spec.maximumBlockSize);
+
+    // A block is written before it is read, and the oldest sample the interpolation then
+    // needs is maxDelay + 1 behind its first one. A power of two so the heads wrap by mask.
+    ringSize = juce::nextPowerOfTwo(maxDelay + 1 + maxBlockSize);
+    ringMask = ringSize - 1;
+    rings.resize(spec.numChannels);
+
+    for (size_t ch = 0; ch < rings.size(); ++ch)
+    {
+        rings[ch].setKernels(*kernels);
+        rings[ch].reserve(arena, storage, ringSize, (uint32_t)ch);
+    }
+
+    // The fastest ramp crosses the whole range, the span a block reads grows by its step
+    // for every sample
+    rampLength = juce::jmax(1, (int)(rampSeconds * spec.sampleRate));
+    const auto maxStep = (int)std::ceil((double)maxDelay / rampLength);
+    delays.assign((size_t)maxBlockSize, 0.0f);
+    history.assign((size_t)(maxBlockSize * (1 + maxStep) + 2), 0.0f);
+
+    targetDelay = juce::jmin(targetDelay, (float)maxDelay);
+    reset();
+}
+
+void PreDelay::reset()
+{
+    writePos = 0;
+    numValid = 0;
+
+    delay = targetDelay;
+    rampRemaining = 0;
+}
+
+void PreDelay::setDelay(float delayInSamples)
+{
+    const auto newTarget = (float)juce::roundToInt(juce::jlimit(0.0f, (float)maxDelay, delayInSamples));
+
+    if (newTarget == targetDelay)
+        return;
+
+    targetDelay = newTarget;
+
+    // Nothing written yet, nothing to glide over
+    if (numValid == 0)
+    {
+        delay = targetDelay;
+        rampRemaining = 0;
+        return;
+    }
+
+    rampStart = delay;
+    rampRemaining = rampLength;
+    rampStep = (targetDelay - delay) / (float)rampLength;
+}
+
+void PreDelay::process(const juce::dsp::AudioBlock<float>& block)
+{
+    const auto numSamples = (int)block.getNumSamples();
+    const auto numChannels = (int)juce::jmin(block.getNumChannels(), rings.size());
+    jassert(numSamples <= (int)delays.size());
+
+    for (int ch = 0; ch < numChannels; ++ch)
+        rings[(size_t)ch].write(block.getChannelPointer((size_t)ch), writePos, numSamples);
+
+    if (rampRemaining > 0)
+    {
+        processRamp(block, numChannels, numSamples);
+    }
+    else
+    {
+        // Whole samples: the block is a span of the ring, the part from before the last
+        // reset() silence
+        const auto delayInt = (int)delay;
+        const auto numSilent = juce::jlimit(0, numSamples, delayInt - numValid);
+        const auto readPos = (writePos + numSilent - delayInt) & ringMask;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto* samples = block.getChannelPointer((size_t)ch);
+            std::fill_n(samples, numSilent, 0.0f);
+            rings[(size_t)ch].read(samples + numSilent, readPos, numSamples - numSilent);
+        }
+    }
+
+    writePos = (writePos + numSamples) & ringMask;
+    numValid = juce::jmin(numValid + numSamples, ringSize);
+}
+
+void PreDelay::processRamp(const juce::dsp::AudioBlock<float>& block, int numChannels, int numSamples)
+{
+    // 1. The delay of each sample, from its place in the ramp so it doesn't depend on how
+    // the input is split into blocks, and exactly the target at the end
+    float oldest = 0.0f, newest = (float)maxDelay;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        if (rampRemaining > 0)
+        {
+            --rampRemaining;
+            delay = rampRemaining > 0 ? rampStart + rampStep * (float)(rampLength - rampRemaining) : targetDelay;
+        }
+
+        const auto d = juce::jlimit(0.0f, (float)maxDelay, delay);
+        delays[(size_t)i] = d;
+        oldest = juce::jmax(oldest, d);
+        newest = juce::jmin(newest, d);
+    }
+
+    // 2. The span those delays interpolate between. history[j] is the sample at
+    // writePos - first + j, samples from before the last reset() read as silence.
+    const auto first = (int)std::floor(oldest) + 1;
+    const auto count = numSamples + first - (int)std::floor(newest);
+    jassert(count <= (int)history.size());
+
+    const auto readPos = (writePos - first) & ringMask;
+    const auto numSilent = juce::jlimit(0, count, first - numValid);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto* samples = block.getChannelPointer((size_t)ch);
+        auto* h = history.data();
+
+        rings[(size_t)ch].read(h, readPos, count);
+        std::fill_n(h, numSilent, 0.0f);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto d = delays[(size_t)i];
+            const auto delayInt = (int)d;
+            const auto frac = d - (float)delayInt;
+            const auto newer = first + i - delayInt;
+            samples[i] = h[newer] + frac * (h[newer - 1] - h[newer]);
+        }
+    }
+}
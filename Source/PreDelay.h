@@ -0,0 +1,52 @@
+#pragma once
+#include <juce_dsp/juce_dsp.h>
+#include "DelayMemory.h"
+
+// Pre-delay, one ring per channel. Settled on a delay it is a whole number of samples, and a
+// block is read straight out of the ring in at most two spans. Changes ramp over 50 ms with
+// linear interpolation. Only samples written since the last reset() are ever read, anything
+// older reads as silence, so clearing it is O(1) however long the maximum delay is.
+class PreDelay
+{
+public:
+    static constexpr double rampSeconds = 0.05;
+
+    void setKernels(const DSPKernels& newKernels);
+
+    // Sample format of the rings, takes effect on the next prepare()
+    void setStorage(DelayStorage newStorage) { storage = newStorage; }
+
+    // The rings are reserved in the arena, and usable once it is allocated
+    void prepare(const juce::dsp::ProcessSpec& spec, int maxDelaySamples, DelayArena& arena);
+    void reset();
+
+    // In samples, rounded to a whole one and clamped to the prepared maximum. Jumps straight
+    // there after a reset, ramps otherwise.
+    void setDelay(float delayInSamples);
+
+    bool isRamping() const { return rampRemaining > 0; }
+
+    // The longer of the delay now and the one it is ramping to, in samples
+    float getLongestDelay() const { return juce::jmax(delay, targetDelay); }
+
+    void process(const juce::dsp::AudioBlock<float>& block);
+
+private:
+    void processRamp(const juce::dsp::AudioBlock<float>& block, int numChannels, int numSamples);
+
+    const DSPKernels* kernels = &DSPKernels::get();
+    DelayStorage storage = DelayStorage::float32;
+
+    std::vector<DelayMemory> rings;
+    int ringSize = 2, ringMask = 1;
+    int writePos = 0;
+    int numValid = 0;
+
+    // While ramping: the delay of each sample of the block, and the span of the ring they
+    // interpolate between, oldest first
+    std::vector<float> delays, history;
+
+    float delay = 0.0f, targetDelay = 0.0f, rampStart = 0.0f, rampStep = 0.0f;
+    int rampLength = 0, rampRemaining = 0;
+    int maxDelay = 0;
+};
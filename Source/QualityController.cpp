@@ -0,0 +1,39 @@
+#include "QualityController.h"
+
+void QualityController::reset()
+{
+    tier = full;
+    highSeconds = 0.0;
+    lowSeconds = 0.0;
+}
+
+int QualityController::update(double load, double blockSeconds)
+{
+    // Time spent continuously above or below the thresholds, in between counts as neither
+    highSeconds = load > stepDownLoad ? highSeconds + blockSeconds : 0.0;
+    lowSeconds = load < stepUpLoad ? lowSeconds + blockSeconds : 0.0;
+
+    if (highSeconds >= stepDownSeconds && tier < numTiers - 1)
+    {
+        ++tier;
+        highSeconds = 0.0;
+    }
+    else if (lowSeconds >= stepUpSeconds && tier > full)
+    {
+        --tier;
+        lowSeconds = 0.0;
+    }
+
+    return tier;
+}
+
+const char* QualityController::getTierName(int tier)
+{
+    switch (tier)
+    {
+        case full: return "Full";
+        case reduced: return "Reduced";
+        case low: return "Low";
+        default: return "";
+    }
+}
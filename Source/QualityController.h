@@ -0,0 +1,35 @@
+#pragma once
+
+// Load shedding for realtime playback. Fed the share of each block's deadline that went into
+// processing it, it picks a quality tier: one step down once the load has stayed high for a
+// moment, one step back up once it has stayed low for a good while. The gap between the two
+// thresholds, and restarting the count after every step, keep it from hunting.
+class QualityController
+{
+public:
+    enum Tier
+    {
+        full = 0,   // everything as set
+        reduced,    // half the tail's comb lines
+        low,        // and the tail at half rate
+        numTiers
+    };
+
+    // Load is processing time over block duration, 1 being the deadline
+    static constexpr double stepDownLoad = 0.6;
+    static constexpr double stepUpLoad = 0.3;
+    static constexpr double stepDownSeconds = 0.25;
+    static constexpr double stepUpSeconds = 3.0;
+
+    void reset();
+
+    // Returns the tier for the next block
+    int update(double load, double blockSeconds);
+    int getTier() const { return tier; }
+
+    static const char* getTierName(int tier);
+
+private:
+    int tier = full;
+    double highSeconds = 0.0, lowSeconds = 0.0;
+};
@@ -0,0 +1,338 @@
+#include "ReverbModes.h"
+
+namespace
+{
+    using Setting = ReverbModes::Setting;
+
+    // Modifiers every mode starts clean from, before its own character
+    const std::vector<Setting> resetSettings {
+        { "WARP", 0.0f },
+        { "SATURATION", 0.0f },
+        { "DUCKING", 0.0f },
+        { "GATE_THRESH", -100.0f },
+        { "DYNFREQ", 1000.0f },
+        { "DYNGAIN", 0.0f }
+    };
+
+    struct Mode
+    {
+        const char* name;
+        std::vector<Setting> settings;
+    };
+
+    // In MODE order, each named after its constellation
+    const Mode modes[ReverbModes::numModes] {
+        // Gemini - Balanced, dual nature, standard hall
+        { "Twin Star", {
+            { "MIX", 40.0f },
+            { "DELAY", 350.0f },
+            { "FEEDBACK", 55.0f },
+            { "WIDTH", 100.0f },
+            { "DENSITY", 60.0f },
+            { "DIFFUSION", 80.0f },
+            { "MODRATE", 0.6f },
+            { "MODDEPTH", 25.0f },
+            { "EQ3_LOW", 0.0f },
+            { "EQ3_MID", 0.0f },
+            { "EQ3_HIGH", 0.0f }
+        } },
+
+        // Hydra - Deep, submerged, modulated tail
+        { "Sea Serpent", {
+            { "MIX", 55.0f },
+            { "DELAY", 850.0f },
+            { "FEEDBACK", 88.0f },
+            { "WIDTH", 90.0f },
+            { "DENSITY", 85.0f },
+            { "DIFFUSION", 50.0f },
+            { "MODRATE", 0.25f },
+            { "MODDEPTH", 75.0f },
+            { "EQ3_LOW", 4.0f },
+            { "EQ3_HIGH", -6.0f },
+            { "WARP", 20.0f }
+        } },
+
+        // Centaurus - Strong, stable, room-like, woody
+        { "Horse Man", {
+            { "MIX", 35.0f },
+            { "DELAY", 180.0f },
+            { "FEEDBACK", 40.0f },
+            { "WIDTH", 75.0f },
+            { "DENSITY", 95.0f },
+            { "DIFFUSION", 100.0f },
+            { "MODRATE", 1.2f },
+            { "MODDEPTH", 10.0f },
+            { "EQ3_LOW", -1.0f },
+            { "EQ3_MID", 2.0f },
+            { "EQ3_HIGH", -2.0f }
+        } },
+
+        // Sagittarius - Sharp, distant, bright attacks
+        { "Archer", {
+            { "MIX", 45.0f },
+            { "DELAY", 550.0f },
+            { "FEEDBACK", 65.0f },
+            { "WIDTH", 100.0f },
+            { "DENSITY", 30.0f }, // Lower density for distinct reflections
+            { "DIFFUSION", 40.0f },
+            { "MODRATE", 0.8f },
+            { "MODDEPTH", 35.0f },
+            { "EQ3_HIGH", 4.0f },
+            { "SATURATION", 10.0f }
+        } },
+
+        // Great Annihilator - Massive, infinite, dark drone
+        { "Void Maker", {
+            { "MIX", 100.0f }, // Drone territory
+            { "DELAY", 1000.0f },
+            { "FEEDBACK", 98.0f }, // Near freeze
+            { "WIDTH", 100.0f },
+            { "DENSITY", 100.0f },
+            { "DIFFUSION", 100.0f },
+            { "MODRATE", 0.15f },
+            { "MODDEPTH", 60.0f },
+            { "EQ3_LOW", 8.0f },
+            { "EQ3_HIGH", -12.0f },
+            { "SATURATION", 45.0f }
+        } },
+
+        // Andromeda - Swirling, vast, spacey
+        { "Galaxy Spiral", {
+            { "MIX", 50.0f },
+            { "DELAY", 600.0f },
+            { "FEEDBACK", 80.0f },
+            { "WIDTH", 100.0f },
+            { "DENSITY", 50.0f },
+            { "DIFFUSION", 70.0f },
+            { "MODRATE", 2.8f }, // Fast swirl
+            { "MODDEPTH", 65.0f },
+            { "WARP", 30.0f }
+        } },
+
+        // Lyra - Resonant, metallic, comb-filtery
+        { "Harp String", {
+            { "MIX", 40.0f },
+            { "DELAY", 60.0f }, // Very short for resonance
+            { "FEEDBACK", 90.0f },
+            { "WIDTH", 60.0f },
+            { "DENSITY", 0.0f }, // No smoothing
+            { "DIFFUSION", 0.0f }, // Pure delays
+            { "MODRATE", 0.4f },
+            { "MODDEPTH", 15.0f },
+            { "EQ3_HIGH", 6.0f }
+        } },
+
+        // Capricorn - Earthy, dry, distorted plate
+        { "Goat Horn", {
+            { "MIX", 30.0f },
+            { "DELAY", 220.0f },
+            { "FEEDBACK", 45.0f },
+            { "WIDTH", 80.0f },
+            { "DENSITY", 80.0f },
+            { "DIFFUSION", 90.0f },
+            { "MODRATE", 0.9f },
+            { "MODDEPTH", 20.0f },
+            { "SATURATION", 35.0f },
+            { "EQ3_LOW", 2.0f },
+            { "EQ3_MID", 3.0f },
+            { "EQ3_HIGH", -4.0f }
+        } },
+
+        // Large Magellanic Cloud - Diffuse, soft, ambient
+        { "Nebula Cloud", {
+            { "MIX", 65.0f },
+            { "DELAY", 900.0f },
+            { "FEEDBACK", 82.0f },
+            { "WIDTH", 100.0f },
+            { "DENSITY", 100.0f },
+            { "DIFFUSION", 100.0f }, // Max diffusion
+            { "MODRATE", 0.3f },
+            { "MODDEPTH", 40.0f },
+            { "EQ3_HIGH", -3.0f }
+        } },
+
+        // Triangulum - Simple, geometric, sparse echoes
+        { "Triangle", {
+            { "MIX", 40.0f },
+            { "DELAY", 450.0f },
+            { "FEEDBACK", 50.0f },
+            { "WIDTH", 100.0f },
+            { "DENSITY", 10.0f },
+            { "DIFFUSION", 20.0f },
+            { "MODRATE", 0.0f },
+            { "MODDEPTH", 0.0f }
+        } },
+
+        // Cirrus Major - Bright, airy, uplifting
+        { "Cloud Major", {
+            { "MIX", 50.0f },
+            { "DELAY", 700.0f },
+            { "FEEDBACK", 75.0f },
+            { "WIDTH", 100.0f },
+            { "DENSITY", 90.0f },
+            { "DIFFUSION", 95.0f },
+            { "MODRATE", 0.7f },
+            { "MODDEPTH", 30.0f },
+            { "EQ3_LOW", -5.0f },
+            { "EQ3_HIGH", 6.0f }
+        } },
+
+        // Cirrus Minor - Dark, moody, mysterious
+        { "Cloud Minor", {
+            { "MIX", 55.0f },
+            { "DELAY", 750.0f },
+            { "FEEDBACK", 78.0f },
+            { "WIDTH", 90.0f },
+            { "DENSITY", 90.0f },
+            { "DIFFUSION", 95.0f },
+            { "MODRATE", 0.5f },
+            { "MODDEPTH", 45.0f },
+            { "EQ3_LOW", 3.0f },
+            { "EQ3_HIGH", -8.0f }
+        } },
+
+        // Cassiopeia - Regal, wide, rich, complex
+        { "Queen Chair", {
+            { "MIX", 60.0f },
+            { "DELAY", 650.0f },
+            { "FEEDBACK", 72.0f },
+            { "WIDTH", 100.0f },
+            { "DENSITY", 85.0f },
+            { "DIFFUSION", 85.0f },
+            { "MODRATE", 1.5f },
+            { "MODDEPTH", 55.0f }, // Rich chorus
+            { "EQ3_MID", 2.0f }
+        } },
+
+        // Orion - Focused, punchy, tight
+        { "Hunter Belt", {
+            { "MIX", 35.0f },
+            { "DELAY", 150.0f },
+            { "FEEDBACK", 25.0f },
+            { "WIDTH", 60.0f },
+            { "DENSITY", 100.0f },
+            { "DIFFUSION", 100.0f },
+            { "MODRATE", 0.0f },
+            { "MODDEPTH", 0.0f },
+            { "GATE_THRESH", -30.0f } // Gated effect
+        } },
+
+        // Aquarius - Liquid, fluid, flowing
+        { "Water Bearer", {
+            { "MIX", 70.0f },
+            { "DELAY", 500.0f },
+            { "FEEDBACK", 65.0f },
+            { "WIDTH", 100.0f },
+            { "DENSITY", 70.0f },
+            { "DIFFUSION", 60.0f },
+            { "MODRATE", 3.0f }, // Fast liquid modulation
+            { "MODDEPTH", 85.0f },
+            { "WARP", 15.0f }
+        } },
+
+        // Pisces - Deep, dual delay lines feel
+        { "Two Fish", {
+            { "MIX", 50.0f },
+            { "DELAY", 600.0f },
+            { "FEEDBACK", 60.0f },
+            { "WIDTH", 100.0f },
+            { "DENSITY", 40.0f },
+            { "DIFFUSION", 50.0f },
+            { "MODRATE", 0.4f },
+            { "MODDEPTH", 60.0f },
+            { "EQ3_LOW", 5.0f },
+            { "EQ3_HIGH", -10.0f } // Underwater
+        } },
+
+        // Scorpio - Aggressive, stinging, intense
+        { "Scorpion Tail", {
+            { "MIX", 45.0f },
+            { "DELAY", 300.0f },
+            { "FEEDBACK", 55.0f },
+            { "WIDTH", 80.0f },
+            { "DENSITY", 80.0f },
+            { "DIFFUSION", 80.0f },
+            { "MODRATE", 4.0f }, // Intense flutter
+            { "MODDEPTH", 30.0f },
+            { "SATURATION", 80.0f }, // Heavy saturation
+            { "EQ3_HIGH", 5.0f }
+        } },
+
+        // Libra - Perfectly neutral, reference room
+        { "Balance Scale", {
+            { "MIX", 50.0f },
+            { "DELAY", 400.0f },
+            { "FEEDBACK", 50.0f },
+            { "WIDTH", 100.0f },
+            { "DENSITY", 50.0f },
+            { "DIFFUSION", 50.0f },
+            { "MODRATE", 0.5f },
+            { "MODDEPTH", 20.0f },
+            { "EQ3_LOW", 0.0f },
+            { "EQ3_MID", 0.0f },
+            { "EQ3_HIGH", 0.0f }
+        } },
+
+        // Leo - Warm, bold, mid-forward
+        { "Lion Heart", {
+            { "MIX", 55.0f },
+            { "DELAY", 500.0f },
+            { "FEEDBACK", 65.0f },
+            { "WIDTH", 90.0f },
+            { "DENSITY", 75.0f },
+            { "DIFFUSION", 85.0f },
+            { "MODRATE", 0.8f },
+            { "MODDEPTH", 25.0f },
+            { "SATURATION", 25.0f },
+            { "EQ3_MID", 4.0f }, // Mid boost
+            { "EQ3_HIGH", -2.0f }
+        } },
+
+        // Virgo - Clean, pure, pristine
+        { "Maiden", {
+            { "MIX", 40.0f },
+            { "DELAY", 350.0f },
+            { "FEEDBACK", 45.0f },
+            { "WIDTH", 100.0f },
+            { "DENSITY", 80.0f },
+            { "DIFFUSION", 90.0f },
+            { "MODRATE", 0.3f },
+            { "MODDEPTH", 10.0f }, // Very subtle
+            { "SATURATION", 0.0f }, // No saturation
+            { "EQ3_LOW", -2.0f } // Clean up mud
+        } },
+
+        // Pleiades - Shimmering, multi-tap texture
+        { "Seven Sisters", {
+            { "MIX", 60.0f },
+            { "DELAY", 777.0f },
+            { "FEEDBACK", 77.0f },
+            { "WIDTH", 100.0f },
+            { "DENSITY", 30.0f }, // Grainy
+            { "DIFFUSION", 60.0f },
+            { "MODRATE", 2.0f },
+            { "MODDEPTH", 50.0f },
+            { "EQ3_HIGH", 8.0f } // Shimmer brightness
+        } }
+    };
+}
+
+namespace ReverbModes
+{
+    const char* getName(int mode)
+    {
+        return juce::isPositiveAndBelow(mode, numModes) ? modes[mode].name : "";
+    }
+
+    std::vector<Setting> getSettings(int mode)
+    {
+        auto settings = resetSettings;
+
+        if (juce::isPositiveAndBelow(mode, numModes))
+            settings.insert(settings.end(), modes[mode].settings.begin(), modes[mode].settings.end());
+        else
+            settings.push_back({ "MIX", 50.0f });
+
+        return settings;
+    }
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include <juce_core/juce_core.h>
+#include <vector>
+
+// The character of each mode: the parameter values, by ID, that picking it from the MODE menu
+// sets. Each mode starts from the same clean modifiers, then sets its own values.
+namespace ReverbModes
+{
+    struct Setting
+    {
+        const char* parameterID;
+        float value;
+    };
+
+    static constexpr int numModes = 21;
+
+    // Display name, empty for modes out of range
+    const char* getName(int mode);
+
+    // In the order to apply them. Modes out of range only reset the modifiers and the mix.
+    std::vector<Setting> getSettings(int mode);
+}
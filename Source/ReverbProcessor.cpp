@@ -1,17 +1,12 @@
 #include "ReverbProcessor.h"
+#include "FastMath.h"
 #include <cmath>
+#include <limits>
 #include <juce_audio_basics/juce_audio_basics.h>
 
 ReverbProcessor::ReverbProcessor()
 {
-    dynEqFilter.setType(juce::dsp::StateVariableTPTFilterType::bandpass);
-    detectorFilter.setType(juce::dsp::StateVariableTPTFilterType::bandpass);
-
-    saturator.functionToUse = [](float x) {
-        return std::tanh(x);
-    };
-
-    limiter.setThreshold(0.0f);
+    limiter.setThreshold(-0.1f);
     limiter.setRelease(100.0f);
 }
 
@@ -19,52 +14,209 @@ ReverbProcessor::~ReverbProcessor()
 {
 }
 
-void ReverbProcessor::prepare(const juce::dsp::ProcessSpec& spec)
+void ReverbProcessor::setSubBlockSize(int numSamples)
+{
+    // Takes effect on the next prepare()
+    jassert(numSamples > 0 && (numSamples & (numSamples - 1)) == 0);
+    subBlockSize = juce::jlimit(8, 512, numSamples);
+}
+
+void ReverbProcessor::setLimiterLookahead(float milliseconds)
+{
+    // Takes effect on the next prepare()
+    limiter.setLookahead(milliseconds);
+}
+
+void ReverbProcessor::setDelayStorage(DelayStorage storage)
 {
-    sampleRate = spec.sampleRate;
+    // Takes effect on the next prepare()
+    delayStorage = storage;
+    preDelay.setStorage(storage);
+    reverb.setStorage(storage);
+}
 
-    reverb.prepare(spec);
-    delayLine.prepare(spec);
-    chorus.prepare(spec);
+void ReverbProcessor::setKernels(const DSPKernels& newKernels)
+{
+    kernels = &newKernels;
+    preDelay.setKernels(newKernels);
+    reverb.setKernels(newKernels);
+    velvet.setKernels(newKernels);
+}
+
+void ReverbProcessor::prepare(const juce::dsp::ProcessSpec& processSpec)
+{
+    sampleRate = processSpec.sampleRate;
 
-    dynEqFilter.prepare(spec);
-    detectorFilter.prepare(spec);
+    // Every stage only ever sees sub-blocks, whatever the host announced
+    auto spec = processSpec;
+    spec.maximumBlockSize = (juce::uint32)subBlockSize;
 
-    eq3Chain.prepare(spec);
+    delayArena.beginLayout();
+    preDelay.prepare(spec, (int)(2.0 * sampleRate), delayArena);
+    earlyReflections.prepare(spec, delayArena);
+    chorus.prepare(spec, delayArena);
+    reverb.prepare(spec, delayArena);
+    velvet.prepare(spec, delayArena);
+    delayArena.allocate();
+    engine = pendingParams.engine;
+
+    dynEq.prepare(spec);
+
+    eq3Filter.prepare((int)spec.numChannels, 3);
 
     limiter.prepare(spec);
-    saturator.prepare(spec);
 
-    delayLine.setMaximumDelayInSamples(2.0 * sampleRate);
-    wetBuffer.setSize(spec.numChannels, spec.maximumBlockSize);
+    // The eco tail runs on at most a stereo pair, at up to the full rate
+    auto tailChannels = juce::jmin(2, (int)spec.numChannels);
+    const int maxTailSpan = tailSpanSubBlocks * TailResampler::maxFactor * subBlockSize;
+    tailResampler.prepare(tailChannels, maxTailSpan);
+    lowRateBuffer.setSize(tailChannels, maxTailSpan);
+    tailSpanInput.setSize(tailChannels, maxTailSpan);
+    tailSpanOutput.setSize(tailChannels, maxTailSpan);
+    tailFactorTarget = getTailFactor();
+    setTailFactor(tailFactorTarget);
+
+    wetBuffer.setSize((int)spec.numChannels, subBlockSize);
+    detectorLevel.assign((size_t)subBlockSize, 0.0f);
+    detectorChannels.assign(spec.numChannels, nullptr);
+    gateGain.assign((size_t)subBlockSize, 0.0f);
+    duckGain.assign((size_t)subBlockSize, 0.0f);
+
+    // Around -360 dBFS, and the same every time so renders stay repeatable
+    antiDenormalNoise.resize((size_t)subBlockSize);
+    juce::Random noise(0x5eed);
+    for (auto& x : antiDenormalNoise)
+        x = (noise.nextFloat() * 2.0f - 1.0f) * antiDenormalDc;
+
+    // Envelope coefficients only depend on the sample rate
+    gateRel = 1.0f - std::exp(-1.0f / (0.1f * (float)sampleRate));
+    duckAtt = 1.0f - std::exp(-1.0f / (0.01f * (float)sampleRate));
+    duckRel = 1.0f - std::exp(-1.0f / (0.1f * (float)sampleRate));
+
+    // Stages must stay neutral for ~50 ms before they are skipped
+    bypassHoldSubBlocks = std::max(1, (int)std::ceil(0.05 * sampleRate / subBlockSize));
+    saturationMix.reset(sampleRate, 0.005);
+    saturationMix.setCurrentAndTargetValue(saturationStage.active ? 1.0f : 0.0f);
+    saturationAmount.assign((size_t)subBlockSize, 0.0f);
+
+    // 4x oversampled saturation for the offline profile
+    saturationOversampler = std::make_unique<juce::dsp::Oversampling<float>>(spec.numChannels, 2,
+        juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR, true, false);
+    saturationOversampler->initProcessing((size_t)subBlockSize);
+    saturationBuffer.setSize((int)spec.numChannels, subBlockSize);
+    oversampledSaturation.reset(sampleRate, 0.005);
+    oversampledSaturation.setCurrentAndTargetValue(quality == Quality::offline ? 1.0f : 0.0f);
+
+    // Offline gain ramps span exactly one sub-block
+    wetMix.reset(subBlockSize);
+    midGain.reset(subBlockSize);
+    sideGain.reset(subBlockSize);
+    gainRamp.assign((size_t)subBlockSize, 0.0f);
+    eq3CoefficientsDirty = true;
+
+    // A clear fades over 5 ms each way and zeroes 64 samples of memory per sample processed
+    clearGain.reset(sampleRate, 0.005);
+    clearGain.setCurrentAndTargetValue(1.0f);
+    clearState = ClearState::idle;
+    clearRequested = false;
+    clearAfterFade = false;
+    clearTail = false;
+    clearBudget = 64 * subBlockSize;
+
+    kernelChannels = -1;
+    selectKernels((int)spec.numChannels);
+
+    subBlockPhase = 0;
 }
 
 void ReverbProcessor::reset()
 {
     reverb.reset();
-    delayLine.reset();
+    velvet.reset();
+    tailResampler.reset();
+    resetTailSpan();
+    saturationOversampler->reset();
+    preDelay.reset();
+    earlyReflections.reset();
     chorus.reset();
-    dynEqFilter.reset();
-    detectorFilter.reset();
-    eq3Chain.reset();
+    dynEq.reset();
+    eq3Filter.reset();
     limiter.reset();
-    saturator.reset();
 
-    gateEnv = 0.0f;
+    gateEnv = gateStage.active ? 0.0f : 1.0f;
     duckEnv = 0.0f;
-    dynEqEnv = 0.0f;
+
+    clearGain.setCurrentAndTargetValue(1.0f);
+    clearState = ClearState::idle;
+    clearRequested = false;
+    clearAfterFade = false;
+    clearTail = false;
+
+    subBlockPhase = 0;
 }
 
 void ReverbProcessor::setParameters(const ReverbParameters& params)
 {
-    currentParams = params;
+    // Picked up at the next sub-block boundary
+    pendingParams = params;
 }
 
 void ReverbProcessor::process(juce::dsp::ProcessContextReplacing<float>& context)
 {
-    // 1. Update DSP Parameters
+    auto& outputBlock = context.getOutputBlock();
+    const size_t numSamples = outputBlock.getNumSamples();
+
+    // A NaN or infinity from the host would reach every feedback path and cost a recovery
+    // each sub-block it lasts, so it is zeroed on the way in
+    for (size_t ch=0; ch<outputBlock.getNumChannels(); ++ch)
+    {
+        auto* samples = outputBlock.getChannelPointer(ch);
+
+        if (kernels->outOfRange(samples, (int)numSamples, std::numeric_limits<float>::max()))
+            for (size_t i=0; i<numSamples; ++i)
+                if (! std::isfinite(samples[i]))
+                    samples[i] = 0.0f;
+    }
+
+    // Slice the host block into fixed sub-blocks. Boundaries sit on a grid that doesn't
+    // depend on the host buffer size, so parameter updates land on the same samples and
+    // the output is identical for any block size, including oversized ones.
+    size_t pos = 0;
+    while (pos < numSamples)
+    {
+        if (subBlockPhase == 0)
+            updateParameters();
+
+        auto len = std::min(numSamples - pos, (size_t)(subBlockSize - subBlockPhase));
+        processSubBlock(outputBlock.getSubBlock(pos, len));
+
+        subBlockPhase = (subBlockPhase + (int)len) % subBlockSize;
+        pos += len;
+    }
+}
+
+void ReverbProcessor::updateParameters()
+{
+    currentParams = pendingParams;
+    updateStageBypass();
+
+    if (pendingQualityTier != qualityTier)
+    {
+        qualityTier = pendingQualityTier;
+        reverb.setReducedLines(qualityTier >= QualityController::reduced);
+    }
 
-    juce::dsp::Reverb::Parameters rParams;
+    // updateClear() switches the tail rate
+    tailFactorTarget = getTailFactor();
+    updateClear();
+
+    if (pendingQuality != quality)
+    {
+        quality = pendingQuality;
+        applyQuality();
+    }
+
+    ReverbTail::Parameters rParams;
     rParams.roomSize = currentParams.feedback / 100.0f;
     rParams.damping = 1.0f - (currentParams.density / 100.0f);
     rParams.width = currentParams.width / 100.0f;
@@ -81,6 +233,7 @@ void ReverbProcessor::process(juce::dsp::ProcessContextReplacing<float>& context
     }
 
     reverb.setParameters(rParams);
+    velvet.setParameters(rParams);
 
     // Pre-Delay
     float delayMs = currentParams.delay;
@@ -91,7 +244,18 @@ void ReverbProcessor::process(juce::dsp::ProcessContextReplacing<float>& context
         else if (currentParams.preDelaySync == 2) delayMs = beatMs * 0.5f; // 1/8
         else if (currentParams.preDelaySync == 3) delayMs = beatMs * 0.25f; // 1/16
     }
-    delayLine.setDelay(delayMs * sampleRate / 1000.0f);
+    // The eco tail's span and the resampler's linear-phase filters delay it by a fixed amount,
+    // taken out of the pre-delay. Below that the wet signal simply comes in late. It isn't
+    // reported to the host: only the wet path has it, and it moves with the pre-delay. The
+    // diffusion cascade isn't a bulk delay, its allpasses pass part of the input straight
+    // through, so it isn't compensated.
+    float delaySamples = delayMs * (float)sampleRate / 1000.0f;
+    float fixedLatency = (float)getTailLatencySamples();
+    preDelay.setDelay(std::max(0.0f, delaySamples - fixedLatency));
+
+    // Early Reflections
+    earlyReflections.setMode(currentParams.mode);
+    earlyReflections.setDiffusion(currentParams.diffusion / 100.0f);
 
     // Warp
     chorus.setRate(currentParams.modRate);
@@ -100,146 +264,685 @@ void ReverbProcessor::process(juce::dsp::ProcessContextReplacing<float>& context
     chorus.setMix(0.5f);
 
     // Dynamic EQ
-    dynEqFilter.setCutoffFrequency(currentParams.dynFreq);
-    dynEqFilter.setResonance(currentParams.dynQ);
-    detectorFilter.setCutoffFrequency(currentParams.dynFreq);
-    detectorFilter.setResonance(currentParams.dynQ);
+    dynEq.setNumBands(currentParams.dynBandCount);
+    for (int b = 0; b < MultiBandDynamicEq::maxBands; ++b)
+        dynEq.setBand(b, currentParams.dynBands[(size_t)b]);
 
-    // 3-Band EQ
-    auto& lowShelf = eq3Chain.get<0>();
-    lowShelf.coefficients = juce::dsp::IIR::Coefficients<float>::makeLowShelf(sampleRate, 200.0f, 0.71f, juce::Decibels::decibelsToGain(currentParams.eq3Low));
+    // 3-Band EQ, coefficients are only rebuilt when the gains change
+    if (eq3Stage.active && (eq3CoefficientsDirty || currentParams.eq3Low != appliedEq3Low
+                            || currentParams.eq3Mid != appliedEq3Mid || currentParams.eq3High != appliedEq3High))
+    {
+        using Coefficients = juce::dsp::IIR::Coefficients<float>;
+
+        auto lowShelf = Coefficients::makeLowShelf(sampleRate, 200.0f, 0.71f, juce::Decibels::decibelsToGain(currentParams.eq3Low));
+        eq3Filter.setStage(0, lowShelf->getRawCoefficients());
 
-    auto& midPeak = eq3Chain.get<1>();
-    midPeak.coefficients = juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate, 1000.0f, 1.0f, juce::Decibels::decibelsToGain(currentParams.eq3Mid));
+        auto midPeak = Coefficients::makePeakFilter(sampleRate, 1000.0f, 1.0f, juce::Decibels::decibelsToGain(currentParams.eq3Mid));
+        eq3Filter.setStage(1, midPeak->getRawCoefficients());
 
-    auto& highShelf = eq3Chain.get<2>();
-    highShelf.coefficients = juce::dsp::IIR::Coefficients<float>::makeHighShelf(sampleRate, 6000.0f, 0.71f, juce::Decibels::decibelsToGain(currentParams.eq3High));
+        auto highShelf = Coefficients::makeHighShelf(sampleRate, 6000.0f, 0.71f, juce::Decibels::decibelsToGain(currentParams.eq3High));
+        eq3Filter.setStage(2, highShelf->getRawCoefficients());
 
-    // Limiter
-    limiter.setThreshold(currentParams.limiterOn ? -0.1f : 10.0f);
+        appliedEq3Low = currentParams.eq3Low;
+        appliedEq3Mid = currentParams.eq3Mid;
+        appliedEq3High = currentParams.eq3High;
+        eq3CoefficientsDirty = false;
+    }
 
-    // 2. Process Audio
+    // Limiter, switched off it still delays the signal
+    limiter.setEnabled(currentParams.limiterOn);
+
+    // Mix and M/S gains, stepped per sub-block or ramped per sample offline
+    float balance = currentParams.msBalance / 100.0f;
+    auto setGain = [this](juce::SmoothedValue<float>& value, float target)
+    {
+        if (quality == Quality::offline)
+            value.setTargetValue(target);
+        else
+            value.setCurrentAndTargetValue(target);
+    };
+
+    setGain(wetMix, currentParams.mix / 100.0f);
+    setGain(midGain, ((balance < 0.5f) ? 1.0f : 2.0f * (1.0f - balance)) * 0.5f);
+    setGain(sideGain, ((balance > 0.5f) ? 1.0f : balance * 2.0f) * 0.5f);
+
+    // Dynamics
+    gateThreshLin = juce::Decibels::decibelsToGain(currentParams.gateThresh);
+    duckIntensity = currentParams.ducking / 100.0f;
+}
+
+int ReverbProcessor::getEcoFactor(int eco, double rate)
+{
+    switch (eco)
+    {
+        case 1: return 2;
+        case 2: return TailResampler::maxFactor;
+        case 3:
+        {
+            // Highest divisor that keeps the tail at 44.1 kHz or more
+            int factor = 1;
+            while (factor < TailResampler::maxFactor && rate / (factor * 2) >= 44100.0)
+                factor *= 2;
+            return factor;
+        }
+        default: return 1;
+    }
+}
+
+int ReverbProcessor::getTailFactor() const
+{
+    // Eco, and load shedding at the lowest tier, lower the tail rate
+    auto factor = getEcoFactor(currentParams.eco, sampleRate);
+    if (qualityTier >= QualityController::low)
+        factor = juce::jlimit(2, TailResampler::maxFactor, factor);
+    return factor;
+}
+
+void ReverbProcessor::setTailFactor(int factor)
+{
+    tailResampler.setFactor(factor);
+    reverb.setProcessingRate(sampleRate / factor);
+    velvet.setProcessingRate(sampleRate / factor);
+
+    tailSpanLength = factor > 1 ? tailSpanSubBlocks * factor * subBlockSize : 0;
+    resetTailSpan();
+}
+
+int ReverbProcessor::getTailLatencySamples() const
+{
+    return tailSpanLength + tailResampler.getLatencySamples();
+}
+
+int ReverbProcessor::getWetArrivalSamples() const
+{
+    const auto delay = (int)std::ceil(preDelay.getLongestDelay());
+    return delay + getTailLatencySamples() + earlyReflections.getLongestTap() + getLatencySamples();
+}
+
+void ReverbProcessor::resetTailSpan()
+{
+    // Starts a span at the current sub-block, which keeps spans on the sub-block grid
+    tailSpanInput.clear();
+    tailSpanOutput.clear();
+    tailSpanPosition = 0;
+}
+
+void ReverbProcessor::applyQuality()
+{
+    const bool offline = quality == Quality::offline;
+
+    reverb.setExtraLines(offline);
+    reverb.setPreciseAccumulation(offline);
+
+    // The oversampler's filters start clean, the crossfade covers their settling
+    if (offline && oversampledSaturation.getCurrentValue() == 0.0f)
+        saturationOversampler->reset();
+    oversampledSaturation.setTargetValue(offline ? 1.0f : 0.0f);
+}
+
+void ReverbProcessor::updateClear()
+{
+    // The fades only run with the wet chain, when it is skipped there is nothing to fade
+    if (! wetStage.active)
+        clearGain.setCurrentAndTargetValue(clearGain.getTargetValue());
+
+    switch (clearState)
+    {
+        case ClearState::idle:
+            // A new tail rate starts from an empty tail, so it is switched under the same fade.
+            // So is the engine, which is cleared before it comes in.
+            if (clearRequested || tailFactorTarget != tailResampler.getFactor() || currentParams.engine != engine)
+            {
+                clearAfterFade = clearRequested;
+                clearRequested = false;
+                clearGain.setTargetValue(0.0f);
+                clearState = ClearState::fadingOut;
+            }
+            break;
+
+        case ClearState::fadingOut:
+            if (! clearGain.isSmoothing())
+            {
+                // A new rate or engine only needs the tail that runs next zeroed
+                if (tailFactorTarget != tailResampler.getFactor())
+                {
+                    setTailFactor(tailFactorTarget);
+                    clearTail = true;
+                }
+
+                if (currentParams.engine != engine)
+                {
+                    engine = currentParams.engine;
+                    clearTail = true;
+                }
+
+                if (clearAfterFade || clearTail)
+                {
+                    clearStage = 0;
+                    clearState = ClearState::zeroing;
+                }
+                else
+                {
+                    clearGain.setTargetValue(1.0f);
+                    clearState = ClearState::fadingIn;
+                }
+            }
+            break;
+
+        case ClearState::zeroing:
+        {
+            // The big delay memories a slice at a time, the pre-delay only needs a reset. The
+            // active tail only, unless the whole wet chain is cleared.
+            const int numStages = clearAfterFade ? 2 : 1;
+            int budget = clearBudget;
+            while (budget > 0 && clearStage < numStages)
+            {
+                int cleared = clearStage == 0 ? (engine == 0 ? reverb.clearSome(budget) : velvet.clearSome(budget))
+                                              : earlyReflections.clearSome(budget);
+                budget -= cleared;
+                if (budget > 0)
+                    ++clearStage;
+            }
+
+            if (clearStage < numStages)
+                break;
+
+            tailResampler.reset();
+            resetTailSpan();
+
+            // Everything else is small enough to reset in one go. The limiter acts on the
+            // dry signal too, so it keeps its state.
+            if (clearAfterFade)
+            {
+                preDelay.reset();
+                saturationOversampler->reset();
+                chorus.reset();
+                dynEq.reset();
+                eq3Filter.reset();
+
+                gateEnv = gateStage.active ? 0.0f : 1.0f;
+                duckEnv = 0.0f;
+            }
+
+            clearAfterFade = false;
+            clearTail = false;
+            clearGain.setTargetValue(1.0f);
+            clearState = ClearState::fadingIn;
+            break;
+        }
+
+        case ClearState::fadingIn:
+            if (! clearGain.isSmoothing())
+                clearState = ClearState::idle;
+            break;
+    }
+}
+
+void ReverbProcessor::updateStageBypass()
+{
+    // Stages whose settings make them an identity are skipped. When a stateful stage
+    // drops out its state is set to what it would hold at the neutral setting, so it
+    // comes back without a discontinuity.
+    const auto hold = bypassHoldSubBlocks;
+    auto isZero = [](float v) { return std::abs(v) < 1.0e-4f; };
+
+    saturationStage.update(currentParams.saturation <= 0.0f, hold);
+    saturationMix.setTargetValue(saturationStage.active ? 1.0f : 0.0f);
+
+    if (gateStage.update(currentParams.gateThresh <= -100.0f, hold))
+        gateEnv = 1.0f;
+
+    bool dynEqNeutral = true;
+    for (int b = 0; b < currentParams.dynBandCount; ++b)
+        dynEqNeutral = dynEqNeutral && isZero(currentParams.dynBands[(size_t)b].gain) && isZero(currentParams.dynBands[(size_t)b].depth);
+
+    if (dynEqStage.update(dynEqNeutral, hold))
+        dynEq.reset();
+
+    if (duckingStage.update(currentParams.ducking <= 0.0f, hold))
+        duckEnv = 0.0f;
+
+    if (eq3Stage.update(isZero(currentParams.eq3Low) && isZero(currentParams.eq3Mid) && isZero(currentParams.eq3High), hold))
+        eq3Filter.reset();
+
+    msStage.update(isZero(currentParams.msBalance - 50.0f), hold);
+    msKernel = (msStage.active && wetBuffer.getNumChannels() == 2) ? &ReverbProcessor::processMidSide : nullptr;
+
+    // All dry: the wet chain is skipped, and cleared a slice at a time while it is, so it
+    // comes back empty rather than with a tail from whenever it stopped
+    if (wetStage.update(currentParams.mix <= 0.0f, hold))
+        clearRequested = true;
+
+    selectKernels(wetBuffer.getNumChannels());
+}
+
+void ReverbProcessor::processSubBlock(juce::dsp::AudioBlock<float> block)
+{
+    juce::dsp::ProcessContextReplacing<float> context(block);
     auto& inputBlock = context.getInputBlock();
     auto& outputBlock = context.getOutputBlock();
 
-    wetBuffer.copyFrom(0, 0, inputBlock.getChannelPointer(0), (int)inputBlock.getNumSamples());
-    if (inputBlock.getNumChannels() > 1)
-        wetBuffer.copyFrom(1, 0, inputBlock.getChannelPointer(1), (int)inputBlock.getNumSamples());
+    size_t nSamples = outputBlock.getNumSamples();
+    size_t nChannels = std::min(outputBlock.getNumChannels(), (size_t)wetBuffer.getNumChannels());
+    jassert(nSamples <= (size_t)wetBuffer.getNumSamples());
 
-    juce::dsp::AudioBlock<float> wetBlock(wetBuffer);
-    juce::dsp::ProcessContextReplacing<float> wetContext(wetBlock);
+    // All dry leaves the input untouched apart from the limiter and its delay
+    if (wetStage.active)
+    {
+        juce::dsp::AudioBlock<float> wetBlock = juce::dsp::AudioBlock<float>(wetBuffer).getSubsetChannelBlock(0, nChannels).getSubBlock(0, nSamples);
 
-    // 2.1 Saturation (Pre)
-    float drive = 1.0f + (currentParams.saturation / 20.0f);
-    wetBlock.multiplyBy(drive);
-    saturator.process(wetContext);
-    wetBlock.multiplyBy(1.0f / drive);
+        if (clearState == ClearState::zeroing)
+        {
+            // Muted while its memory is being cleared
+            wetBlock.clear();
+        }
+        else
+        {
+            for (size_t ch=0; ch<nChannels; ++ch)
+                wetBuffer.copyFrom((int)ch, 0, inputBlock.getChannelPointer(ch), (int)nSamples);
 
-    // 2.2 Pre-Delay
-    delayLine.process(wetContext);
+            processWet(wetBlock, inputBlock.getChannelPointer(0));
+        }
+
+        const bool midSideOn = msKernel != nullptr && clearState != ClearState::zeroing;
+        const bool midSideSmoothing = midSideOn && (midGain.isSmoothing() || sideGain.isSmoothing());
+
+        // 2.8 M/S Balance and 2.9 Mix in one pass when no gain is ramping, which also gives the
+        // limiter its block peak
+        if (clearState == ClearState::idle && ! wetMix.isSmoothing() && ! midSideSmoothing
+            && outputBlock.getNumChannels() == nChannels)
+        {
+            const float wetAmt = currentParams.mix >= 100.0f ? 1.0f : currentParams.mix / 100.0f;
+            const float dryAmt = currentParams.mix >= 100.0f ? 0.0f : 1.0f - wetAmt;
+            float peak = 0.0f;
+
+            if (midSideOn)
+            {
+                peak = kernels->mixMidSidePeak(outputBlock.getChannelPointer(0), outputBlock.getChannelPointer(1),
+                                               wetBlock.getChannelPointer(0), wetBlock.getChannelPointer(1),
+                                               midGain.getTargetValue(), sideGain.getTargetValue(), dryAmt, wetAmt, (int)nSamples);
+            }
+            else
+            {
+                for (size_t ch=0; ch<nChannels; ++ch)
+                    peak = std::max(peak, kernels->mixPeak(outputBlock.getChannelPointer(ch), wetBlock.getChannelPointer(ch),
+                                                           dryAmt, wetAmt, (int)nSamples));
+            }
+
+            // 2.10 Limiter
+            limiter.process(outputBlock, peak);
+            checkOutput(outputBlock);
+            return;
+        }
+
+        // Otherwise stage by stage, with the clear fade between them
+        if (midSideOn)
+            (this->*msKernel)(wetBlock, nullptr);
+
+        if (clearState != ClearState::idle && clearState != ClearState::zeroing)
+        {
+            for (size_t s=0; s<nSamples; ++s)
+            {
+                const float gain = clearGain.getNextValue();
+                for (size_t ch=0; ch<nChannels; ++ch)
+                    wetBlock.getChannelPointer(ch)[s] *= gain;
+            }
+        }
+
+        // 2.9 Mix
+        if (wetMix.isSmoothing())
+        {
+            for (size_t s=0; s<nSamples; ++s)
+                gainRamp[s] = wetMix.getNextValue();
+
+            for (size_t ch=0; ch<outputBlock.getNumChannels(); ++ch)
+            {
+                auto* out = outputBlock.getChannelPointer(ch);
+                const auto* wet = ch < nChannels ? wetBlock.getChannelPointer(ch) : nullptr;
+
+                for (size_t s=0; s<nSamples; ++s)
+                    out[s] = out[s] * (1.0f - gainRamp[s]) + (wet != nullptr ? wet[s] * gainRamp[s] : 0.0f);
+            }
+        }
+        else if (currentParams.mix >= 100.0f)
+        {
+            for (size_t ch=0; ch<nChannels; ++ch)
+                juce::FloatVectorOperations::copy(outputBlock.getChannelPointer(ch), wetBlock.getChannelPointer(ch), nSamples);
+        }
+        else
+        {
+            float wetAmt = currentParams.mix / 100.0f;
+            float dryAmt = 1.0f - wetAmt;
+
+            for (size_t ch=0; ch<nChannels; ++ch)
+                kernels->mix(outputBlock.getChannelPointer(ch), wetBlock.getChannelPointer(ch), dryAmt, wetAmt, (int)nSamples);
+
+            for (size_t ch=nChannels; ch<outputBlock.getNumChannels(); ++ch)
+                juce::FloatVectorOperations::multiply(outputBlock.getChannelPointer(ch), dryAmt, nSamples);
+        }
+    }
+
+    // 2.10 Limiter
+    limiter.process(outputBlock);
+    checkOutput(outputBlock);
+}
+
+bool ReverbProcessor::isOutOfRange(const juce::dsp::AudioBlock<float>& block, float limit) const
+{
+    for (size_t ch=0; ch<block.getNumChannels(); ++ch)
+        if (kernels->outOfRange(block.getChannelPointer(ch), (int)block.getNumSamples(), limit))
+            return true;
+
+    return false;
+}
+
+void ReverbProcessor::checkOutput(const juce::dsp::AudioBlock<float>& block)
+{
+    // Only NaN and infinity here, from the limiter's own state, which starts over along
+    // with the wet chain. The dry input is already finite.
+    if (isOutOfRange(block, std::numeric_limits<float>::max()))
+    {
+        block.clear();
+        limiter.reset();
+        recover();
+    }
+}
+
+void ReverbProcessor::recover()
+{
+    // Muted at once, the state can't be faded out, then cleared and faded back in like clear()
+    recoveryCount.fetch_add(1, std::memory_order_relaxed);
+    clearGain.setCurrentAndTargetValue(0.0f);
+    clearRequested = false;
+    clearAfterFade = true;
+    clearState = ClearState::fadingOut;
+}
+
+void ReverbProcessor::processTail(const juce::dsp::AudioBlock<float>& block)
+{
+    if (engine == 0)
+        reverb.process(block);
+    else
+        velvet.process(block);
+}
+
+void ReverbProcessor::processReducedRateTail(const juce::dsp::AudioBlock<float>& block)
+{
+    const auto numSamples = block.getNumSamples();
+    const auto numChannels = block.getNumChannels();
+    jassert(tailSpanPosition + (int)numSamples <= tailSpanLength);
+
+    // This sub-block's share of the last span out, its input in
+    for (size_t ch=0; ch<numChannels; ++ch)
+    {
+        auto* samples = block.getChannelPointer(ch);
+        auto* input = tailSpanInput.getWritePointer((int)ch, tailSpanPosition);
+        auto* output = tailSpanOutput.getWritePointer((int)ch, tailSpanPosition);
+
+        juce::FloatVectorOperations::copy(input, samples, (int)numSamples);
+        juce::FloatVectorOperations::copy(samples, output, (int)numSamples);
+    }
 
-    // 2.3 Warp
-    chorus.process(wetContext);
+    tailSpanPosition += (int)numSamples;
+    if (tailSpanPosition < tailSpanLength)
+        return;
 
-    // 2.4 Reverb
-    reverb.process(wetContext);
+    // A whole span: down, through the tail a sub-block at a time, and back up
+    auto spanInput = juce::dsp::AudioBlock<float>(tailSpanInput).getSubsetChannelBlock(0, numChannels).getSubBlock(0, (size_t)tailSpanLength);
+    auto lowBlock = juce::dsp::AudioBlock<float>(lowRateBuffer).getSubsetChannelBlock(0, numChannels);
 
-    // 2.5 Gate, DynEQ, Ducking Loop
+    const int numLow = tailResampler.decimate(spanInput, lowBlock);
+    for (int pos = 0; pos < numLow; pos += subBlockSize)
+        processTail(lowBlock.getSubBlock((size_t)pos, (size_t)std::min(subBlockSize, numLow - pos)));
+
+    auto spanOutput = juce::dsp::AudioBlock<float>(tailSpanOutput).getSubsetChannelBlock(0, numChannels).getSubBlock(0, (size_t)tailSpanLength);
+    tailResampler.interpolate(lowBlock, numLow, spanOutput);
+    tailSpanPosition = 0;
+}
+
+void ReverbProcessor::processWet(juce::dsp::AudioBlock<float>& wetBlock, const float* dryInput)
+{
     size_t nSamples = wetBlock.getNumSamples();
     size_t nChannels = wetBlock.getNumChannels();
 
-    float gateThreshLin = juce::Decibels::decibelsToGain(currentParams.gateThresh);
-    float dynThreshLin = std::pow(10.0f, currentParams.dynThresh / 20.0f);
+    // 2.1 Saturation (Pre), crossfaded in and out of bypass, and between the plain and
+    // oversampled versions when the quality profile changes
+    if (saturationStage.active || saturationMix.isSmoothing())
+    {
+        float drive = 1.0f + (currentParams.saturation / 20.0f);
 
-    // Coefficients
-    float gateRel = 1.0f - std::exp(-1.0f / (0.1f * sampleRate));
-    float dynAtt = 1.0f - std::exp(-1.0f / (0.005f * sampleRate));
-    float dynRel = 1.0f - std::exp(-1.0f / (0.1f * sampleRate));
-    float duckAtt = 1.0f - std::exp(-1.0f / (0.01f * sampleRate));
-    float duckRel = 1.0f - std::exp(-1.0f / (0.1f * sampleRate));
+        const float* amounts = nullptr;
+        if (saturationMix.isSmoothing())
+        {
+            for (size_t s = 0; s < nSamples; ++s)
+                saturationAmount[s] = saturationMix.getNextValue();
+            amounts = saturationAmount.data();
+        }
 
-    float duckIntensity = currentParams.ducking / 100.0f;
+        if (oversampledSaturation.isSmoothing())
+        {
+            auto oversampledBlock = juce::dsp::AudioBlock<float>(saturationBuffer).getSubsetChannelBlock(0, nChannels).getSubBlock(0, nSamples);
+            oversampledBlock.copyFrom(wetBlock);
+
+            saturate(wetBlock, drive, amounts, 1);
+            saturateOversampled(oversampledBlock, drive, amounts);
+
+            for (size_t s = 0; s < nSamples; ++s)
+            {
+                float fade = oversampledSaturation.getNextValue();
+                for (size_t ch=0; ch<nChannels; ++ch)
+                {
+                    auto& x = wetBlock.getChannelPointer(ch)[s];
+                    x += fade * (oversampledBlock.getChannelPointer(ch)[s] - x);
+                }
+            }
+        }
+        else if (oversampledSaturation.getCurrentValue() > 0.0f)
+        {
+            saturateOversampled(wetBlock, drive, amounts);
+        }
+        else
+        {
+            saturate(wetBlock, drive, amounts, 1);
+        }
+    }
+    else
+    {
+        oversampledSaturation.setCurrentAndTargetValue(oversampledSaturation.getTargetValue());
+    }
+
+    // A noise floor far under hearing, so the feedback paths after it never decay into
+    // denormals, whatever the FTZ/DAZ flags of the thread
+    for (size_t ch=0; ch<nChannels; ++ch)
+        juce::FloatVectorOperations::add(wetBlock.getChannelPointer(ch), antiDenormalNoise.data() + subBlockPhase, (int)nSamples);
+
+    // 2.2 Pre-Delay
+    preDelay.process(wetBlock);
 
-    for (size_t s = 0; s < nSamples; ++s)
+    // 2.3 Early Reflections
+    earlyReflections.process(wetBlock);
+
+    // 2.4 Warp
+    chorus.process(wetBlock);
+
+    // 2.5 Reverb, at a reduced rate in eco mode
+    if (tailResampler.getFactor() > 1)
+    {
+        processReducedRateTail(wetBlock.getSubsetChannelBlock(0, std::min(nChannels, (size_t)tailSpanInput.getNumChannels())));
+    }
+    else
     {
-        // Gate Level
-        float maxLevel = 0.0f;
-        for (size_t ch=0; ch<nChannels; ++ch) maxLevel = std::max(maxLevel, std::abs(wetBlock.getChannelPointer(ch)[s]));
+        processTail(wetBlock);
+    }
 
-        if (maxLevel > gateThreshLin) gateEnv = 1.0f;
-        else gateEnv += (0.0f - gateEnv) * gateRel;
+    // The tail carries what every feedback path before it produced, so it is where a NaN or
+    // a runaway shows up first. The wet chain is muted and cleared, then fades back in.
+    if (isOutOfRange(wetBlock, runawayLimit))
+    {
+        wetBlock.clear();
+        recover();
+        return;
+    }
 
-        // DynEQ Detector
-        float detOut = detectorFilter.processSample(0, maxLevel);
-        float envIn = std::abs(detOut);
-        if (envIn > dynEqEnv) dynEqEnv += (envIn - dynEqEnv) * dynAtt;
-        else dynEqEnv += (envIn - dynEqEnv) * dynRel;
+    // 2.6 - 2.7 Gate, DynEQ, Ducking, 3-Band EQ
+    (this->*dynamicsKernel)(wetBlock, dryInput);
 
-        float dynGain = 0.0f;
-        if (dynEqEnv > dynThreshLin)
+    if (eq3Stage.active)
+        eq3Filter.process(wetBlock);
+
+    // M/S Balance follows in processSubBlock(), with the mix
+}
+
+void ReverbProcessor::saturate(juce::dsp::AudioBlock<float>& block, float drive, const float* amounts, int amountStep)
+{
+    // amounts, when given, blends in the saturated signal per sample, one value per amountStep samples
+    const float invDrive = 1.0f / drive;
+    const size_t nSamples = block.getNumSamples();
+
+    for (size_t ch=0; ch<block.getNumChannels(); ++ch)
+    {
+        auto* samples = block.getChannelPointer(ch);
+
+        if (amounts != nullptr)
         {
-             float excessDb = juce::Decibels::gainToDecibels(dynEqEnv + 0.00001f) - currentParams.dynThresh;
-             if (excessDb > 0.0f) dynGain = currentParams.dynDepth * std::min(1.0f, excessDb/20.0f);
+            for (size_t s = 0; s < nSamples; ++s)
+            {
+                float x = samples[s];
+                samples[s] = x + amounts[s / (size_t)amountStep] * (FastMath::tanh(x * drive) * invDrive - x);
+            }
         }
-        float totalDynGain = juce::Decibels::decibelsToGain(currentParams.dynGain + dynGain);
+        else
+        {
+            for (size_t s = 0; s < nSamples; ++s)
+                samples[s] = FastMath::tanh(samples[s] * drive) * invDrive;
+        }
+    }
+}
 
-        // Ducking Envelope (Dry Input)
-        float dryL = std::abs(inputBlock.getChannelPointer(0)[s]);
-        if (dryL > duckEnv) duckEnv += (dryL - duckEnv) * duckAtt;
-        else duckEnv += (dryL - duckEnv) * duckRel;
+void ReverbProcessor::saturateOversampled(juce::dsp::AudioBlock<float>& block, float drive, const float* amounts)
+{
+    auto upsampled = saturationOversampler->processSamplesUp(block);
+    saturate(upsampled, drive, amounts, (int)saturationOversampler->getOversamplingFactor());
+    saturationOversampler->processSamplesDown(block);
+}
 
-        float duckGain = std::max(0.0f, 1.0f - (duckEnv * duckIntensity * 4.0f));
+//==============================================================================
+// Specialised kernels, one instantiation per channel layout and set of enabled stages.
+// NumChannels is 1, 2, or 0 for any other count.
+template <int NumChannels, int Features>
+void ReverbProcessor::processDynamics(juce::dsp::AudioBlock<float>& wetBlock, const float* dryInput)
+{
+    constexpr bool gateOn = (Features & gateFeature) != 0;
+    constexpr bool dynEqOn = (Features & dynEqFeature) != 0;
+    constexpr bool duckingOn = (Features & duckingFeature) != 0;
 
-        // Apply Processes per channel
-        for (size_t ch=0; ch<nChannels; ++ch)
+    if constexpr (! (gateOn || dynEqOn || duckingOn))
+    {
+        juce::ignoreUnused(wetBlock, dryInput);
+        return;
+    }
+    else
+    {
+        const size_t nSamples = wetBlock.getNumSamples();
+        const size_t nChannels = NumChannels > 0 ? (size_t)NumChannels : wetBlock.getNumChannels();
+        jassert(NumChannels == 0 || wetBlock.getNumChannels() == (size_t)NumChannels);
+
+        // Detector input, the peak across channels for the whole sub-block
+        if constexpr (gateOn || dynEqOn)
         {
-            float samp = wetBlock.getChannelPointer(ch)[s];
+            for (size_t ch=0; ch<nChannels; ++ch)
+                detectorChannels[ch] = wetBlock.getChannelPointer(ch);
 
-            // Gate
-            samp *= gateEnv;
+            kernels->maxAbs(detectorLevel.data(), detectorChannels.data(), (int)nChannels, (int)nSamples);
+        }
 
-            // DynEQ (Peak Approx)
-            float bp = dynEqFilter.processSample((int)ch, samp);
-            samp = samp + (totalDynGain - 1.0f) * bp;
+        // Envelopes sample by sample, then each stage is applied to all channels at once
+        for (size_t s = 0; s < nSamples; ++s)
+        {
+            // Gate Level
+            if constexpr (gateOn)
+            {
+                gateEnv = (detectorLevel[s] > gateThreshLin) ? 1.0f : gateEnv - gateEnv * gateRel + antiDenormalDc;
+                gateGain[s] = gateEnv;
+            }
+
+            // Ducking Envelope (Dry Input)
+            if constexpr (duckingOn)
+            {
+                float dryL = std::abs(dryInput[s]) + antiDenormalDc;
+                duckEnv += (dryL - duckEnv) * ((dryL > duckEnv) ? duckAtt : duckRel);
+                duckGain[s] = std::max(0.0f, 1.0f - (duckEnv * duckIntensity * 4.0f));
+            }
+        }
 
-            // Ducking
-            samp *= duckGain;
+        if constexpr (gateOn)
+            for (size_t ch=0; ch<nChannels; ++ch)
+                juce::FloatVectorOperations::multiply(wetBlock.getChannelPointer(ch), gateGain.data(), nSamples);
 
-            wetBlock.getChannelPointer(ch)[s] = samp;
-        }
+        // DynEQ, each band follows its own band of the detector level
+        if constexpr (dynEqOn)
+            dynEq.process(wetBlock.getSubsetChannelBlock(0, nChannels), detectorLevel.data());
+
+        if constexpr (duckingOn)
+            for (size_t ch=0; ch<nChannels; ++ch)
+                juce::FloatVectorOperations::multiply(wetBlock.getChannelPointer(ch), duckGain.data(), nSamples);
     }
+}
+
+void ReverbProcessor::processMidSide(juce::dsp::AudioBlock<float>& wetBlock, const float*)
+{
+    jassert(wetBlock.getNumChannels() == 2);
 
-    // 2.6 3-Band EQ
-    eq3Chain.process(wetContext);
+    const size_t nSamples = wetBlock.getNumSamples();
+    auto* left = wetBlock.getChannelPointer(0);
+    auto* right = wetBlock.getChannelPointer(1);
 
-    // 2.7 M/S Balance
-    if (nChannels == 2)
+    if (midGain.isSmoothing() || sideGain.isSmoothing())
     {
-        float balance = currentParams.msBalance / 100.0f;
         for (size_t s=0; s<nSamples; ++s)
         {
-            float l = wetBlock.getChannelPointer(0)[s];
-            float r = wetBlock.getChannelPointer(1)[s];
-            float m = (l + r) * 0.5f;
-            float side = (l - r) * 0.5f;
+            float m = (left[s] + right[s]) * midGain.getNextValue();
+            float side = (left[s] - right[s]) * sideGain.getNextValue();
 
-            float mGain = (balance < 0.5f) ? 1.0f : 2.0f * (1.0f - balance);
-            float sGain = (balance > 0.5f) ? 1.0f : balance * 2.0f;
-
-            wetBlock.getChannelPointer(0)[s] = m * mGain + side * sGain;
-            wetBlock.getChannelPointer(1)[s] = m * mGain - side * sGain;
+            left[s] = m + side;
+            right[s] = m - side;
         }
     }
+    else
+    {
+        kernels->midSide(left, right, midGain.getTargetValue(), sideGain.getTargetValue(), (int)nSamples);
+    }
+}
 
-    // 2.9 Mix
-    float wetAmt = currentParams.mix / 100.0f;
-    float dryAmt = 1.0f - wetAmt;
+template <int NumChannels, size_t... Masks>
+std::array<ReverbProcessor::KernelFunction, sizeof...(Masks)> ReverbProcessor::makeDynamicsKernelRow(std::index_sequence<Masks...>)
+{
+    return { &ReverbProcessor::processDynamics<NumChannels, (int)Masks>... };
+}
 
-    outputBlock.multiplyBy(dryAmt);
-    for (size_t ch=0; ch<nChannels; ++ch)
-        juce::FloatVectorOperations::addWithMultiply(outputBlock.getChannelPointer(ch), wetBlock.getChannelPointer(ch), wetAmt, nSamples);
+ReverbProcessor::KernelFunction ReverbProcessor::selectDynamicsKernel(int numChannels, int features)
+{
+    static constexpr auto masks = std::make_index_sequence<dynamicsFeatureMasks>();
+    static const std::array<std::array<KernelFunction, dynamicsFeatureMasks>, 3> table = { {
+        makeDynamicsKernelRow<0>(masks),
+        makeDynamicsKernelRow<1>(masks),
+        makeDynamicsKernelRow<2>(masks)
+    } };
+
+    auto row = (numChannels == 1 || numChannels == 2) ? numChannels : 0;
+    return table[(size_t)row][(size_t)(features & (dynamicsFeatureMasks - 1))];
+}
 
-    // 2.10 Limiter
-    if (currentParams.limiterOn)
-        limiter.process(context);
+void ReverbProcessor::selectKernels(int numChannels)
+{
+    int features = (gateStage.active ? gateFeature : 0)
+                 | (dynEqStage.active ? dynEqFeature : 0)
+                 | (duckingStage.active ? duckingFeature : 0);
+
+    if (numChannels == kernelChannels && features == kernelFeatures)
+        return;
+
+    kernelChannels = numChannels;
+    kernelFeatures = features;
+    dynamicsKernel = selectDynamicsKernel(numChannels, features);
 }
@@ -1,5 +1,18 @@
 #pragma once
 #include <juce_dsp/juce_dsp.h>
+#include <array>
+#include <atomic>
+#include <utility>
+#include "EarlyReflections.h"
+#include "ReverbTail.h"
+#include "VelvetTail.h"
+#include "TailResampler.h"
+#include "PreDelay.h"
+#include "WarpChorus.h"
+#include "LaneFilters.h"
+#include "OutputLimiter.h"
+#include "QualityController.h"
+#include "DSPKernels.h"
 
 struct ReverbParameters
 {
@@ -13,12 +26,9 @@ struct ReverbParameters
     float modDepth = 50.0f;
     int mode = 0;
 
-    // Dynamic EQ
-    float dynFreq = 1000.0f;
-    float dynQ = 1.0f;
-    float dynGain = 0.0f;
-    float dynDepth = 0.0f;
-    float dynThresh = -20.0f;
+    // Dynamic EQ, the first dynBandCount bands are used
+    std::array<MultiBandDynamicEq::Band, MultiBandDynamicEq::maxBands> dynBands { { { 1000.0f }, { 300.0f }, { 3000.0f }, { 8000.0f } } };
+    int dynBandCount = 1;
 
     // New Features
     float ducking = 0.0f;
@@ -32,50 +42,320 @@ struct ReverbParameters
     float msBalance = 50.0f;
     bool limiterOn = true;
     double bpm = 120.0;
+
+    // Late tail rate: 0 full, 1 half, 2 quarter, 3 auto (closest to 48 kHz)
+    int eco = 0;
+
+    // Late tail: 0 Freeverb, 1 velvet noise
+    int engine = 0;
+
+    // IDs of the dynamic EQ band settings by band, in dynBandSettings order. Constant, so the
+    // audio thread never builds them.
+    static constexpr int numDynBandSettings = 5;
+    static constexpr const char* dynBandSettings[numDynBandSettings] = { "FREQ", "Q", "GAIN", "DEPTH", "THRESH" };
+    static constexpr const char* dynBandParameterIDs[MultiBandDynamicEq::maxBands][numDynBandSettings] =
+    {
+        { "DYNFREQ",  "DYNQ",  "DYNGAIN",  "DYNDEPTH",  "DYNTHRESH" },
+        { "DYN2FREQ", "DYN2Q", "DYN2GAIN", "DYN2DEPTH", "DYN2THRESH" },
+        { "DYN3FREQ", "DYN3Q", "DYN3GAIN", "DYN3DEPTH", "DYN3THRESH" },
+        { "DYN4FREQ", "DYN4Q", "DYN4GAIN", "DYN4DEPTH", "DYN4THRESH" }
+    };
+    static_assert(MultiBandDynamicEq::maxBands == 4, "one row of IDs per band");
+
+    // ID of a dynamic EQ band setting, e.g. "DYNFREQ" for the first band, "DYN2FREQ" for the second
+    static juce::String getDynBandParameterID(int band, const juce::String& setting)
+    {
+        for (int s = 0; s < numDynBandSettings; ++s)
+            if (setting == dynBandSettings[s])
+                return dynBandParameterIDs[band][s];
+
+        jassertfalse;
+        return {};
+    }
+
+    // From plugin parameter values by ID, as the plugin's parameters and presets hold them.
+    // getValue (juce::StringRef id, float fallback) returns the value, or fallback, the one in
+    // params, if there is none. The IDs are asked for in the same order on every call, and
+    // none is built on the fly. The tempo isn't a parameter and is kept.
+    template <typename GetValue>
+    static ReverbParameters fromParameterValues(GetValue&& getValue, ReverbParameters params = {});
 };
 
+template <typename GetValue>
+ReverbParameters ReverbParameters::fromParameterValues(GetValue&& getValue, ReverbParameters params)
+{
+    auto read = [&getValue](juce::StringRef id, float& value) { value = getValue(id, value); };
+    auto readInt = [&getValue](juce::StringRef id, int& value, int offset) { value = (int)getValue(id, (float)(value - offset)) + offset; };
+
+    read("MIX", params.mix);
+    read("WIDTH", params.width);
+    read("DELAY", params.delay);
+    read("WARP", params.warp);
+    read("FEEDBACK", params.feedback);
+    read("DENSITY", params.density);
+    read("MODRATE", params.modRate);
+    read("MODDEPTH", params.modDepth);
+
+    for (int b = 0; b < MultiBandDynamicEq::maxBands; ++b)
+    {
+        auto& band = params.dynBands[(size_t)b];
+        const auto& ids = dynBandParameterIDs[b];
+        read(ids[0], band.frequency);
+        read(ids[1], band.resonance);
+        read(ids[2], band.gain);
+        read(ids[3], band.depth);
+        read(ids[4], band.threshold);
+    }
+    readInt("DYNBANDS", params.dynBandCount, 1);
+
+    read("DUCKING", params.ducking);
+    readInt("PREDELAY_SYNC", params.preDelaySync, 0);
+    read("SATURATION", params.saturation);
+    read("DIFFUSION", params.diffusion);
+    read("GATE_THRESH", params.gateThresh);
+
+    read("EQ3_LOW", params.eq3Low);
+    read("EQ3_MID", params.eq3Mid);
+    read("EQ3_HIGH", params.eq3High);
+
+    read("MS_BALANCE", params.msBalance);
+    params.limiterOn = getValue("LIMITER", params.limiterOn ? 1.0f : 0.0f) > 0.5f;
+    readInt("ECO", params.eco, 0);
+    readInt("ENGINE", params.engine, 0);
+
+    readInt("MODE", params.mode, 0);
+    return params;
+}
+
 class ReverbProcessor
 {
 public:
     ReverbProcessor();
     ~ReverbProcessor();
 
+    static constexpr int defaultSubBlockSize = 32;
+
+    // The eco tail runs over spans of tailSpanSubBlocks * factor sub-blocks, on the same grid,
+    // so the resampler and the tail see whole sub-blocks of low-rate samples per call. Each
+    // sub-block hands its input to the current span and takes its output from the last one,
+    // which delays the tail by a span, taken out of the pre-delay like the resampler's delay.
+    static constexpr int tailSpanSubBlocks = 2;
+
+    // Internal processing granularity (power of two, e.g. 32 or 64). Call before prepare().
+    void setSubBlockSize(int numSamples);
+    int getSubBlockSize() const { return subBlockSize; }
+
+    // Lookahead of the output limiter, a few milliseconds at most. Call before prepare().
+    void setLimiterLookahead(float milliseconds);
+
+    // Sample format of the pre-delay and tail comb memory. Call before prepare().
+    void setDelayStorage(DelayStorage storage);
+    DelayStorage getDelayStorage() const { return delayStorage; }
+
     void prepare(const juce::dsp::ProcessSpec& spec);
     void process(juce::dsp::ProcessContextReplacing<float>& context);
     void reset();
 
+    // Click-free clear for the audio thread: the wet signal fades out, the reverb's memory is
+    // zeroed a slice per sub-block while it is muted, then it fades back in. reset() does the
+    // same work at once.
+    void clear() { clearRequested = true; }
+
     void setParameters(const ReverbParameters& params);
 
+    // Overrides the kernel variant picked for this CPU, e.g. to compare variants in tests
+    void setKernels(const DSPKernels& newKernels);
+    const DSPKernels& getKernels() const { return *kernels; }
+
+    // Delay of the whole output, from the limiter's lookahead. Fixed from prepare() on.
+    int getLatencySamples() const { return limiter.getLatencySamples(); }
+
+    // Longest an input sample can take to start coming out of the wet path, the latency
+    // included: the pre-delay, the eco tail's delay and the last early reflection. Silence out
+    // before then doesn't mean the tail is over.
+    int getWetArrivalSamples() const;
+
+    // Bytes of delay memory taken by the pre-delay, early reflections, chorus and tail
+    size_t getDelayMemoryBytes() const { return delayArena.getBytes(); }
+
+    // Rate divisor of the late tail for an eco setting
+    static int getEcoFactor(int eco, double sampleRate);
+
+    // Realtime playback, or the heavier settings used for offline renders: oversampled
+    // saturation, a second bank of tail combs, double-precision comb filtering, and gain
+    // parameters ramped per sample instead of stepped per sub-block
+    enum class Quality { realtime, offline };
+
+    // Picked up at the next sub-block boundary, the audible changes are crossfaded
+    void setQuality(Quality newQuality) { pendingQuality = newQuality; }
+    Quality getQuality() const { return quality; }
+
+    // Load shedding tier from a QualityController, picked up at the next sub-block boundary.
+    // The tail's lines fade, a change of its rate happens under a short fade of the wet signal.
+    void setQualityTier(int newTier) { pendingQualityTier = newTier; }
+    int getQualityTier() const { return qualityTier; }
+
+    // Times the wet chain was muted and cleared after a NaN, an infinity or a runaway level
+    // in the tail, or a NaN or infinity in the output. Readable from any thread.
+    int getRecoveryCount() const { return recoveryCount.load(std::memory_order_relaxed); }
+
 private:
-    juce::dsp::Reverb reverb;
-    juce::dsp::Reverb::Parameters reverbParams;
+    // Pre-instantiated processing kernels, picked when the stage configuration changes
+    using KernelFunction = void (ReverbProcessor::*)(juce::dsp::AudioBlock<float>&, const float*);
+
+    template <int NumChannels, int Features>
+    void processDynamics(juce::dsp::AudioBlock<float>& wetBlock, const float* dryInput);
+    void processMidSide(juce::dsp::AudioBlock<float>& wetBlock, const float* dryInput);
+
+    template <int NumChannels, size_t... Masks>
+    static std::array<KernelFunction, sizeof...(Masks)> makeDynamicsKernelRow(std::index_sequence<Masks...>);
+
+    enum DynamicsFeature
+    {
+        gateFeature    = 1 << 0,
+        dynEqFeature   = 1 << 1,
+        duckingFeature = 1 << 2,
+        dynamicsFeatureMasks = 1 << 3
+    };
+
+    static KernelFunction selectDynamicsKernel(int numChannels, int features);
+    void selectKernels(int numChannels);
+
+    void updateParameters();
+    void updateStageBypass();
+    void updateClear();
+    int getTailFactor() const;
+    void setTailFactor(int factor);
+    int getTailLatencySamples() const;
+    void resetTailSpan();
+    void applyQuality();
+    void saturate(juce::dsp::AudioBlock<float>& block, float drive, const float* amounts, int amountStep);
+    void saturateOversampled(juce::dsp::AudioBlock<float>& block, float drive, const float* amounts);
+    void processSubBlock(juce::dsp::AudioBlock<float> block);
+    void processTail(const juce::dsp::AudioBlock<float>& block);
+    void processReducedRateTail(const juce::dsp::AudioBlock<float>& block);
+    bool isOutOfRange(const juce::dsp::AudioBlock<float>& block, float limit) const;
+    void checkOutput(const juce::dsp::AudioBlock<float>& block);
+    void recover();
+    void processWet(juce::dsp::AudioBlock<float>& wetBlock, const float* dryInput);
+
+    // Skips a stage whose settings make it an identity. It is only skipped after staying
+    // neutral for holdSubBlocks, and comes back as soon as it isn't.
+    struct StageBypass
+    {
+        bool active = true;
+        int neutralCount = 0;
+
+        // Returns true on the sub-block where the stage starts being skipped
+        bool update(bool isNeutral, int holdSubBlocks)
+        {
+            if (! isNeutral)
+            {
+                neutralCount = 0;
+                active = true;
+                return false;
+            }
+
+            if (active && ++neutralCount >= holdSubBlocks)
+            {
+                active = false;
+                return true;
+            }
+
+            return false;
+        }
+    };
+
+    const DSPKernels* kernels = &DSPKernels::get();
 
-    juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::Linear> delayLine { 192000 };
-    juce::dsp::Chorus<float> chorus;
+    // The delay memory of every stage, laid out in the order the signal goes through them
+    DelayArena delayArena;
 
-    // Dynamic EQ
-    juce::dsp::StateVariableTPTFilter<float> dynEqFilter; // Bandpass for mixing
-    juce::dsp::StateVariableTPTFilter<float> detectorFilter; // Bandpass for detector
+    ReverbTail reverb;
+    VelvetTail velvet;
+    TailResampler tailResampler;
+    juce::AudioBuffer<float> lowRateBuffer;
+    juce::AudioBuffer<float> tailSpanInput, tailSpanOutput;
+    int tailSpanLength = 0, tailSpanPosition = 0;
 
-    // 3-Band EQ
-    juce::dsp::ProcessorChain<juce::dsp::IIR::Filter<float>, juce::dsp::IIR::Filter<float>, juce::dsp::IIR::Filter<float>> eq3Chain;
+    PreDelay preDelay;
+    EarlyReflections earlyReflections;
+    WarpChorus chorus;
+
+    // Dynamic EQ, detector and gain filters of every band in one pass
+    MultiBandDynamicEq dynEq;
+
+    // 3-Band EQ: low shelf, mid peak, high shelf
+    BiquadCascade eq3Filter;
 
     // Dynamics
-    juce::dsp::Limiter<float> limiter;
+    OutputLimiter limiter;
     // Simple Gate implementation variables
     float gateEnv = 0.0f;
 
     // Saturation
-    juce::dsp::WaveShaper<float> saturator;
+    juce::SmoothedValue<float> saturationMix { 1.0f };
+    std::unique_ptr<juce::dsp::Oversampling<float>> saturationOversampler;
+    juce::SmoothedValue<float> oversampledSaturation; // 0 plain, 1 oversampled
+    juce::AudioBuffer<float> saturationBuffer;
+    std::vector<float> saturationAmount;
+
+    DelayStorage delayStorage = DelayStorage::float32;
+
+    // Quality profile
+    Quality pendingQuality = Quality::realtime, quality = Quality::realtime;
+    int pendingQualityTier = QualityController::full, qualityTier = QualityController::full;
+    juce::SmoothedValue<float> wetMix, midGain, sideGain;
+    std::vector<float> gainRamp;
 
     double sampleRate = 44100.0;
 
+    ReverbParameters pendingParams;
     ReverbParameters currentParams;
 
     // Envelopes
     float duckEnv = 0.0f;
-    float dynEqEnv = 0.0f;
 
-    // Pre-allocated buffer for processing
+    float gateRel = 0.0f, duckAtt = 0.0f, duckRel = 0.0f;
+    float gateThreshLin = 0.0f, duckIntensity = 0.0f;
+
+    // Amortised clear, also used to switch the tail rate and engine under a fade. clearAfterFade
+    // zeroes the whole wet chain, clearTail only the tail that runs next.
+    enum class ClearState { idle, fadingOut, zeroing, fadingIn };
+    ClearState clearState = ClearState::idle;
+    bool clearRequested = false, clearAfterFade = false, clearTail = false;
+    juce::SmoothedValue<float> clearGain { 1.0f };
+    int clearStage = 0, clearBudget = 0;
+    int tailFactorTarget = 1;
+    int engine = 0;
+
+    // Health checks. The tail is far past full scale at runawayLimit, it never gets there
+    // unless its feedback has gone unstable.
+    static constexpr float runawayLimit = 1000.0f;
+    std::atomic<int> recoveryCount { 0 };
+
+    // Anti-denormal floor: noise added to the wet chain, DC to the envelopes
+    static constexpr float antiDenormalDc = 1.0e-18f;
+    std::vector<float> antiDenormalNoise;
+
+    // Stage elision
+    StageBypass saturationStage, gateStage, dynEqStage, duckingStage, eq3Stage, msStage, wetStage;
+    int bypassHoldSubBlocks = 1;
+
+    KernelFunction dynamicsKernel = nullptr;
+    KernelFunction msKernel = nullptr;
+    int kernelChannels = -1, kernelFeatures = -1;
+
+    float appliedEq3Low = 0.0f, appliedEq3Mid = 0.0f, appliedEq3High = 0.0f;
+    bool eq3CoefficientsDirty = true;
+
+    // Sub-block scheduling
+    int subBlockSize = defaultSubBlockSize;
+    int subBlockPhase = 0;
+
+    // Pre-allocated buffer for processing, one sub-block long
     juce::AudioBuffer<float> wetBuffer;
+    std::vector<float> detectorLevel;
+    std::vector<const float*> detectorChannels;
+    std::vector<float> gateGain, duckGain;
 };
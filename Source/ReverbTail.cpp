@@ -0,0 +1,526 @@
+#include "ReverbTail.h"
+
+namespace
+{
+    // Freeverb tunings at 44.1 kHz, as used by juce::dsp::Reverb
+    const int combTunings[ReverbTail::maxCombs] = { 1116, 1188, 1277, 1356, 1422, 1491, 1557, 1617,
+                                                    // Offline extra bank, interleaved with the Freeverb set
+                                                    1051, 1139, 1213, 1319, 1399, 1459, 1531, 1601 };
+    const int allPassTunings[ReverbTail::numAllPasses] = { 556, 441, 341, 225 };
+    const int stereoSpread = 23;
+
+    bool isFrozen(float freezeMode) { return freezeMode >= 0.5f; }
+}
+
+void ReverbTail::setKernels(const DSPKernels& newKernels)
+{
+    kernels = &newKernels;
+
+    for (int i = 0; i < numLines; ++i)
+        getLine(i).memory.setKernels(newKernels);
+}
+
+void ReverbTail::prepare(const juce::dsp::ProcessSpec& spec, DelayArena& arena)
+{
+    maxBlockSize = (int)spec.maximumBlockSize;
+    preparedRate = spec.sampleRate;
+
+    // Sized for the full rate, setProcessingRate() only ever uses less
+    auto intSampleRate = (int)spec.sampleRate;
+
+    // A fixed int16 floor would go round the feedback loop with the signal and build up,
+    // the combs keep 16 bits as half floats instead
+    const auto combStorage = storage == DelayStorage::int16 ? DelayStorage::float16 : storage;
+
+    // In the order process() runs them. The lines keep their exact lengths rather than a power
+    // of two: they are read and written in place at one index, a single forward stream each.
+    for (int ch = 0; ch < 2; ++ch)
+        for (int i = 0; i < maxCombs; ++i)
+            combs[ch][i].memory.reserve(arena, combStorage, (intSampleRate * (combTunings[i] + stereoSpread * ch)) / 44100);
+
+    for (int ch = 0; ch < 2; ++ch)
+        for (int i = 0; i < numAllPasses; ++i)
+            allPasses[ch][i].memory.reserve(arena, DelayStorage::float32, (intSampleRate * (allPassTunings[i] + stereoSpread * ch)) / 44100);
+
+    lines.assign((size_t)(maxBlockSize * numCombs), 0.0f);
+    column.assign((size_t)maxBlockSize, 0.0f);
+    input.assign((size_t)maxBlockSize, 0.0f);
+    for (auto& out : combOutput)
+        out.assign((size_t)maxBlockSize, 0.0f);
+    for (auto& out : upperOutput)
+        out.assign((size_t)maxBlockSize, 0.0f);
+    for (auto& out : extraOutput)
+        out.assign((size_t)maxBlockSize, 0.0f);
+
+    setProcessingRate(spec.sampleRate);
+}
+
+void ReverbTail::setProcessingRate(double newRate)
+{
+    jassert(newRate <= preparedRate);
+    processingRate = newRate;
+    auto intSampleRate = (int)newRate;
+
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        for (int i = 0; i < maxCombs; ++i)
+            combs[ch][i].memory.setLength((intSampleRate * (combTunings[i] + stereoSpread * ch)) / 44100);
+
+        for (int i = 0; i < numAllPasses; ++i)
+            allPasses[ch][i].memory.setLength((intSampleRate * (allPassTunings[i] + stereoSpread * ch)) / 44100);
+    }
+
+    // The comb bank reads a whole block before writing it back
+    jassert(maxBlockSize <= combs[0][numCombs].memory.getLength());
+
+    const double smoothTime = 0.01;
+    rampLength = (int)std::floor(smoothTime * newRate);
+    dryGain.reset(newRate, smoothTime);
+    wetGain1.reset(newRate, smoothTime);
+    wetGain2.reset(newRate, smoothTime);
+    extraLinesGain.reset(newRate, 0.05);
+    upperLinesGain.reset(newRate, 0.05);
+
+    setParameters(parameters);
+    damping = dampingTarget;
+    feedback = feedbackTarget;
+    rampRemaining = 0;
+
+    // The memory keeps what it held, which is noise at the new tuning until it is cleared
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        for (auto& comb : combs[ch])
+            comb.index = 0;
+
+        for (auto& allPass : allPasses[ch])
+            allPass.index = 0;
+
+        std::fill(std::begin(combFilterState[ch]), std::end(combFilterState[ch]), 0.0f);
+    }
+
+    clearLine = 0;
+    clearPosition = 0;
+    releasedPosition = 0;
+}
+
+void ReverbTail::reset()
+{
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        for (auto& comb : combs[ch])
+        {
+            comb.memory.clear();
+            comb.index = 0;
+        }
+
+        for (auto& allPass : allPasses[ch])
+        {
+            allPass.memory.clear();
+            allPass.index = 0;
+        }
+
+        std::fill(std::begin(combFilterState[ch]), std::end(combFilterState[ch]), 0.0f);
+    }
+
+    clearLine = 0;
+    clearPosition = 0;
+    releasedCombs = 0;
+    releasedPosition = 0;
+}
+
+ReverbTail::Line& ReverbTail::getLine(int index)
+{
+    // Both channels' combs, then their allpasses
+    if (index < 2 * maxCombs)
+        return combs[index / maxCombs][index % maxCombs];
+
+    index -= 2 * maxCombs;
+    return allPasses[index / numAllPasses][index % numAllPasses];
+}
+
+int ReverbTail::clearSome(int maxSamples)
+{
+    int cleared = 0;
+
+    while (cleared < maxSamples && clearLine < numLines)
+    {
+        auto& line = getLine(clearLine);
+        const auto size = (size_t)line.memory.getLength();
+        auto count = juce::jmin((size_t)(maxSamples - cleared), size - clearPosition);
+
+        line.memory.clear((int)clearPosition, (int)count);
+        clearPosition += count;
+        cleared += (int)count;
+
+        if (clearPosition == size)
+        {
+            line.index = 0;
+            ++clearLine;
+            clearPosition = 0;
+        }
+    }
+
+    if (cleared < maxSamples)
+    {
+        for (auto& state : combFilterState)
+            std::fill(std::begin(state), std::end(state), 0.0f);
+
+        clearLine = 0;
+        releasedCombs = 0;
+        releasedPosition = 0;
+    }
+
+    return cleared;
+}
+
+void ReverbTail::setParameters(const Parameters& newParams)
+{
+    const float wetScaleFactor = 3.0f;
+    const float dryScaleFactor = 2.0f;
+
+    const float wet = newParams.wetLevel * wetScaleFactor;
+    dryGain.setTargetValue(newParams.dryLevel * dryScaleFactor);
+    wetGain1.setTargetValue(0.5f * wet * (1.0f + newParams.width));
+    wetGain2.setTargetValue(0.5f * wet * (1.0f - newParams.width));
+
+    gain = isFrozen(newParams.freezeMode) ? 0.0f : 0.015f;
+    parameters = newParams;
+
+    auto newDamping = isFrozen(parameters.freezeMode) ? 0.0f : parameters.damping * 0.4f;
+    auto newFeedback = isFrozen(parameters.freezeMode) ? 1.0f : parameters.roomSize * 0.28f + 0.7f;
+
+    if (newDamping != dampingTarget || newFeedback != feedbackTarget)
+    {
+        dampingTarget = newDamping;
+        feedbackTarget = newFeedback;
+        rampRemaining = rampLength;
+
+        if (rampRemaining > 0)
+        {
+            dampingStep = (dampingTarget - damping) / (float)rampRemaining;
+            feedbackStep = (feedbackTarget - feedback) / (float)rampRemaining;
+        }
+        else
+        {
+            damping = dampingTarget;
+            feedback = feedbackTarget;
+        }
+    }
+}
+
+void ReverbTail::setExtraLines(bool shouldUseExtraLines)
+{
+    extraLinesGain.setTargetValue(shouldUseExtraLines ? 1.0f : 0.0f);
+
+    // The extra bank starts from silence and builds up while it fades in
+    if (shouldUseExtraLines)
+    {
+        restoreCombs(numCombs, numCombs);
+        extraLinesRunning = true;
+    }
+}
+
+void ReverbTail::setReducedLines(bool shouldReduceLines)
+{
+    upperLinesGain.setTargetValue(shouldReduceLines ? 0.0f : 1.0f);
+
+    if (! shouldReduceLines)
+    {
+        restoreCombs(numCombs / 2, numCombs / 2);
+        upperLinesRunning = true;
+    }
+}
+
+void ReverbTail::readCombs(int channel, int firstLine, int lineCount, int numSamples)
+{
+    // Gather the next numSamples of lineCount combs into interleaved rows
+    for (int k = 0; k < lineCount; ++k)
+    {
+        auto& comb = combs[channel][firstLine + k];
+        comb.memory.read(column.data(), comb.index, numSamples);
+
+        for (int t = 0; t < numSamples; ++t)
+            lines[(size_t)(t * lineCount + k)] = column[(size_t)t];
+    }
+}
+
+void ReverbTail::writeCombs(int channel, int firstLine, int lineCount, int numSamples)
+{
+    for (int k = 0; k < lineCount; ++k)
+    {
+        auto& comb = combs[channel][firstLine + k];
+
+        for (int t = 0; t < numSamples; ++t)
+            column[(size_t)t] = lines[(size_t)(t * lineCount + k)];
+
+        comb.memory.write(column.data(), comb.index, numSamples);
+        comb.index = (comb.index + numSamples) % comb.memory.getLength();
+    }
+}
+
+void ReverbTail::processCombs(int numChannels, int offset, int numSamples, float dampStep, float fbStep)
+{
+    auto combBank = preciseAccumulation ? kernels->combBankPrecise : kernels->combBank;
+
+    auto runLines = [&](int channel, int firstLine, int lineCount, float* output)
+    {
+        readCombs(channel, firstLine, lineCount, numSamples);
+        combBank(lines.data(), input.data() + offset, output + offset, combFilterState[channel] + firstLine,
+                 lineCount, numSamples, damping, dampStep, feedback, fbStep);
+        writeCombs(channel, firstLine, lineCount, numSamples);
+    };
+
+    // The main bank in one go, or its halves apart while the upper one fades
+    const bool allLines = upperLinesRunning && ! upperLinesGain.isSmoothing();
+    constexpr int halfCombs = numCombs / 2;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        if (allLines)
+        {
+            runLines(ch, 0, numCombs, combOutput[ch].data());
+        }
+        else
+        {
+            runLines(ch, 0, halfCombs, combOutput[ch].data());
+            if (upperLinesRunning)
+                runLines(ch, halfCombs, halfCombs, upperOutput[ch].data());
+        }
+
+        if (extraLinesRunning)
+            runLines(ch, numCombs, numCombs, extraOutput[ch].data());
+    }
+
+    if (rampRemaining > 0)
+    {
+        // Same accumulation as the kernel, snapped to the target once the ramp is over
+        for (int i = 0; i < numSamples; ++i)
+        {
+            damping += dampStep;
+            feedback += fbStep;
+        }
+
+        rampRemaining -= numSamples;
+        if (rampRemaining == 0)
+        {
+            damping = dampingTarget;
+            feedback = feedbackTarget;
+        }
+    }
+}
+
+void ReverbTail::mixUpperLines(int numChannels, int numSamples)
+{
+    // Lower + gain * upper, normalised so the level holds with half the combs
+    const bool smoothing = upperLinesGain.isSmoothing();
+
+    if (upperLinesRunning)
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float upperGain = upperLinesGain.getNextValue();
+            const float norm = std::sqrt(2.0f / (1.0f + upperGain * upperGain));
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                combOutput[ch][(size_t)i] = (combOutput[ch][(size_t)i] + upperGain * upperOutput[ch][(size_t)i]) * norm;
+        }
+    }
+    else
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+            juce::FloatVectorOperations::multiply(combOutput[ch].data(), juce::MathConstants<float>::sqrt2, numSamples);
+    }
+
+    // Faded out: stop running the upper half and clear it for next time
+    if (smoothing && upperLinesGain.getCurrentValue() == 0.0f && ! upperLinesGain.isSmoothing())
+    {
+        upperLinesRunning = false;
+        releaseCombs(numCombs / 2, numCombs / 2);
+    }
+}
+
+void ReverbTail::releaseCombs(int firstLine, int lineCount)
+{
+    // Their memory is zeroed a little per block by clearReleasedCombs()
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        for (int k = firstLine; k < firstLine + lineCount; ++k)
+        {
+            releasedCombs |= 1u << (ch * maxCombs + k);
+            combs[ch][k].index = 0;
+            combFilterState[ch][k] = 0.0f;
+        }
+    }
+}
+
+void ReverbTail::restoreCombs(int firstLine, int lineCount)
+{
+    // Back before their memory was cleared: the rest of it in one go, they start from silence
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        for (int k = firstLine; k < firstLine + lineCount; ++k)
+        {
+            const auto line = ch * maxCombs + k;
+            if ((releasedCombs & (1u << line)) == 0)
+                continue;
+
+            combs[ch][k].memory.clear();
+            releasedCombs &= ~(1u << line);
+            if (releasedLine == line)
+                releasedPosition = 0;
+        }
+    }
+}
+
+void ReverbTail::clearReleasedCombs(int maxSamples)
+{
+    int cleared = 0;
+
+    // Both channels' combs in getLine() order, the ones not released skipped
+    while (releasedCombs != 0 && cleared < maxSamples)
+    {
+        if ((releasedCombs & (1u << releasedLine)) == 0)
+        {
+            releasedLine = (releasedLine + 1) % (2 * maxCombs);
+            releasedPosition = 0;
+            continue;
+        }
+
+        auto& line = getLine(releasedLine);
+        const auto size = (size_t)line.memory.getLength();
+        auto count = juce::jmin((size_t)(maxSamples - cleared), size - releasedPosition);
+
+        line.memory.clear((int)releasedPosition, (int)count);
+        releasedPosition += count;
+        cleared += (int)count;
+
+        if (releasedPosition == size)
+        {
+            releasedCombs &= ~(1u << releasedLine);
+            releasedLine = (releasedLine + 1) % (2 * maxCombs);
+            releasedPosition = 0;
+        }
+    }
+}
+
+void ReverbTail::mixExtraLines(int numChannels, int numSamples)
+{
+    // Main + gain * extra, normalised so the level holds as the extra bank fades
+    float extraGain = extraLinesGain.getCurrentValue();
+    float norm = 1.0f / std::sqrt(1.0f + extraGain * extraGain);
+    const bool smoothing = extraLinesGain.isSmoothing();
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        if (smoothing)
+        {
+            extraGain = extraLinesGain.getNextValue();
+            norm = 1.0f / std::sqrt(1.0f + extraGain * extraGain);
+        }
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            combOutput[ch][(size_t)i] = (combOutput[ch][(size_t)i] + extraGain * extraOutput[ch][(size_t)i]) * norm;
+    }
+
+    // Faded out: stop running the extra bank and clear it for next time
+    if (extraLinesGain.getCurrentValue() == 0.0f && ! extraLinesGain.isSmoothing())
+    {
+        extraLinesRunning = false;
+        releaseCombs(numCombs, numCombs);
+    }
+}
+
+void ReverbTail::processAllPasses(int channel, float* samples, int numSamples)
+{
+    // One allpass after the other over the block, in spans that end at the end of the line:
+    // no wrap test per sample, and no sample written in a span is read back in it
+    for (auto& allPass : allPasses[channel])
+    {
+        auto* buffer = allPass.memory.getFloats();
+        const auto length = allPass.memory.getLength();
+
+        for (int done = 0; done < numSamples;)
+        {
+            const auto count = juce::jmin(numSamples - done, length - allPass.index);
+            auto* delayed = buffer + allPass.index;
+            auto* x = samples + done;
+
+            for (int i = 0; i < count; ++i)
+            {
+                const auto bufferedValue = delayed[i];
+                delayed[i] = x[i] + (bufferedValue * 0.5f);
+                x[i] = bufferedValue - x[i];
+            }
+
+            allPass.index += count;
+            if (allPass.index == length) allPass.index = 0;
+            done += count;
+        }
+    }
+}
+
+void ReverbTail::process(const juce::dsp::AudioBlock<float>& block)
+{
+    const auto numSamples = (int)block.getNumSamples();
+    const auto numChannels = juce::jmin(2, (int)block.getNumChannels());
+    jassert(numSamples <= maxBlockSize);
+
+    if (numSamples == 0 || numChannels == 0)
+        return;
+
+    auto* left = block.getChannelPointer(0);
+    auto* right = numChannels > 1 ? block.getChannelPointer(1) : nullptr;
+
+    for (int i = 0; i < numSamples; ++i)
+        input[(size_t)i] = (right != nullptr ? left[i] + right[i] : left[i]) * gain;
+
+    // Combs run in at most two spans, the rest of the damping/feedback ramp and the steady part
+    int offset = 0;
+    if (rampRemaining > 0)
+    {
+        auto len = std::min(numSamples, rampRemaining);
+        processCombs(numChannels, 0, len, dampingStep, feedbackStep);
+        offset = len;
+    }
+
+    if (offset < numSamples)
+        processCombs(numChannels, offset, numSamples - offset, 0.0f, 0.0f);
+
+    if (! upperLinesRunning || upperLinesGain.isSmoothing())
+        mixUpperLines(numChannels, numSamples);
+
+    if (extraLinesRunning)
+        mixExtraLines(numChannels, numSamples);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+        processAllPasses(ch, combOutput[ch].data(), numSamples);
+
+    if (releasedCombs != 0)
+        clearReleasedCombs(numSamples * releasedClearPerSample);
+
+    const bool smoothing = dryGain.isSmoothing() || wetGain1.isSmoothing() || wetGain2.isSmoothing();
+    float dry = dryGain.getCurrentValue(), wet1 = wetGain1.getCurrentValue(), wet2 = wetGain2.getCurrentValue();
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        if (smoothing)
+        {
+            dry = dryGain.getNextValue();
+            wet1 = wetGain1.getNextValue();
+            wet2 = wetGain2.getNextValue();
+        }
+
+        if (right != nullptr)
+        {
+            const float outL = combOutput[0][(size_t)i];
+            const float outR = combOutput[1][(size_t)i];
+            const float l = left[i], r = right[i];
+            left[i] = outL * wet1 + outR * wet2 + l * dry;
+            right[i] = outR * wet1 + outL * wet2 + r * dry;
+        }
+        else
+        {
+            left[i] = combOutput[0][(size_t)i] * wet1 + left[i] * dry;
+        }
+    }
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include <juce_dsp/juce_dsp.h>
+#include "DelayMemory.h"
+
+// Freeverb late tail with the same tunings and parameter mapping as juce::dsp::Reverb.
+// The comb bank runs block-wise through DSPKernels, so it follows the ISA picked at runtime.
+class ReverbTail
+{
+public:
+    static constexpr int numCombs = 8;
+    static constexpr int maxCombs = 2 * numCombs;
+    static constexpr int numAllPasses = 4;
+
+    using Parameters = juce::dsp::Reverb::Parameters;
+
+    void setKernels(const DSPKernels& newKernels);
+
+    // Sample format of the comb lines, takes effect on the next prepare(). int16 is stored as
+    // float16, which keeps its noise under the recirculating signal. The allpasses are short
+    // and run in place, they stay float.
+    void setStorage(DelayStorage newStorage) { storage = newStorage; }
+
+    // The lines are reserved in the arena, and usable once it is allocated
+    void prepare(const juce::dsp::ProcessSpec& spec, DelayArena& arena);
+    void reset();
+
+    // Zeroes up to maxSamples more of the delay lines in use, carrying on where the last call
+    // stopped. Returns how many were zeroed, fewer than maxSamples once the tail is clear.
+    int clearSome(int maxSamples);
+
+    // Re-tunes the delays for a lower internal rate, within the memory allocated by prepare().
+    // Doesn't touch the memory, which has to be cleared with clearSome() or reset() before
+    // the tail runs again.
+    void setProcessingRate(double newRate);
+
+    void setParameters(const Parameters& newParams);
+
+    // Offline quality: a second bank of eight combs, faded in or out over 50 ms,
+    // and comb filtering accumulated in double precision
+    void setExtraLines(bool shouldUseExtraLines);
+    void setPreciseAccumulation(bool shouldBePrecise) { preciseAccumulation = shouldBePrecise; }
+
+    // Load shedding: only the first half of the Freeverb combs, the others faded out over
+    // 50 ms. They start from silence when they come back.
+    void setReducedLines(bool shouldReduceLines);
+
+    // Mono or stereo, in place. Blocks must not exceed the prepared maximum block size.
+    void process(const juce::dsp::AudioBlock<float>& block);
+
+private:
+    struct Line
+    {
+        DelayMemory memory;
+        int index = 0;
+    };
+
+    Line& getLine(int index);
+    void readCombs(int channel, int firstLine, int lineCount, int numSamples);
+    void writeCombs(int channel, int firstLine, int lineCount, int numSamples);
+    void mixUpperLines(int numChannels, int numSamples);
+    void mixExtraLines(int numChannels, int numSamples);
+    void releaseCombs(int firstLine, int lineCount);
+    void restoreCombs(int firstLine, int lineCount);
+    void clearReleasedCombs(int maxSamples);
+    void processAllPasses(int channel, float* samples, int numSamples);
+    void processCombs(int numChannels, int offset, int numSamples, float dampStep, float fbStep);
+
+    const DSPKernels* kernels = &DSPKernels::get();
+    DelayStorage storage = DelayStorage::float32;
+
+    Parameters parameters;
+    float gain = 0.015f;
+    juce::SmoothedValue<float> dryGain, wetGain1, wetGain2;
+
+    // Damping and feedback share one linear ramp, advanced by the comb kernel itself so
+    // the result doesn't depend on how the input is split into blocks
+    float damping = 0.0f, feedback = 0.0f;
+    float dampingTarget = 0.0f, feedbackTarget = 0.0f;
+    float dampingStep = 0.0f, feedbackStep = 0.0f;
+    int rampLength = 0, rampRemaining = 0;
+
+    Line combs[2][maxCombs];
+    Line allPasses[2][numAllPasses];
+    float combFilterState[2][maxCombs] = {};
+
+    // Progress of clearSome(), through getLine() order
+    static constexpr int numLines = 2 * (maxCombs + numAllPasses);
+    int clearLine = 0;
+    size_t clearPosition = 0;
+
+    // Combs faded out by load shedding or the extra bank, one bit per getLine() index. Their
+    // memory is zeroed a few samples per sample processed, rather than all in one block.
+    static constexpr int releasedClearPerSample = 16;
+    uint32_t releasedCombs = 0;
+    int releasedLine = 0;
+    size_t releasedPosition = 0;
+
+    juce::SmoothedValue<float> extraLinesGain, upperLinesGain { 1.0f };
+    bool extraLinesRunning = false, upperLinesRunning = true;
+    bool preciseAccumulation = false;
+
+    // Block scratch: interleaved comb rows of one bank, one comb's samples, the mono input and
+    // each channel's sum for the main bank, the upper half of it while it fades, and the extra bank
+    std::vector<float> lines, column, input, combOutput[2], upperOutput[2], extraOutput[2];
+    int maxBlockSize = 0;
+    double preparedRate = 44100.0, processingRate = 44100.0;
+};
@@ -0,0 +1,270 @@
+#include "TailResampler.h"
+
+template <int Pairs>
+void TailResampler::HalfBand<Pairs>::design()
+{
+    // Blackman-windowed half-band sinc, only the odd offsets from the centre are nonzero
+    float sum = 0.0f;
+    for (int j = 0; j < Pairs; ++j)
+    {
+        const double offset = 2 * j + 1;
+        const double x = juce::MathConstants<double>::pi * offset * 0.5;
+        const double n = (double)(centre + (int)offset) / (double)(numTaps + 1);
+        const double window = 0.42 - 0.5 * std::cos(2.0 * juce::MathConstants<double>::pi * n)
+                                   + 0.08 * std::cos(4.0 * juce::MathConstants<double>::pi * n);
+        coeffs[j] = (float)(0.5 * std::sin(x) / x * window);
+        sum += coeffs[j];
+    }
+
+    // Unity gain at DC: the centre tap is 0.5, each pair adds 2 * coeffs[j]
+    for (auto& c : coeffs)
+        c *= 0.25f / sum;
+}
+
+//==============================================================================
+template <int Pairs>
+void TailResampler::Decimator<Pairs>::prepare(int maxInput)
+{
+    oddPhase.assign((size_t)(oddHistory + maxInput / 2 + 1), 0.0f);
+    evenPhase.assign((size_t)(evenHistory + maxInput / 2 + 1), 0.0f);
+    reset();
+}
+
+template <int Pairs>
+void TailResampler::Decimator<Pairs>::reset()
+{
+    std::fill(oddPhase.begin(), oddPhase.end(), 0.0f);
+    std::fill(evenPhase.begin(), evenPhase.end(), 0.0f);
+    pendingSample = 0.0f;
+    hasPending = false;
+}
+
+template <int Pairs>
+int TailResampler::Decimator<Pairs>::process(const float* in, int numSamples, float* out, const HalfBand<Pairs>& filter)
+{
+    float* odd = oddPhase.data();
+    float* even = evenPhase.data();
+
+    // Split complete pairs into the two phases, after the history each one keeps
+    int count = 0, i = 0;
+    if (hasPending && numSamples > 0)
+    {
+        even[evenHistory] = pendingSample;
+        odd[oddHistory] = in[0];
+        count = 1;
+        i = 1;
+        hasPending = false;
+    }
+
+    for (; i + 1 < numSamples; i += 2, ++count)
+    {
+        even[evenHistory + count] = in[i];
+        odd[oddHistory + count] = in[i + 1];
+    }
+
+    if (i < numSamples)
+    {
+        pendingSample = in[i];
+        hasPending = true;
+    }
+
+    // y[m] = 0.5 * even[m - Pairs + 1] + sum of c[j] * (odd[m - Pairs + 1 + j] + odd[m - Pairs - j]).
+    // The taps are unrolled inside the loop over outputs, which vectorises across outputs,
+    // so each output is summed in registers in one pass.
+    for (int m = 0; m < count; ++m)
+    {
+        float y = 0.5f * even[m];
+
+        for (int j = 0; j < Pairs; ++j)
+            y += filter.coeffs[j] * (odd[m + Pairs + j] + odd[m + Pairs - 1 - j]);
+
+        out[m] = y;
+    }
+
+    std::memmove(odd, odd + count, sizeof(float) * (size_t)oddHistory);
+    std::memmove(even, even + count, sizeof(float) * (size_t)evenHistory);
+    return count;
+}
+
+//==============================================================================
+template <int Pairs>
+void TailResampler::Interpolator<Pairs>::prepare(int maxInput)
+{
+    input.assign((size_t)(inputHistory + maxInput), 0.0f);
+    evenOutput.assign((size_t)maxInput, 0.0f);
+    reset();
+}
+
+template <int Pairs>
+void TailResampler::Interpolator<Pairs>::reset()
+{
+    std::fill(input.begin(), input.end(), 0.0f);
+}
+
+template <int Pairs>
+void TailResampler::Interpolator<Pairs>::process(const float* in, int numSamples, float* out, const HalfBand<Pairs>& filter)
+{
+    float* x = input.data();
+    float* even = evenOutput.data();
+    std::memcpy(x + inputHistory, in, sizeof(float) * (size_t)numSamples);
+
+    // One pass per output, as in the decimator, then interleaved with the centre tap's samples
+    for (int m = 0; m < numSamples; ++m)
+    {
+        float y = 0.0f;
+
+        for (int j = 0; j < Pairs; ++j)
+            y += filter.coeffs[j] * (x[m + Pairs + j] + x[m + Pairs - 1 - j]);
+
+        even[m] = y;
+    }
+
+    for (int m = 0; m < numSamples; ++m)
+    {
+        out[2 * m] = 2.0f * even[m];
+        out[2 * m + 1] = x[Pairs + m];
+    }
+
+    std::memmove(x, x + numSamples, sizeof(float) * (size_t)inputHistory);
+}
+
+//==============================================================================
+void TailResampler::prepare(int numChannels, int maxBlockSize)
+{
+    sharpFilter.design();
+    shortFilter.design();
+
+    const int maxMid = maxBlockSize / 2 + 1;
+    const int maxLow = maxMid / 2 + 1;
+
+    channels.resize((size_t)numChannels);
+    for (auto& channel : channels)
+    {
+        channel.shortDecimator.prepare(maxBlockSize);
+        channel.sharpDecimator.prepare(maxBlockSize);
+        channel.sharpInterpolator.prepare(maxMid);
+        channel.shortInterpolator.prepare(2 * maxLow);
+    }
+
+    midRate.assign((size_t)(2 * maxMid), 0.0f);
+    upsampled.assign((size_t)(maxBlockSize + 2 * maxFactor), 0.0f);
+
+    reset();
+}
+
+void TailResampler::reset()
+{
+    for (auto& channel : channels)
+    {
+        channel.shortDecimator.reset();
+        channel.sharpDecimator.reset();
+        channel.sharpInterpolator.reset();
+        channel.shortInterpolator.reset();
+
+        // Primed so there is always a sample to write out before the next low-rate one arrives
+        std::fill(std::begin(channel.carry), std::end(channel.carry), 0.0f);
+        channel.numCarry = factor - 1;
+    }
+}
+
+void TailResampler::setFactor(int newFactor)
+{
+    jassert(newFactor == 1 || newFactor == 2 || newFactor == maxFactor);
+
+    if (newFactor != factor)
+    {
+        factor = newFactor;
+        reset();
+    }
+}
+
+int TailResampler::getLatencySamples() const
+{
+    // Each stage delays by its centre tap, once down and once up, at its own rate
+    constexpr int sharpDelay = 2 * HalfBand<sharpPairs>::centre;
+    constexpr int shortDelay = 2 * HalfBand<shortPairs>::centre;
+
+    switch (factor)
+    {
+        case 2:  return sharpDelay;
+        case 4:  return shortDelay + 2 * sharpDelay;
+        default: return 0;
+    }
+}
+
+int TailResampler::decimate(const juce::dsp::AudioBlock<float>& block, const juce::dsp::AudioBlock<float>& low)
+{
+    const auto numSamples = (int)block.getNumSamples();
+    const auto numChannels = juce::jmin((int)block.getNumChannels(), (int)channels.size());
+    int numLow = 0;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto& channel = channels[(size_t)ch];
+        const auto* in = block.getChannelPointer((size_t)ch);
+        auto* out = low.getChannelPointer((size_t)ch);
+        int count = numSamples;
+
+        if (factor == 1)
+            std::memcpy(out, in, sizeof(float) * (size_t)numSamples);
+        else if (factor == 2)
+            count = channel.sharpDecimator.process(in, numSamples, out, sharpFilter);
+        else
+            count = channel.sharpDecimator.process(midRate.data(), channel.shortDecimator.process(in, numSamples, midRate.data(), shortFilter),
+                                                   out, sharpFilter);
+
+        // Every channel runs the same phase
+        jassert(ch == 0 || count == numLow);
+        numLow = count;
+    }
+
+    return numLow;
+}
+
+void TailResampler::interpolate(const juce::dsp::AudioBlock<float>& low, int numLowSamples, const juce::dsp::AudioBlock<float>& block)
+{
+    const auto numSamples = (int)block.getNumSamples();
+    const auto numChannels = juce::jmin((int)block.getNumChannels(), (int)channels.size());
+    const int numUp = numLowSamples * factor;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto& channel = channels[(size_t)ch];
+        const auto* in = low.getChannelPointer((size_t)ch);
+        const float* up = upsampled.data();
+
+        if (factor == 1)
+        {
+            up = in;
+        }
+        else if (factor == 2)
+        {
+            channel.sharpInterpolator.process(in, numLowSamples, upsampled.data(), sharpFilter);
+        }
+        else
+        {
+            channel.sharpInterpolator.process(in, numLowSamples, midRate.data(), sharpFilter);
+            channel.shortInterpolator.process(midRate.data(), 2 * numLowSamples, upsampled.data(), shortFilter);
+        }
+
+        // Output is the carried samples followed by the new ones, the rest is carried over
+        const int numCarry = channel.numCarry;
+        const int leftover = numCarry + numUp - numSamples;
+        jassert(leftover >= 0 && leftover < factor);
+
+        float nextCarry[maxFactor];
+        for (int k = 0; k < leftover; ++k)
+        {
+            const int index = numSamples + k;
+            nextCarry[k] = index < numCarry ? channel.carry[index] : up[index - numCarry];
+        }
+
+        auto* out = block.getChannelPointer((size_t)ch);
+        const int fromCarry = juce::jmin(numCarry, numSamples);
+        std::memcpy(out, channel.carry, sizeof(float) * (size_t)fromCarry);
+        std::memcpy(out + fromCarry, up, sizeof(float) * (size_t)(numSamples - fromCarry));
+
+        std::memcpy(channel.carry, nextCarry, sizeof(float) * (size_t)leftover);
+        channel.numCarry = leftover;
+    }
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include <juce_dsp/juce_dsp.h>
+
+// Runs part of the wet chain at 1/2 or 1/4 of the host rate. Cascaded polyphase half-band
+// FIRs: decimate() brings a block down, interpolate() brings the processed block back up.
+// Both are streaming, so blocks of any length can be passed as long as every decimate()
+// is followed by an interpolate() of the same block.
+class TailResampler
+{
+public:
+    static constexpr int maxFactor = 4;
+
+    void prepare(int numChannels, int maxBlockSize);
+    void reset();
+
+    // 1, 2 or 4. Clears the filter state.
+    void setFactor(int newFactor);
+    int getFactor() const { return factor; }
+
+    // Delay added to the resampled path, in host-rate samples
+    int getLatencySamples() const;
+
+    // Returns the number of low-rate samples written to low, the same for every channel
+    int decimate(const juce::dsp::AudioBlock<float>& block, const juce::dsp::AudioBlock<float>& low);
+
+    // Consumes numLowSamples from low and fills block with the same number of samples decimate() took
+    void interpolate(const juce::dsp::AudioBlock<float>& low, int numLowSamples, const juce::dsp::AudioBlock<float>& block);
+
+private:
+    // Half-band FIR with Pairs nonzero taps on each side of the centre, 4 * Pairs - 1 long.
+    // The sharp filter sets the final band edge, the short one is only used for the first
+    // of two stages, where the transition band can be wide.
+    template <int Pairs>
+    struct HalfBand
+    {
+        static constexpr int numTaps = 4 * Pairs - 1;
+        static constexpr int centre = numTaps / 2;
+
+        float coeffs[(size_t)Pairs] = {};
+
+        void design();
+    };
+
+    static constexpr int sharpPairs = 8;
+    static constexpr int shortPairs = 3;
+
+    // Polyphase 2:1 decimator. Input pairs are split into their two phases so the side
+    // taps run over contiguous samples of one phase, and the centre tap reads the other.
+    template <int Pairs>
+    struct Decimator
+    {
+        static constexpr int oddHistory = 2 * Pairs - 1;
+        static constexpr int evenHistory = Pairs - 1;
+
+        std::vector<float> oddPhase, evenPhase;
+        float pendingSample = 0.0f;
+        bool hasPending = false;
+
+        void prepare(int maxInput);
+        void reset();
+
+        // Returns the number of samples written to out
+        int process(const float* in, int numSamples, float* out, const HalfBand<Pairs>& filter);
+    };
+
+    // Polyphase 1:2 interpolator, the side taps make the even outputs, the centre tap the odd ones
+    template <int Pairs>
+    struct Interpolator
+    {
+        static constexpr int inputHistory = 2 * Pairs - 1;
+
+        std::vector<float> input, evenOutput;
+
+        void prepare(int maxInput);
+        void reset();
+
+        // Writes 2 * numSamples samples to out
+        void process(const float* in, int numSamples, float* out, const HalfBand<Pairs>& filter);
+    };
+
+    struct Channel
+    {
+        Decimator<shortPairs> shortDecimator;
+        Decimator<sharpPairs> sharpDecimator;
+        Interpolator<sharpPairs> sharpInterpolator;
+        Interpolator<shortPairs> shortInterpolator;
+
+        // Interpolated samples left over from the previous block, fewer than the factor
+        float carry[maxFactor] = {};
+        int numCarry = 0;
+    };
+
+    HalfBand<sharpPairs> sharpFilter;
+    HalfBand<shortPairs> shortFilter;
+    std::vector<Channel> channels;
+
+    // Scratch for the intermediate rate of the 4:1 cascade, and the interpolated output
+    std::vector<float> midRate, upsampled;
+    int factor = 1;
+};
@@ -0,0 +1,361 @@
+#include "VelvetTail.h"
+#include <cmath>
+
+namespace
+{
+    // Line lengths at 44.1 kHz: the feedback lines, mutually prime and spread over the range of
+    // the Freeverb combs, then the input diffuser, 20 ms
+    const int lineTunings[VelvetTail::numLines + 1] = { 1129, 1291, 1451, 1621, 883 };
+
+    // The decay gain of a line is the Freeverb comb feedback raised to the line's length over
+    // the average comb's, so FEEDBACK gives the same decay time as with the Freeverb tail
+    const float averageCombTuning = 1378.0f;
+
+    // Seeds of the velvet-noise sequences: the diffuser's, then the output's
+    const juce::int64 tapSeeds[2] = { 0x5eed0, 0x5eed1 };
+
+    bool isFrozen(float freezeMode) { return freezeMode >= 0.5f; }
+}
+
+void VelvetTail::prepare(const juce::dsp::ProcessSpec& spec, DelayArena& arena)
+{
+    maxBlockSize = (int)spec.maximumBlockSize;
+    preparedRate = spec.sampleRate;
+
+    // A block and the sample after it, which the lowpass reads
+    mirrorLength = maxBlockSize + 1;
+
+    // Sized for the full rate, setProcessingRate() only ever uses less. The diffuser first, in
+    // the order process() runs them.
+    auto intSampleRate = (int)spec.sampleRate;
+    auto reserveLine = [&](int index)
+    {
+        lines[index].memory.reserve(arena, DelayStorage::float32, (intSampleRate * lineTunings[index]) / 44100 + mirrorLength);
+    };
+
+    reserveLine(diffuserLine);
+    for (int j = 0; j < numLines; ++j)
+        reserveLine(j);
+
+    input.assign((size_t)maxBlockSize, 0.0f);
+    for (auto& out : output)
+        out.assign((size_t)maxBlockSize, 0.0f);
+
+    setProcessingRate(spec.sampleRate);
+}
+
+void VelvetTail::setProcessingRate(double newRate)
+{
+    jassert(newRate <= preparedRate);
+    processingRate = newRate;
+    auto intSampleRate = (int)newRate;
+
+    for (int j = 0; j < numRings; ++j)
+    {
+        lines[j].length = (intSampleRate * lineTunings[j]) / 44100;
+        lines[j].memory.setLength(lines[j].length + mirrorLength);
+
+        // A block and the sample after it are read before the block is written back, and a
+        // block never reaches both the mirrored start and the end of a line
+        jassert(mirrorLength + maxBlockSize <= lines[j].length);
+    }
+
+    makeTaps(diffuserTaps, -1, tapSeeds[0]);
+    makeTaps(outputTaps, 0, tapSeeds[1]);
+
+    const double smoothTime = 0.01;
+    rampLength = juce::jmax(1, (int)std::floor(smoothTime * newRate) / rampInterval) * rampInterval;
+    dryGain.reset(newRate, smoothTime);
+    wetGain1.reset(newRate, smoothTime);
+    wetGain2.reset(newRate, smoothTime);
+
+    setParameters(parameters);
+    std::copy(std::begin(gainTargets), std::end(gainTargets), gains);
+    std::copy(std::begin(lowpassTargets), std::end(lowpassTargets), lowpassGains);
+    rampRemaining = 0;
+
+    // The memory keeps what it held, which is noise at the new tuning until it is cleared
+    for (auto& line : lines)
+        line.index = 0;
+
+    clearLine = 0;
+    clearPosition = 0;
+}
+
+void VelvetTail::makeTaps(Taps& taps, int channel, juce::int64 seed)
+{
+    // Velvet noise: one tap in each of numTaps equal slots, at a random place in it, half the
+    // slots picked at random to subtract. The diffuser's taps (channel -1) read its line, the
+    // output's cycle through the feedback lines. Every tap stays far enough behind the write
+    // head that a whole block of it has been written and none overwritten yet.
+    const auto& source = lines[channel < 0 ? diffuserLine : 0];
+    const auto slot = (source.length - maxBlockSize) / numTaps;
+
+    juce::Random random(seed);
+
+    bool negative[numTaps];
+    for (int k = 0; k < numTaps; ++k)
+        negative[k] = k >= tapsPerSign;
+
+    for (int k = numTaps - 1; k > 0; --k)
+        std::swap(negative[k], negative[random.nextInt(k + 1)]);
+
+    // The nth tap of a sign goes to the first half for even n, the second for odd
+    constexpr int half = tapsPerSign / 2;
+    auto place = [](int n) { return (n % 2) * half + n / 2; };
+    int numPositive = 0, numNegative = 0;
+
+    for (int k = 0; k < numTaps; ++k)
+    {
+        const auto index = negative[k] ? tapsPerSign + place(numNegative++) : place(numPositive++);
+        taps.line[index] = channel < 0 ? diffuserLine : (k + channel) % numLines;
+        taps.delay[index] = k * slot + random.nextInt(juce::jmax(1, slot));
+    }
+}
+
+void VelvetTail::reset()
+{
+    for (auto& line : lines)
+    {
+        line.memory.clear();
+        line.index = 0;
+    }
+
+    clearLine = 0;
+    clearPosition = 0;
+}
+
+int VelvetTail::clearSome(int maxSamples)
+{
+    int cleared = 0;
+
+    while (cleared < maxSamples && clearLine < numRings)
+    {
+        auto& line = lines[clearLine];
+        const auto size = line.memory.getLength();
+        auto count = juce::jmin(maxSamples - cleared, size - clearPosition);
+
+        line.memory.clear(clearPosition, count);
+        clearPosition += count;
+        cleared += count;
+
+        if (clearPosition == size)
+        {
+            line.index = 0;
+            ++clearLine;
+            clearPosition = 0;
+        }
+    }
+
+    if (cleared < maxSamples)
+        clearLine = 0;
+
+    return cleared;
+}
+
+void VelvetTail::setParameters(const Parameters& newParams)
+{
+    // Same dry/wet/width mapping as ReverbTail
+    const float wetScaleFactor = 3.0f;
+    const float dryScaleFactor = 2.0f;
+
+    const float wet = newParams.wetLevel * wetScaleFactor;
+    dryGain.setTargetValue(newParams.dryLevel * dryScaleFactor);
+    wetGain1.setTargetValue(0.5f * wet * (1.0f + newParams.width));
+    wetGain2.setTargetValue(0.5f * wet * (1.0f - newParams.width));
+
+    parameters = newParams;
+
+    // Level in line with the Freeverb tail
+    const bool frozen = isFrozen(parameters.freezeMode);
+    inputGain = frozen ? 0.0f : 0.026f;
+
+    const float lowpass = frozen ? 0.0f : parameters.damping * 0.4f;
+    const float feedback = frozen ? 1.0f : parameters.roomSize * 0.28f + 0.7f;
+
+    // Called every sub-block, the powers are only worked out again when these move
+    if (feedback == targetFeedback && lowpass == targetLowpass)
+        return;
+
+    targetFeedback = feedback;
+    targetLowpass = lowpass;
+    bool changed = false;
+
+    for (int j = 0; j < numLines; ++j)
+    {
+        const float decay = 0.5f * std::pow(feedback, (float)lineTunings[j] / averageCombTuning);
+        const float gain = decay * (1.0f - lowpass);
+        const float lowpassGain = decay * lowpass;
+
+        changed |= gain != gainTargets[j] || lowpassGain != lowpassTargets[j];
+        gainTargets[j] = gain;
+        lowpassTargets[j] = lowpassGain;
+    }
+
+    // A new ramp starts from wherever the last one got to
+    if (changed)
+    {
+        rampRemaining = rampLength;
+        const auto numSteps = (float)(rampLength / rampInterval);
+
+        for (int j = 0; j < numLines; ++j)
+        {
+            gainSteps[j] = (gainTargets[j] - gains[j]) / numSteps;
+            lowpassSteps[j] = (lowpassTargets[j] - lowpassGains[j]) / numSteps;
+        }
+    }
+}
+
+void VelvetTail::updateGains(int numSamples)
+{
+    if (rampRemaining == 0)
+        return;
+
+    // Worked out from the steps left rather than accumulated, so the value of each step
+    // doesn't depend on how the blocks before it were cut
+    const auto stepsLeft = (rampRemaining + rampInterval - 1) / rampInterval - 1;
+    rampRemaining -= numSamples;
+
+    for (int j = 0; j < numLines; ++j)
+    {
+        gains[j] = gainTargets[j] - gainSteps[j] * (float)stepsLeft;
+        lowpassGains[j] = lowpassTargets[j] - lowpassSteps[j] * (float)stepsLeft;
+    }
+}
+
+void VelvetTail::advance(Line& line, int numSamples)
+{
+    // Bring the ring and its mirror back in step after a block was written at the index
+    auto* ring = line.memory.getFloats();
+    const auto end = line.index + numSamples;
+
+    if (end > line.length)
+        std::copy(ring + line.length, ring + end, ring);
+    else if (line.index < mirrorLength)
+        std::copy(ring + line.index, ring + juce::jmin(end, mirrorLength), ring + line.length + line.index);
+
+    line.index = end >= line.length ? end - line.length : end;
+}
+
+void VelvetTail::getSpans(const Taps& taps, const float** spans, int numSamples)
+{
+    // The block just written ends at each line's index
+    for (int k = 0; k < numTaps; ++k)
+    {
+        auto& line = lines[taps.line[k]];
+        auto start = line.index - numSamples - taps.delay[k];
+        if (start < 0)
+            start += line.length;
+        spans[k] = line.memory.getFloats() + start;
+    }
+}
+
+void VelvetTail::process(const juce::dsp::AudioBlock<float>& block)
+{
+    const auto numSamples = (int)block.getNumSamples();
+    jassert(numSamples <= maxBlockSize);
+
+    // While the feedback gains ramp, blocks are cut where they step, so every step lands on
+    // the same sample whatever the block size
+    for (int pos = 0; pos < numSamples;)
+    {
+        auto count = numSamples - pos;
+        if (rampRemaining > 0)
+            count = juce::jmin(count, (rampRemaining - 1) % rampInterval + 1);
+
+        processSpan(block.getSubBlock((size_t)pos, (size_t)count));
+        pos += count;
+    }
+}
+
+void VelvetTail::processSpan(const juce::dsp::AudioBlock<float>& block)
+{
+    const auto numSamples = (int)block.getNumSamples();
+    const auto numChannels = juce::jmin(2, (int)block.getNumChannels());
+
+    if (numSamples == 0 || numChannels == 0)
+        return;
+
+    auto* left = block.getChannelPointer(0);
+    auto* right = numChannels > 1 ? block.getChannelPointer(1) : nullptr;
+
+    // 1. Mono input through the diffuser's velvet noise
+    auto& diffuser = lines[diffuserLine];
+    auto* mono = diffuser.memory.getFloats() + diffuser.index;
+
+    for (int i = 0; i < numSamples; ++i)
+        mono[i] = (right != nullptr ? left[i] + right[i] : left[i]) * inputGain;
+
+    advance(diffuser, numSamples);
+
+    const float* spans[numTaps];
+    getSpans(diffuserTaps, spans, numSamples);
+    kernels->velvetTaps(input.data(), spans, spans + tapsPerSign, tapsPerSign, numSamples);
+
+    // 2. Feedback network, in place in the lines
+    updateGains(numSamples);
+
+    float* blocks[numLines];
+    for (int j = 0; j < numLines; ++j)
+        blocks[j] = lines[j].memory.getFloats() + lines[j].index;
+
+    kernels->velvetLines(blocks, input.data(), gains, lowpassGains, numSamples);
+
+    for (int j = 0; j < numLines; ++j)
+        advance(lines[j], numSamples);
+
+    // 3. The output sequence's halves off the lines, then the width and dry/wet mix. With
+    // left A + B and right A - B, the width's blend of the two is A (wet1 + wet2) + B (wet1 - wet2)
+    // on the left and A (wet1 + wet2) - B (wet1 - wet2) on the right.
+    constexpr int half = tapsPerSign / 2;
+    getSpans(outputTaps, spans, numSamples);
+    kernels->velvetTaps(output[0].data(), spans, spans + tapsPerSign, half, numSamples);
+    kernels->velvetTaps(output[1].data(), spans + half, spans + tapsPerSign + half, half, numSamples);
+
+    const auto* outA = output[0].data();
+    const auto* outB = output[1].data();
+
+    if (dryGain.isSmoothing() || wetGain1.isSmoothing() || wetGain2.isSmoothing())
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float dry = dryGain.getNextValue();
+            const float wet1 = wetGain1.getNextValue();
+            const float wet2 = wetGain2.getNextValue();
+
+            if (right != nullptr)
+            {
+                const float a = outA[i] * (wet1 + wet2), b = outB[i] * (wet1 - wet2);
+                const float l = left[i], r = right[i];
+                left[i] = a + b + l * dry;
+                right[i] = a - b + r * dry;
+            }
+            else
+            {
+                left[i] = (outA[i] + outB[i]) * wet1 + left[i] * dry;
+            }
+        }
+
+        return;
+    }
+
+    // Settled gains, same arithmetic in loops that vectorise
+    const float dry = dryGain.getCurrentValue(), wet1 = wetGain1.getCurrentValue(), wet2 = wetGain2.getCurrentValue();
+    const float sum = wet1 + wet2, difference = wet1 - wet2;
+
+    if (right != nullptr)
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float a = outA[i] * sum, b = outB[i] * difference;
+            const float l = left[i], r = right[i];
+            left[i] = a + b + l * dry;
+            right[i] = a - b + r * dry;
+        }
+    }
+    else
+    {
+        for (int i = 0; i < numSamples; ++i)
+            left[i] = (outA[i] + outB[i]) * wet1 + left[i] * dry;
+    }
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include <juce_dsp/juce_dsp.h>
+#include "DelayMemory.h"
+
+// Low-CPU late tail built from velvet noise, sparse sequences of +-1 taps. A short sequence
+// on the input spreads every sound into a burst of echoes. Four delay lines with Hadamard
+// feedback make the decay: every pass through a line is a segment, scaled by the decay gain
+// and darkened by a two-tap lowpass. The output reads one sequence off the lines in two
+// halves, A and B: the left channel is A + B and the right A - B. Each channel gets every tap,
+// for the reads of one sequence between them, and with the halves unrelated the channels
+// come out uncorrelated. Nothing is recursive within a block, so all of it
+// runs through DSPKernels as vectorised passes over spans, and the taps are adds and
+// subtracts without multiplies.
+// Takes the same parameters as ReverbTail: roomSize sets the decay, damping the colour,
+// width the blend of the two channels.
+class VelvetTail
+{
+public:
+    static constexpr int numLines = 4;
+    static constexpr int tapsPerSign = 4;
+    static constexpr int numTaps = 2 * tapsPerSign;
+
+    using Parameters = juce::dsp::Reverb::Parameters;
+
+    void setKernels(const DSPKernels& newKernels) { kernels = &newKernels; }
+
+    // The lines are reserved in the arena, and usable once it is allocated
+    void prepare(const juce::dsp::ProcessSpec& spec, DelayArena& arena);
+    void reset();
+
+    // Zeroes up to maxSamples more of the lines in use, carrying on where the last call
+    // stopped. Returns how many were zeroed, fewer than maxSamples once the tail is clear.
+    int clearSome(int maxSamples);
+
+    // Re-tunes the lines and taps for a lower internal rate, within the memory allocated by
+    // prepare(). Doesn't touch the memory, which has to be cleared with clearSome() or reset()
+    // before the tail runs again.
+    void setProcessingRate(double newRate);
+
+    void setParameters(const Parameters& newParams);
+
+    // Mono or stereo, in place. Blocks must not exceed the prepared maximum block size.
+    void process(const juce::dsp::AudioBlock<float>& block);
+
+private:
+    // The first mirrorLength samples of a line are mirrored past its end, so every span a
+    // block reads or writes is contiguous and runs in place in the ring
+    struct Line
+    {
+        DelayMemory memory;
+        int length = 0, index = 0;
+    };
+
+    // One velvet-noise sequence, the adding taps first. Each sign's taps alternate in time
+    // between its first and second half.
+    struct Taps
+    {
+        int line[numTaps] = {};
+        int delay[numTaps] = {};
+    };
+
+    // The feedback lines, then the input's
+    static constexpr int diffuserLine = numLines;
+    static constexpr int numRings = numLines + 1;
+
+    void makeTaps(Taps& taps, int channel, juce::int64 seed);
+    void advance(Line& line, int numSamples);
+    void getSpans(const Taps& taps, const float** spans, int numSamples);
+    void updateGains(int numSamples);
+    void processSpan(const juce::dsp::AudioBlock<float>& block);
+
+    const DSPKernels* kernels = &DSPKernels::get();
+
+    Line lines[numRings];
+    Taps diffuserTaps, outputTaps;
+
+    Parameters parameters;
+    float inputGain = 0.0f;
+    juce::SmoothedValue<float> dryGain, wetGain1, wetGain2;
+
+    // Feedback filter of each line, with the Hadamard matrix's 1/2 folded in: the gain of its
+    // delayed sample and of the one after it. A change steps towards the target every
+    // rampInterval samples, over about 10 ms.
+    static constexpr int rampInterval = 32;
+    float gains[numLines] = {}, lowpassGains[numLines] = {};
+    float gainTargets[numLines] = {}, lowpassTargets[numLines] = {};
+    float gainSteps[numLines] = {}, lowpassSteps[numLines] = {};
+    int rampLength = 0, rampRemaining = 0;
+
+    // What the targets were worked out from, none to start with
+    float targetFeedback = -1.0f, targetLowpass = -1.0f;
+
+    // Progress of clearSome()
+    int clearLine = 0, clearPosition = 0;
+
+    // Block scratch: the diffused input and the output sequence's halves
+    std::vector<float> input, output[2];
+    int maxBlockSize = 0, mirrorLength = 0;
+    double preparedRate = 44100.0, processingRate = 44100.0;
+};
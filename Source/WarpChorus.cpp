@@ -0,0 +1,129 @@
+#include "WarpChorus.h"
+#include "FastMath.h"
+#include <cmath>
+
+void WarpChorus::prepare(const juce::dsp::ProcessSpec& spec, DelayArena& arena)
+{
+    sampleRate = spec.sampleRate;
+    maxBlockSize = (int)spec.maximumBlockSize;
+
+    // The longest delay the LFO reaches, plus the sample after it for the interpolation
+    const auto maxDelayMs = centreDelayMs + maxModulationMs * depthScale;
+    const auto ringSize = juce::nextPowerOfTwo((int)std::ceil(maxDelayMs * sampleRate / 1000.0) + 2);
+    ringMask = ringSize - 1;
+
+    rings.resize(spec.numChannels);
+    for (auto& ring : rings)
+        ring.reserve(arena, DelayStorage::float32, ringSize);
+
+    lastOutput.assign(spec.numChannels, 0.0f);
+    delays.assign((size_t)maxBlockSize, 0.0f);
+    lfoGains.assign((size_t)maxBlockSize, 0.0f);
+    feedbackGains.assign((size_t)maxBlockSize, 0.0f);
+    mixGains.assign((size_t)maxBlockSize, 0.0f);
+
+    // The smoothing times of juce::dsp::Chorus
+    rate.reset(sampleRate, 0.05);
+    oscVolume.reset(sampleRate, 0.05);
+    feedback.reset(sampleRate, 0.05);
+    mix.reset(sampleRate, 0.05);
+
+    reset();
+}
+
+void WarpChorus::reset()
+{
+    for (auto& ring : rings)
+        ring.clear();
+
+    std::fill(lastOutput.begin(), lastOutput.end(), 0.0f);
+    writePos = 0;
+    phase = 0.0;
+
+    rate.setCurrentAndTargetValue(rate.getTargetValue());
+    oscVolume.setCurrentAndTargetValue(oscVolume.getTargetValue());
+    feedback.setCurrentAndTargetValue(feedback.getTargetValue());
+    mix.setCurrentAndTargetValue(mix.getTargetValue());
+}
+
+void WarpChorus::setRate(float newRateHz)
+{
+    rate.setTargetValue(newRateHz);
+}
+
+void WarpChorus::setDepth(float newDepth)
+{
+    oscVolume.setTargetValue(juce::jlimit(0.0f, 1.0f, newDepth) * depthScale);
+}
+
+void WarpChorus::setFeedback(float newFeedback)
+{
+    feedback.setTargetValue(juce::jlimit(-1.0f, 1.0f, newFeedback));
+}
+
+void WarpChorus::setMix(float newMix)
+{
+    mix.setTargetValue(juce::jlimit(0.0f, 1.0f, newMix));
+}
+
+void WarpChorus::process(const juce::dsp::AudioBlock<float>& block)
+{
+    const auto numSamples = (int)block.getNumSamples();
+    const auto numChannels = juce::jmin(block.getNumChannels(), rings.size());
+    jassert(numSamples <= maxBlockSize);
+
+    // 1. LFO to delay times, and the gains, once for all channels. The phases and smoothed
+    // values go one after the other, the sines of the phases in a loop of their own, which
+    // vectorises.
+    constexpr auto twoPi = juce::MathConstants<double>::twoPi;
+    const auto msToSamples = (float)(sampleRate / 1000.0);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        delays[(size_t)i] = (float)(phase - juce::MathConstants<double>::pi);
+        lfoGains[(size_t)i] = oscVolume.getNextValue();
+        feedbackGains[(size_t)i] = feedback.getNextValue();
+        mixGains[(size_t)i] = mix.getNextValue();
+
+        phase += twoPi * rate.getNextValue() / sampleRate;
+        if (phase >= twoPi)
+            phase -= twoPi;
+    }
+
+    for (int i = 0; i < numSamples; ++i)
+        delays[(size_t)i] = FastMath::sin(delays[(size_t)i]);
+
+    for (int i = 0; i < numSamples; ++i)
+        delays[(size_t)i] = juce::jmax(1.0f, maxModulationMs * (delays[(size_t)i] * lfoGains[(size_t)i]) + centreDelayMs) * msToSamples;
+
+    // 2. Each channel through its ring: write at the head, read behind it
+    const auto mask = (unsigned int)ringMask;
+
+    for (size_t ch = 0; ch < numChannels; ++ch)
+    {
+        auto* samples = block.getChannelPointer(ch);
+        auto* ring = rings[ch].getFloats();
+        auto last = lastOutput[ch];
+        auto pos = (unsigned int)writePos;
+
+        for (int i = 0; i < numSamples; ++i, ++pos)
+        {
+            const auto dry = samples[i];
+            ring[pos & mask] = dry - last;
+
+            const auto delay = delays[(size_t)i];
+            const auto delayInt = (unsigned int)delay;
+            const auto frac = delay - (float)delayInt;
+            const auto newer = ring[(pos - delayInt) & mask];
+            const auto older = ring[(pos - delayInt - 1) & mask];
+            const auto wet = newer + frac * (older - newer);
+
+            last = wet * feedbackGains[(size_t)i];
+            samples[i] = dry * (1.0f - mixGains[(size_t)i]) + wet * mixGains[(size_t)i];
+        }
+
+        lastOutput[ch] = last;
+    }
+
+    writePos = (writePos + numSamples) & ringMask;
+}
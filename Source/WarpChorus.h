@@ -0,0 +1,43 @@
+#pragma once
+#include <juce_dsp/juce_dsp.h>
+#include "DelayMemory.h"
+
+// The Warp stage: juce::dsp::Chorus's algorithm, a sine LFO sweeping a linearly interpolated
+// delay around 7 ms, with negative feedback and a linear dry/wet mix. The rings live in the
+// DelayArena, the heads run forwards and wrap by mask rather than by a test per sample.
+class WarpChorus
+{
+public:
+    // The rings are reserved in the arena, and usable once it is allocated
+    void prepare(const juce::dsp::ProcessSpec& spec, DelayArena& arena);
+    void reset();
+
+    // LFO rate in Hz
+    void setRate(float newRateHz);
+    // 0..1, the LFO sweeps up to 10 ms either side of the centre delay
+    void setDepth(float newDepth);
+    // -1..1, share of the delayed signal subtracted from the input
+    void setFeedback(float newFeedback);
+    // 0..1, dry to wet
+    void setMix(float newMix);
+
+    void process(const juce::dsp::AudioBlock<float>& block);
+
+private:
+    static constexpr float centreDelayMs = 7.0f;
+    static constexpr float maxModulationMs = 20.0f;
+    static constexpr float depthScale = 0.5f;
+
+    std::vector<DelayMemory> rings;
+    std::vector<float> lastOutput;
+    int ringMask = 0, writePos = 0;
+
+    // Per sample of the block, shared by the channels: delay in samples and the smoothed gains
+    std::vector<float> delays, lfoGains, feedbackGains, mixGains;
+
+    // Defaults of juce::dsp::Chorus
+    juce::SmoothedValue<float> rate { 1.0f }, oscVolume { 0.25f * depthScale }, feedback, mix { 0.5f };
+    double phase = 0.0;
+    double sampleRate = 44100.0;
+    int maxBlockSize = 0;
+};
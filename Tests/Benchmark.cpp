@@ -0,0 +1,536 @@
+#include <juce_dsp/juce_dsp.h>
+#include "../Source/ReverbProcessor.h"
+#include "../Source/FastMath.h"
+#include "../Source/EventLog.h"
+#include <chrono>
+#include <iostream>
+// cmake --build build --config Release --target Benchmark
+// Reports the realtime factor of each kernel variant this CPU can run, and its speedup over the baseline.
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr double benchSampleRate = 48000.0;
+    constexpr int benchBlockSize = 256;
+    constexpr double benchSeconds = 20.0;
+
+    std::vector<const DSPKernels*> getAvailableKernels()
+    {
+        std::vector<const DSPKernels*> result { &DSPKernels::getBaseline() };
+
+        for (auto isa : { DSPKernels::Isa::avx2, DSPKernels::Isa::avx512 })
+            if (auto* kernels = DSPKernels::getVariant(isa))
+                result.push_back(kernels);
+
+        return result;
+    }
+
+    // Seconds of audio processed per second of CPU time
+    double measureProcessor(const DSPKernels& kernels, double sampleRate = benchSampleRate, int eco = 0,
+                            ReverbProcessor::Quality quality = ReverbProcessor::Quality::realtime,
+                            DelayStorage storage = DelayStorage::float32)
+    {
+        ReverbProcessor processor;
+        processor.setKernels(kernels);
+        processor.setQuality(quality);
+        processor.setDelayStorage(storage);
+        processor.prepare({ sampleRate, (juce::uint32)benchBlockSize, 2 });
+
+        ReverbParameters params;
+        params.mix = 60.0f;
+        params.feedback = 80.0f;
+        params.gateThresh = -70.0f;
+        params.dynBands[0].gain = 2.0f;
+        params.ducking = 20.0f;
+        params.msBalance = 60.0f;
+        params.eco = eco;
+        params.saturation = 30.0f;
+        processor.setParameters(params);
+
+        juce::AudioBuffer<float> buffer(2, benchBlockSize);
+        juce::Random random(42);
+
+        const int numBlocks = (int)(benchSeconds * sampleRate / benchBlockSize);
+        auto start = Clock::now();
+
+        for (int b = 0; b < numBlocks; ++b)
+        {
+            for (int ch = 0; ch < 2; ++ch)
+                for (int i = 0; i < benchBlockSize; ++i)
+                    buffer.setSample(ch, i, (random.nextFloat() * 2.0f - 1.0f) * 0.25f);
+
+            juce::dsp::AudioBlock<float> block(buffer);
+            juce::dsp::ProcessContextReplacing<float> context(block);
+            processor.process(context);
+        }
+
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+        return benchSeconds / elapsed.count();
+    }
+
+    // Comb bank alone, in millions of line-samples per second
+    double measureCombBank(const DSPKernels& kernels, int numLines)
+    {
+        const int numSamples = 32;
+        const int iterations = 200000;
+
+        std::vector<float> lines((size_t)(numLines * numSamples), 0.1f), input((size_t)numSamples, 0.01f),
+                           output((size_t)numSamples), state((size_t)numLines, 0.0f);
+
+        auto start = Clock::now();
+
+        for (int i = 0; i < iterations; ++i)
+            kernels.combBank(lines.data(), input.data(), output.data(), state.data(), numLines, numSamples,
+                             0.2f, 0.0f, 0.84f, 0.0f);
+
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+        return (double)numLines * numSamples * iterations / elapsed.count() * 1.0e-6;
+    }
+
+    // Many instances in turn, as a host runs them, so each one's delay memory has left the
+    // cache by the time it runs again. Seconds of audio per second of CPU time, for each instance.
+    double measureInstances(DelayStorage storage, int numInstances)
+    {
+        ReverbParameters params;
+        params.mix = 60.0f;
+        params.feedback = 95.0f;
+        params.delay = 1000.0f;
+
+        std::vector<std::unique_ptr<ReverbProcessor>> processors;
+        for (int i = 0; i < numInstances; ++i)
+        {
+            processors.push_back(std::make_unique<ReverbProcessor>());
+            processors.back()->setDelayStorage(storage);
+            processors.back()->prepare({ benchSampleRate, (juce::uint32)benchBlockSize, 2 });
+            processors.back()->setParameters(params);
+        }
+
+        juce::AudioBuffer<float> buffer(2, benchBlockSize);
+        juce::Random random(42);
+        const int numBlocks = (int)(benchSeconds * benchSampleRate / benchBlockSize / numInstances);
+        auto start = Clock::now();
+
+        for (int b = 0; b < numBlocks; ++b)
+        {
+            for (auto& processor : processors)
+            {
+                for (int ch = 0; ch < 2; ++ch)
+                    for (int i = 0; i < benchBlockSize; ++i)
+                        buffer.setSample(ch, i, (random.nextFloat() * 2.0f - 1.0f) * 0.25f);
+
+                juce::dsp::AudioBlock<float> block(buffer);
+                juce::dsp::ProcessContextReplacing<float> context(block);
+                processor->process(context);
+            }
+        }
+
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+        return numBlocks * numInstances * benchBlockSize / benchSampleRate / elapsed.count();
+    }
+
+    // Size of one instance's delay arena, in KiB
+    double delayMemoryKiB(DelayStorage storage)
+    {
+        ReverbProcessor processor;
+        processor.setDelayStorage(storage);
+        processor.prepare({ benchSampleRate, (juce::uint32)benchBlockSize, 2 });
+        return (double)processor.getDelayMemoryBytes() / 1024.0;
+    }
+
+    // Long tail (98% feedback, 1 s pre-delay) with 16-bit delay memory against float32: the
+    // level of the difference, relative to the float32 output and in dBFS
+    std::pair<double, double> measureStorageNoise(DelayStorage storage)
+    {
+        const int length = (int)(8.0 * benchSampleRate);
+
+        auto render = [&](DelayStorage format)
+        {
+            ReverbProcessor processor;
+            processor.setDelayStorage(format);
+            processor.prepare({ benchSampleRate, (juce::uint32)benchBlockSize, 2 });
+
+            ReverbParameters params;
+            params.mix = 100.0f;
+            params.feedback = 98.0f;
+            params.delay = 1000.0f;
+            processor.setParameters(params);
+
+            // A second of noise at -12 dBFS, then the tail
+            juce::AudioBuffer<float> buffer(2, length);
+            juce::Random random(3);
+            for (int ch = 0; ch < 2; ++ch)
+                for (int i = 0; i < (int)benchSampleRate; ++i)
+                    buffer.setSample(ch, i, (random.nextFloat() * 2.0f - 1.0f) * 0.25f);
+
+            for (int pos = 0; pos < length; pos += benchBlockSize)
+            {
+                juce::dsp::AudioBlock<float> block(buffer.getArrayOfWritePointers(), 2, (size_t)pos,
+                                                   (size_t)std::min(benchBlockSize, length - pos));
+                juce::dsp::ProcessContextReplacing<float> context(block);
+                processor.process(context);
+            }
+
+            return buffer;
+        };
+
+        auto reference = render(DelayStorage::float32);
+        auto compact = render(storage);
+
+        double signal = 0.0, noise = 0.0;
+        for (int ch = 0; ch < 2; ++ch)
+        {
+            for (int i = 0; i < length; ++i)
+            {
+                const double x = reference.getSample(ch, i);
+                const double e = compact.getSample(ch, i) - x;
+                signal += x * x;
+                noise += e * e;
+            }
+        }
+
+        const double count = 2.0 * length;
+        return { 10.0 * std::log10(noise / signal), 10.0 * std::log10(noise / count) };
+    }
+
+    // Stereo pre-delay alone at 1 s, in millions of stereo samples per second: settled, where
+    // blocks are spans of the ring, or always gliding between two delays
+    double measurePreDelay(bool ramping)
+    {
+        const int numSamples = 32;
+        const int iterations = 200000;
+
+        DelayArena arena;
+        PreDelay preDelay;
+        arena.beginLayout();
+        preDelay.prepare({ benchSampleRate, (juce::uint32)numSamples, 2 }, (int)(2.0 * benchSampleRate), arena);
+        arena.allocate();
+        preDelay.setDelay((float)benchSampleRate);
+
+        juce::AudioBuffer<float> buffer(2, numSamples);
+        juce::dsp::AudioBlock<float> block(buffer);
+        auto start = Clock::now();
+
+        for (int i = 0; i < iterations; ++i)
+        {
+            if (ramping && ! preDelay.isRamping())
+                preDelay.setDelay((float)benchSampleRate * ((i / 100) % 2 == 0 ? 1.0f : 1.01f));
+
+            preDelay.process(block);
+        }
+
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+        return (double)numSamples * iterations / elapsed.count() * 1.0e-6;
+    }
+
+    // EQ3 cascade on a stereo pair, in millions of stereo samples per second. Lanes runs both
+    // channels in one pass, otherwise each channel goes through on its own.
+    double measureStereoBiquads(bool lanes)
+    {
+        const int numSamples = 32;
+        const int iterations = 200000;
+
+        juce::AudioBuffer<float> buffer(2, numSamples);
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = 0; i < numSamples; ++i)
+                buffer.setSample(ch, i, (float)((i * 7 + ch) % 13) / 13.0f - 0.5f);
+
+        const float peak[] = { 1.05f, -1.9f, 0.86f, -1.9f, 0.91f };
+        BiquadCascade filters[2];
+        for (auto& filter : filters)
+        {
+            filter.prepare(lanes ? 2 : 1, 3);
+            for (int k = 0; k < 3; ++k)
+                filter.setStage(k, peak);
+        }
+
+        juce::dsp::AudioBlock<float> block(buffer);
+        auto start = Clock::now();
+
+        for (int i = 0; i < iterations; ++i)
+        {
+            if (lanes)
+            {
+                filters[0].process(block);
+            }
+            else
+            {
+                filters[0].process(block.getSingleChannelBlock(0));
+                filters[1].process(block.getSingleChannelBlock(1));
+            }
+        }
+
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+        return (double)numSamples * iterations / elapsed.count() * 1.0e-6;
+    }
+
+    // A function over a block of inputs spread over from..to, in millions of values per second.
+    // In a plain loop, which vectorises, or one value at a time, each input waiting on the last
+    // result as in a loop that carries state.
+    template <typename Function>
+    double measureMath(float from, float to, Function function, bool oneAtATime = false)
+    {
+        const int numValues = 4096;
+        const int iterations = 5000;
+
+        std::vector<float> input((size_t)numValues), output((size_t)numValues);
+        for (int i = 0; i < numValues; ++i)
+            input[(size_t)i] = from + (to - from) * (float)i / (float)numValues;
+
+        float sum = 0.0f;
+        auto start = Clock::now();
+
+        for (int i = 0; i < iterations; ++i)
+        {
+            if (oneAtATime)
+            {
+                float last = 0.0f;
+                for (int j = 0; j < numValues; ++j)
+                    output[(size_t)j] = last = function(input[(size_t)j] + 0.0f * last);
+            }
+            else
+            {
+                for (int j = 0; j < numValues; ++j)
+                    output[(size_t)j] = function(input[(size_t)j]);
+            }
+
+            // Keeps the work from being optimised away
+            sum += output[(size_t)(i % numValues)];
+        }
+
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+        if (sum == 12345.0f)
+            std::cout << sum;
+        return (double)numValues * iterations / elapsed.count() * 1.0e-6;
+    }
+
+    // Cost of one EventLog push from the audio thread, in nanoseconds, drained every 64 events
+    double measureEventLogPush()
+    {
+        const int iterations = 200000;
+        const int burst = 64;
+
+        auto log = std::make_unique<EventLog>();
+        log->setEnabled(true);
+        int sum = 0;
+        double pushSeconds = 0.0;
+
+        for (int i = 0; i < iterations; ++i)
+        {
+            auto start = Clock::now();
+            for (int j = 0; j < burst; ++j)
+                log->push(EventLog::Type::overrun, j, i, 1.5);
+            pushSeconds += std::chrono::duration<double>(Clock::now() - start).count();
+
+            log->drain([&sum](const EventLog::Event& e) { sum += e.intValue; });
+        }
+
+        if (sum == 12345)
+            std::cout << sum;
+        return pushSeconds / ((double)iterations * burst) * 1.0e9;
+    }
+
+    // The Freeverb tail at a host rate, run as ReverbProcessor runs it: in sub-blocks at full
+    // rate, or for a factor above 1 in spans brought down, through the tail a sub-block at a
+    // time and back up. Seconds of audio per second of CPU time.
+    double measureTailPath(double sampleRate, int factor)
+    {
+        const int subBlockSize = ReverbProcessor::defaultSubBlockSize;
+        const int span = factor > 1 ? ReverbProcessor::tailSpanSubBlocks * factor * subBlockSize : subBlockSize;
+
+        DelayArena arena;
+        ReverbTail tail;
+        arena.beginLayout();
+        tail.prepare({ sampleRate, (juce::uint32)subBlockSize, 2 }, arena);
+        arena.allocate();
+        tail.setProcessingRate(sampleRate / factor);
+        tail.reset();
+
+        ReverbTail::Parameters parameters;
+        parameters.roomSize = 0.8f;
+        parameters.damping = 0.5f;
+        parameters.wetLevel = 1.0f;
+        parameters.dryLevel = 0.0f;
+        tail.setParameters(parameters);
+
+        TailResampler resampler;
+        resampler.prepare(2, span);
+        resampler.setFactor(factor);
+
+        juce::AudioBuffer<float> noise(2, span), buffer(2, span), low(2, span);
+        juce::Random random(42);
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = 0; i < span; ++i)
+                noise.setSample(ch, i, (random.nextFloat() * 2.0f - 1.0f) * 0.25f);
+
+        juce::ScopedNoDenormals noDenormals;
+        juce::dsp::AudioBlock<float> block(buffer), lowBlock(low);
+        const int numSpans = (int)(benchSeconds * sampleRate / span);
+        auto start = Clock::now();
+
+        for (int s = 0; s < numSpans; ++s)
+        {
+            for (int ch = 0; ch < 2; ++ch)
+                buffer.copyFrom(ch, 0, noise, ch, 0, span);
+
+            if (factor == 1)
+            {
+                tail.process(block);
+                continue;
+            }
+
+            const int numLow = resampler.decimate(block, lowBlock);
+            for (int pos = 0; pos < numLow; pos += subBlockSize)
+                tail.process(lowBlock.getSubBlock((size_t)pos, (size_t)std::min(subBlockSize, numLow - pos)));
+            resampler.interpolate(lowBlock, numLow, block);
+        }
+
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+        return benchSeconds / elapsed.count();
+    }
+
+    // A late tail alone, in millions of stereo samples per second, ringing on after a burst
+    // every 100 blocks
+    template <typename Tail>
+    double measureTail()
+    {
+        const int numSamples = 32;
+        const int iterations = 200000;
+
+        DelayArena arena;
+        Tail tail;
+        arena.beginLayout();
+        tail.prepare({ benchSampleRate, (juce::uint32)numSamples, 2 }, arena);
+        arena.allocate();
+
+        typename Tail::Parameters parameters;
+        parameters.roomSize = 0.8f;
+        parameters.damping = 0.5f;
+        parameters.wetLevel = 1.0f;
+        parameters.dryLevel = 0.0f;
+        tail.setParameters(parameters);
+
+        juce::AudioBuffer<float> burst(2, numSamples), buffer(2, numSamples);
+        juce::Random random(42);
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = 0; i < numSamples; ++i)
+                burst.setSample(ch, i, (random.nextFloat() * 2.0f - 1.0f) * 0.25f);
+
+        juce::ScopedNoDenormals noDenormals;
+        juce::dsp::AudioBlock<float> block(buffer);
+        auto start = Clock::now();
+
+        for (int i = 0; i < iterations; ++i)
+        {
+            for (int ch = 0; ch < 2; ++ch)
+            {
+                if (i % 100 == 0)
+                    buffer.copyFrom(ch, 0, burst, ch, 0, numSamples);
+                else
+                    buffer.clear(ch, 0, numSamples);
+            }
+
+            tail.process(block);
+        }
+
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+        return (double)numSamples * iterations / elapsed.count() * 1.0e-6;
+    }
+}
+
+int main()
+{
+    std::cout << "Selected kernels: " << DSPKernels::get().name << std::endl << std::endl;
+
+    double baselineFactor = 0.0;
+
+    for (auto* kernels : getAvailableKernels())
+    {
+        auto factor = measureProcessor(*kernels);
+        if (baselineFactor == 0.0)
+            baselineFactor = factor;
+
+        std::cout << kernels->name << ": " << factor << "x realtime, " << factor / baselineFactor << "x baseline" << std::endl;
+
+        for (int numLines : { 8, 16 })
+            std::cout << "    comb bank, " << numLines << " lines: " << measureCombBank(*kernels, numLines) << " M line-samples/s" << std::endl;
+    }
+
+    // The stereo pair as SIMD lanes against one channel at a time
+    std::cout << std::endl << "EQ3 cascade, stereo: " << measureStereoBiquads(true) << " M samples/s as lanes, "
+              << measureStereoBiquads(false) << " per channel" << std::endl;
+    std::cout << "Pre-delay, stereo: " << measurePreDelay(false) << " M samples/s settled, " << measurePreDelay(true)
+              << " while gliding" << std::endl;
+
+    // FastMath against the standard library, over the ranges the processor uses them on, in a
+    // loop and one at a time. The processor only uses FastMath in loops.
+    std::cout << std::endl;
+    auto reportMath = [](const char* name, float from, float to, auto fast, auto standard)
+    {
+        const auto fastLoop = measureMath(from, to, fast), standardLoop = measureMath(from, to, standard);
+        const auto fastSingle = measureMath(from, to, fast, true), standardSingle = measureMath(from, to, standard, true);
+        std::cout << name << ": in a loop FastMath " << fastLoop << " M values/s, std " << standardLoop << " ("
+                  << fastLoop / standardLoop << "x); one at a time " << fastSingle << ", " << standardSingle << " ("
+                  << fastSingle / standardSingle << "x)" << std::endl;
+    };
+
+    reportMath("exp2", -20.0f, 20.0f, [](float x) { return FastMath::exp2(x); }, [](float x) { return std::exp2(x); });
+    reportMath("log2", 1.0e-5f, 10.0f, [](float x) { return FastMath::log2(x); }, [](float x) { return std::log2(x); });
+    reportMath("gainToDecibels", 1.0e-5f, 10.0f, [](float x) { return FastMath::gainToDecibels(x); },
+               [](float x) { return juce::Decibels::gainToDecibels(x); });
+    reportMath("decibelsToGain", -60.0f, 20.0f, [](float x) { return FastMath::decibelsToGain(x); },
+               [](float x) { return juce::Decibels::decibelsToGain(x); });
+    reportMath("tanh", -4.0f, 4.0f, [](float x) { return FastMath::tanh(x); }, [](float x) { return std::tanh(x); });
+    reportMath("sin", -3.14159f, 3.14159f, [](float x) { return FastMath::sin(x); }, [](float x) { return std::sin(x); });
+
+    std::cout << std::endl;
+    auto freeverbTail = measureTail<ReverbTail>();
+    auto velvetTail = measureTail<VelvetTail>();
+    std::cout << "Late tail core, stereo: Freeverb " << freeverbTail << " M samples/s, velvet " << velvetTail << " ("
+              << velvetTail / freeverbTail << "x cheaper)" << std::endl;
+
+    std::cout << "Event log push: " << measureEventLogPush() << " ns" << std::endl;
+
+    // Eco tail at high sample rates, with the selected kernels: the whole processor, and the
+    // tail with its resampling alone
+    std::cout << std::endl;
+    for (double sampleRate : { 96000.0, 192000.0 })
+    {
+        auto full = measureProcessor(DSPKernels::get(), sampleRate, 0);
+        auto eco = measureProcessor(DSPKernels::get(), sampleRate, 3);
+        auto fullTail = measureTailPath(sampleRate, 1);
+        auto ecoTail = measureTailPath(sampleRate, ReverbProcessor::getEcoFactor(3, sampleRate));
+        std::cout << sampleRate / 1000.0 << " kHz: " << full << "x realtime, eco auto " << eco << "x ("
+                  << eco / full << "x faster); tail path " << fullTail << "x realtime, eco auto " << ecoTail << "x ("
+                  << ecoTail / fullTail << "x faster)" << std::endl;
+    }
+
+    // Offline render profile against the realtime one
+    auto realtime = measureProcessor(DSPKernels::get());
+    auto offline = measureProcessor(DSPKernels::get(), benchSampleRate, 0, ReverbProcessor::Quality::offline);
+    std::cout << std::endl << "realtime profile: " << realtime << "x realtime, offline profile: " << offline << "x ("
+              << realtime / offline << "x the cost)" << std::endl;
+
+    // 16-bit delay memory against float32, with the selected kernels, on its own and with the
+    // delay memory of 128 instances going through the cache
+    std::cout << std::endl;
+    const int numInstances = 128;
+    auto float32 = measureProcessor(DSPKernels::get());
+    auto float32Instances = measureInstances(DelayStorage::float32, numInstances);
+    std::cout << "float32 delay memory (" << delayMemoryKiB(DelayStorage::float32) << " KiB): " << float32 << "x realtime, "
+              << float32Instances << "x each of " << numInstances << " instances" << std::endl;
+
+    for (auto storage : { DelayStorage::float16, DelayStorage::int16 })
+    {
+        auto factor = measureProcessor(DSPKernels::get(), benchSampleRate, 0, ReverbProcessor::Quality::realtime, storage);
+        auto instances = measureInstances(storage, numInstances);
+        auto noise = measureStorageNoise(storage);
+        std::cout << (storage == DelayStorage::float16 ? "float16" : "int16 dithered") << " delay memory ("
+                  << delayMemoryKiB(storage) << " KiB): " << factor
+                  << "x realtime (" << factor / float32 << "x float32), " << instances << "x each of " << numInstances
+                  << " instances (" << instances / float32Instances << "x float32), difference " << noise.first
+                  << " dB relative, " << noise.second << " dBFS" << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,1207 @@
+#include <juce_dsp/juce_dsp.h>
+#include "../Source/ReverbProcessor.h"
+#include "../Source/FastMath.h"
+#include "../Source/EventLog.h"
+#include "../Source/FlightRecorder.h"
+#include "../Source/ReverbModes.h"
+#include "../Source/FdnrApi.h"
+#include <thread>
+#include <iostream>
+// cmake --build build --target DSPTests && ctest --test-dir build -R DSPTests
+
+namespace
+{
+    constexpr double testSampleRate = 48000.0;
+    constexpr int testLength = 48000 * 2;
+
+    ReverbParameters makeTestParameters()
+    {
+        ReverbParameters params;
+        params.mix = 70.0f;
+        params.feedback = 80.0f;
+        params.density = 40.0f;
+        params.warp = 30.0f;
+        params.saturation = 20.0f;
+        params.gateThresh = -60.0f;
+        params.dynBandCount = 3;
+        params.dynBands[0].gain = 3.0f;
+        params.dynBands[0].depth = 6.0f;
+        params.dynBands[1].depth = -6.0f;
+        params.dynBands[1].threshold = -40.0f;
+        params.dynBands[2].gain = -2.0f;
+        params.ducking = 30.0f;
+        params.eq3Low = 2.0f;
+        params.eq3High = -3.0f;
+        params.msBalance = 65.0f;
+        return params;
+    }
+
+    // How render() runs the processor. The defaults are the reference render.
+    struct RenderOptions
+    {
+        const DSPKernels* kernels = &DSPKernels::getBaseline();
+        int hostBlockSize = 512;
+        int eco = 0;
+        int engine = 0;
+        ReverbProcessor::Quality quality = ReverbProcessor::Quality::realtime;
+        DelayStorage storage = DelayStorage::float32;
+
+        // Applied at the parameter change half way through
+        bool clearHalfWay = false;
+        int qualityTierHalfWay = QualityController::full;
+    };
+
+    RenderOptions withKernels(RenderOptions options, const DSPKernels& kernels)
+    {
+        options.kernels = &kernels;
+        return options;
+    }
+
+    RenderOptions withBlockSize(RenderOptions options, int hostBlockSize)
+    {
+        options.hostBlockSize = hostBlockSize;
+        return options;
+    }
+
+    // Renders a noise burst and its tail, with a parameter change half way through
+    juce::AudioBuffer<float> render(const RenderOptions& options)
+    {
+        juce::AudioBuffer<float> buffer(2, testLength);
+        juce::Random random(1234);
+
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            for (int i = 0; i < testLength / 8; ++i)
+                buffer.setSample(ch, i, random.nextFloat() * 2.0f - 1.0f);
+
+        ReverbProcessor processor;
+        processor.setKernels(*options.kernels);
+        processor.setDelayStorage(options.storage);
+        processor.prepare({ testSampleRate, (juce::uint32)options.hostBlockSize, 2 });
+        processor.reset();
+        processor.setQuality(options.quality);
+
+        auto params = makeTestParameters();
+        params.eco = options.eco;
+        params.engine = options.engine;
+        processor.setParameters(params);
+
+        // The change is made at the same sample whatever the host block size
+        const int halfLength = testLength / 2;
+
+        for (int pos = 0; pos < testLength;)
+        {
+            if (pos == halfLength)
+            {
+                params.feedback = 40.0f;
+                params.msBalance = 30.0f;
+                processor.setParameters(params);
+
+                if (options.clearHalfWay)
+                    processor.clear();
+
+                processor.setQualityTier(options.qualityTierHalfWay);
+            }
+
+            auto end = pos < halfLength ? halfLength : testLength;
+            auto len = std::min(options.hostBlockSize, end - pos);
+            juce::dsp::AudioBlock<float> block(buffer.getArrayOfWritePointers(), 2, (size_t)pos, (size_t)len);
+            juce::dsp::ProcessContextReplacing<float> context(block);
+            processor.process(context);
+            pos += len;
+        }
+
+        return buffer;
+    }
+
+    float maxDifference(const juce::AudioBuffer<float>& a, const juce::AudioBuffer<float>& b)
+    {
+        float diff = 0.0f;
+        for (int ch = 0; ch < a.getNumChannels(); ++ch)
+            for (int i = 0; i < a.getNumSamples(); ++i)
+                diff = std::max(diff, std::abs(a.getSample(ch, i) - b.getSample(ch, i)));
+        return diff;
+    }
+
+    bool expectMatch(const juce::String& name, const juce::AudioBuffer<float>& expected, const juce::AudioBuffer<float>& actual)
+    {
+        // Every variant is built without FP contraction, so anything above rounding noise is a bug
+        const float tolerance = 1.0e-6f;
+        auto diff = maxDifference(expected, actual);
+        auto passed = diff <= tolerance;
+
+        std::cout << (passed ? "PASS " : "FAIL ") << name << " (max difference " << diff << ")" << std::endl;
+        return passed;
+    }
+
+    // The limiter delays by exactly its latency, and holds inter-sample peaks at its threshold
+    bool testLimiter()
+    {
+        OutputLimiter limiter;
+        limiter.setThreshold(-0.1f);
+        limiter.prepare({ testSampleRate, 64, 2 });
+
+        const int latency = limiter.getLatencySamples();
+        const int length = 48000, half = length / 2;
+
+        // Quiet noise, then a sine at a quarter of the sample rate with its samples 45 degrees
+        // off the crests, so its true peak is 3 dB over the sample peak
+        juce::AudioBuffer<float> input(2, length);
+        juce::Random random(7);
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = 0; i < length; ++i)
+                input.setSample(ch, i, i < half ? 0.5f * (random.nextFloat() * 2.0f - 1.0f)
+                                                : 1.2f * std::sin(juce::MathConstants<float>::halfPi * (float)i + 0.25f * juce::MathConstants<float>::pi));
+
+        juce::AudioBuffer<float> output;
+        output.makeCopyOf(input);
+        for (int pos = 0; pos < length; pos += 64)
+            limiter.process(juce::dsp::AudioBlock<float>(output).getSubBlock((size_t)pos, 64));
+
+        float delayError = 0.0f, samplePeak = 0.0f;
+        for (int ch = 0; ch < 2; ++ch)
+        {
+            for (int i = 0; i + latency < half; ++i)
+                delayError = std::max(delayError, std::abs(output.getSample(ch, i + latency) - input.getSample(ch, i)));
+
+            // Once the release has settled
+            for (int i = half + 4800; i < length; ++i)
+                samplePeak = std::max(samplePeak, std::abs(output.getSample(ch, i)));
+        }
+
+        const auto truePeakDb = juce::Decibels::gainToDecibels(samplePeak * juce::MathConstants<float>::sqrt2);
+        const bool passed = delayError == 0.0f && truePeakDb <= 0.0f && truePeakDb > -0.5f;
+
+        std::cout << (passed ? "PASS " : "FAIL ") << "limiter (delay error " << delayError << ", latency "
+                  << latency << ", true peak " << truePeakDb << " dB)" << std::endl;
+        return passed;
+    }
+
+    // Channels filtered together as lanes must come out as if each had a filter of its own
+    bool testLaneFilters(int numChannels)
+    {
+        juce::AudioBuffer<float> lanes(numChannels, 1000);
+        juce::Random random(99);
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int i = 0; i < lanes.getNumSamples(); ++i)
+                lanes.setSample(ch, i, random.nextFloat() * 2.0f - 1.0f);
+
+        juce::AudioBuffer<float> separate;
+        separate.makeCopyOf(lanes);
+
+        using Coefficients = juce::dsp::IIR::Coefficients<float>;
+        auto lowShelf = Coefficients::makeLowShelf(testSampleRate, 200.0f, 0.71f, 2.0f);
+        auto highShelf = Coefficients::makeHighShelf(testSampleRate, 6000.0f, 0.71f, 0.5f);
+
+        auto setStages = [&](BiquadCascade& filter, int channels)
+        {
+            filter.prepare(channels, 2);
+            filter.setStage(0, lowShelf->getRawCoefficients());
+            filter.setStage(1, highShelf->getRawCoefficients());
+        };
+
+        BiquadCascade together;
+        setStages(together, numChannels);
+        together.process(juce::dsp::AudioBlock<float>(lanes));
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            BiquadCascade single;
+            setStages(single, 1);
+            single.process(juce::dsp::AudioBlock<float>(separate).getSingleChannelBlock((size_t)ch));
+        }
+
+        return expectMatch(juce::String(numChannels) + " channel biquad lanes", separate, lanes);
+    }
+
+    // Half floats round to nearest and are exact where they can be, int16 stays within a step
+    // of its dither. Every variant gives the same bits.
+    bool testDelayStorage()
+    {
+        const int length = 4096;
+        std::vector<float> input((size_t)length), output((size_t)length);
+        juce::Random random(11);
+        for (int i = 0; i < length; ++i)
+            input[(size_t)i] = (random.nextFloat() * 2.0f - 1.0f) * std::pow(2.0f, -20.0f * random.nextFloat());
+
+        // Every finite half, including the subnormals
+        std::vector<uint16_t> halves;
+        for (uint32_t bits = 0; bits < 0x10000u; ++bits)
+            if ((bits & 0x7c00u) != 0x7c00u)
+                halves.push_back((uint16_t)bits);
+
+        const auto& baseline = DSPKernels::getBaseline();
+        std::vector<float> decoded(halves.size());
+        std::vector<uint16_t> reencoded(halves.size());
+        baseline.decodeHalf(decoded.data(), halves.data(), (int)halves.size());
+        baseline.encodeHalf(reencoded.data(), decoded.data(), (int)halves.size());
+        bool passed = reencoded == halves;
+
+        std::vector<uint16_t> half((size_t)length);
+        baseline.encodeHalf(half.data(), input.data(), length);
+        baseline.decodeHalf(output.data(), half.data(), length);
+
+        float halfError = 0.0f;
+        for (int i = 0; i < length; ++i)
+            halfError = std::max(halfError, std::abs(output[(size_t)i] - input[(size_t)i])
+                                                / std::max(std::abs(input[(size_t)i]), std::pow(2.0f, -14.0f)));
+        passed &= halfError <= std::pow(2.0f, -11.0f);
+
+        std::vector<int16_t> fixed((size_t)length);
+        const float range = 4.0f;
+        baseline.encodeInt16(fixed.data(), input.data(), length, range, 0);
+        baseline.decodeInt16(output.data(), fixed.data(), length, range);
+
+        float int16Error = 0.0f;
+        for (int i = 0; i < length; ++i)
+            int16Error = std::max(int16Error, std::abs(output[(size_t)i] - input[(size_t)i]));
+        passed &= int16Error <= 1.5f * range / 32768.0f;
+
+        for (auto isa : { DSPKernels::Isa::avx2, DSPKernels::Isa::avx512 })
+        {
+            if (auto* kernels = DSPKernels::getVariant(isa))
+            {
+                std::vector<uint16_t> variantHalf((size_t)length);
+                std::vector<int16_t> variantFixed((size_t)length);
+                std::vector<float> variantDecoded(halves.size());
+                kernels->encodeHalf(variantHalf.data(), input.data(), length);
+                kernels->encodeInt16(variantFixed.data(), input.data(), length, range, 0);
+                kernels->decodeHalf(variantDecoded.data(), halves.data(), (int)halves.size());
+                passed &= variantHalf == half && variantFixed == fixed && variantDecoded == decoded;
+            }
+        }
+
+        std::cout << (passed ? "PASS " : "FAIL ") << "delay storage (half error " << halfError << " relative, int16 error "
+                  << int16Error << ")" << std::endl;
+        return passed;
+    }
+
+    // Settled delays are whole samples, read exactly. A change glides: fed a linear ramp the
+    // interpolation is exact, so the output follows input minus delay throughout.
+    bool testPreDelay()
+    {
+        const int length = 48000 / 4;
+
+        auto run = [&](int blockSize)
+        {
+            DelayArena arena;
+            PreDelay preDelay;
+            arena.beginLayout();
+            preDelay.prepare({ testSampleRate, 32, 1 }, 4800, arena);
+            arena.allocate();
+            preDelay.setDelay(100.4f);
+
+            std::vector<float> samples((size_t)length);
+            for (int i = 0; i < length; ++i)
+                samples[(size_t)i] = (float)i;
+
+            for (int pos = 0; pos < length; pos += 32)
+            {
+                // At the same sample whatever the block size, as ReverbProcessor does
+                if (pos == 2048)
+                    preDelay.setDelay(2100.0f);
+
+                for (int sub = pos; sub < pos + 32; sub += blockSize)
+                {
+                    float* channels[] = { samples.data() + sub };
+                    preDelay.process(juce::dsp::AudioBlock<float>(channels, 1, (size_t)std::min(blockSize, pos + 32 - sub)));
+                }
+            }
+
+            return samples;
+        };
+
+        const auto output = run(32);
+        bool passed = output == run(1) && output == run(5);
+
+        const int rampEnd = 2048 + (int)(PreDelay::rampSeconds * testSampleRate);
+        float rampError = 0.0f;
+
+        for (int i = 0; i < length; ++i)
+        {
+            const auto delay = i < 2048 ? 100.0f : i >= rampEnd ? 2100.0f : 100.0f + 2000.0f * (float)(i - 2047) / (float)(rampEnd - 2048);
+            const auto expected = std::max(0.0f, (float)i - delay);
+
+            if (i < 2048 || i >= rampEnd)
+                passed &= output[(size_t)i] == expected;
+            else
+                rampError = std::max(rampError, std::abs(output[(size_t)i] - expected));
+        }
+
+        passed &= rampError < 0.01f;
+        std::cout << (passed ? "PASS " : "FAIL ") << "pre-delay (ramp error " << rampError << " samples)" << std::endl;
+        return passed;
+    }
+
+    // First sample out of the processor, all wet, for an impulse once the stages have settled,
+    // and the processor's bound on it
+    int wetOnset(float delayMs, int* arrival = nullptr)
+    {
+        ReverbProcessor processor;
+        processor.prepare({ testSampleRate, 512, 2 });
+
+        ReverbParameters params;
+        params.mix = 100.0f;
+        params.delay = delayMs;
+        params.diffusion = 100.0f;
+        processor.setParameters(params);
+
+        juce::AudioBuffer<float> buffer(2, 512 * 80);
+        const int impulse = 512 * 10;
+        buffer.clear();
+        buffer.setSample(0, impulse, 1.0f);
+        buffer.setSample(1, impulse, 1.0f);
+
+        for (int pos = 0; pos < buffer.getNumSamples(); pos += 512)
+        {
+            auto block = juce::dsp::AudioBlock<float>(buffer).getSubBlock((size_t)pos, 512);
+            juce::dsp::ProcessContextReplacing<float> context(block);
+            processor.process(context);
+        }
+
+        if (arrival != nullptr)
+            *arrival = processor.getWetArrivalSamples();
+
+        for (int i = impulse; i < buffer.getNumSamples(); ++i)
+            if (std::abs(buffer.getSample(0, i)) > 1.0e-6f || std::abs(buffer.getSample(1, i)) > 1.0e-6f)
+                return i - impulse;
+
+        return -1;
+    }
+
+    // The pre-delay moves the wet signal by exactly DELAY. The diffusion cascade passes part
+    // of its input straight through, so none of its length may be taken out of the pre-delay.
+    bool testWetOnset()
+    {
+        const int immediate = wetOnset(0.0f), delayed = wetOnset(20.0f);
+        const int expected = (int)(0.02 * testSampleRate);
+
+        bool passed = immediate >= 0 && delayed - immediate == expected;
+        std::cout << (passed ? "PASS " : "FAIL ") << "wet onset moves with the pre-delay (" << delayed - immediate
+                  << " samples for " << expected << ")" << std::endl;
+
+        // All wet behind a long pre-delay, the output is silent until the impulse comes through.
+        // FdnrPipe only takes silence for the end of the tail after getWetArrivalSamples().
+        int arrival = 0;
+        const int late = wetOnset(500.0f, &arrival);
+        const bool bounded = late >= (int)(0.5 * testSampleRate) && late <= arrival;
+        std::cout << (bounded ? "PASS " : "FAIL ") << "wet arrival bound (onset " << late << ", bound " << arrival
+                  << " samples)" << std::endl;
+        return passed && bounded;
+    }
+
+    // The fused output kernels give the bits of the separate passes, and the block peak
+    bool testOutputKernels()
+    {
+        const int length = 77; // full runs of peak lanes and a remainder
+        std::array<std::vector<float>, 2> dry, wet;
+        juce::Random random(5);
+        for (int ch = 0; ch < 2; ++ch)
+        {
+            for (int i = 0; i < length; ++i)
+            {
+                dry[(size_t)ch].push_back(random.nextFloat() * 2.0f - 1.0f);
+                wet[(size_t)ch].push_back(random.nextFloat() * 4.0f - 2.0f);
+            }
+        }
+        wet[0][3] = -0.0f; // full wet copies, signs of zeros included
+
+        const auto& baseline = DSPKernels::getBaseline();
+        bool passed = true;
+
+        for (auto* kernels : { &baseline, DSPKernels::getVariant(DSPKernels::Isa::avx2), DSPKernels::getVariant(DSPKernels::Isa::avx512) })
+        {
+            if (kernels == nullptr)
+                continue;
+
+            for (float wetGain : { 0.3f, 1.0f })
+            {
+                const float dryGain = 1.0f - wetGain;
+
+                auto separate = dry;
+                auto wetCopy = wet;
+                baseline.midSide(wetCopy[0].data(), wetCopy[1].data(), 1.2f, 0.7f, length);
+                float expectedPeak = 0.0f;
+                for (int ch = 0; ch < 2; ++ch)
+                {
+                    if (wetGain == 1.0f)
+                        separate[(size_t)ch] = wetCopy[(size_t)ch];
+                    else
+                        baseline.mix(separate[(size_t)ch].data(), wetCopy[(size_t)ch].data(), dryGain, wetGain, length);
+
+                    for (auto x : separate[(size_t)ch])
+                        expectedPeak = std::max(expectedPeak, std::abs(x));
+                }
+
+                auto fused = dry;
+                const auto peak = kernels->mixMidSidePeak(fused[0].data(), fused[1].data(), wet[0].data(), wet[1].data(),
+                                                          1.2f, 0.7f, dryGain, wetGain, length);
+
+                auto plain = dry[0];
+                const auto plainPeak = kernels->mixPeak(plain.data(), wet[0].data(), dryGain, wetGain, length);
+                auto plainExpected = dry[0];
+                if (wetGain == 1.0f)
+                    plainExpected = wet[0];
+                else
+                    baseline.mix(plainExpected.data(), wet[0].data(), dryGain, wetGain, length);
+
+                float plainExpectedPeak = 0.0f;
+                for (auto x : plainExpected)
+                    plainExpectedPeak = std::max(plainExpectedPeak, std::abs(x));
+
+                auto sameBits = [](const std::vector<float>& a, const std::vector<float>& b)
+                {
+                    return std::memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0;
+                };
+
+                passed &= sameBits(fused[0], separate[0]) && sameBits(fused[1], separate[1]) && peak == expectedPeak
+                          && sameBits(plain, plainExpected) && plainPeak == plainExpectedPeak;
+            }
+        }
+
+        std::cout << (passed ? "PASS " : "FAIL ") << "fused output kernels" << std::endl;
+        return passed;
+    }
+
+    // Rings come out zeroed, each on its own cache lines, in the order they were reserved
+    bool testDelayArena()
+    {
+        DelayArena arena;
+        DelayMemory first, half, last;
+        arena.beginLayout();
+        first.reserve(arena, DelayStorage::float32, 100); // 400 bytes, 448 with padding
+        half.reserve(arena, DelayStorage::float16, 33);   // 66 bytes, 128 with padding
+        last.reserve(arena, DelayStorage::float32, 3);
+        arena.allocate();
+
+        auto address = [](float* p) { return reinterpret_cast<size_t>(p); };
+        bool passed = address(first.getFloats()) % DelayArena::alignment == 0
+                      && address(last.getFloats()) - address(first.getFloats()) == 448 + 128
+                      && arena.getBytes() == 448 + 128 + 64;
+
+        std::vector<float> samples(33, 1.0f);
+        half.read(samples.data(), 20, 33);
+        passed &= std::all_of(samples.begin(), samples.end(), [](float x) { return x == 0.0f; });
+
+        std::cout << (passed ? "PASS " : "FAIL ") << "delay arena (" << arena.getBytes() << " bytes)" << std::endl;
+        return passed;
+    }
+
+    // Steps down only under sustained load, and back up only after a long quiet stretch
+    bool testQualityController()
+    {
+        QualityController controller;
+        const double block = 1.0 / 128.0; // exact sums
+
+        auto run = [&](double load, double seconds)
+        {
+            for (int i = 0; i < juce::roundToInt(seconds / block); ++i)
+                controller.update(load, block);
+            return controller.getTier();
+        };
+
+        bool passed = run(0.9, 0.1) == QualityController::full;      // a spike
+        passed &= run(0.1, 0.1) == QualityController::full;
+        passed &= run(0.9, 0.25) == QualityController::reduced;
+        passed &= run(0.9, 0.25) == QualityController::low;
+        passed &= run(0.9, 1.0) == QualityController::low;           // no tier below
+        passed &= run(0.45, 10.0) == QualityController::low;         // between the thresholds
+        passed &= run(0.1, 2.9) == QualityController::low;
+        passed &= run(0.1, 0.1) == QualityController::reduced;
+        passed &= run(0.1, 3.0) == QualityController::full;
+
+        std::cout << (passed ? "PASS " : "FAIL ") << "quality controller" << std::endl;
+        return passed;
+    }
+
+    // Four dynamic EQ bands run as lanes must add up to the four bands run one at a time
+    bool testDynamicEqBands()
+    {
+        const int length = 4800;
+        juce::AudioBuffer<float> input(2, length);
+        std::vector<float> detector((size_t)length);
+        juce::Random random(5);
+
+        for (int i = 0; i < length; ++i)
+        {
+            // Loud enough in the second half to push every band past its threshold
+            const float level = i < length / 2 ? 0.05f : 0.8f;
+            for (int ch = 0; ch < 2; ++ch)
+                input.setSample(ch, i, level * (random.nextFloat() * 2.0f - 1.0f));
+            detector[(size_t)i] = std::max(std::abs(input.getSample(0, i)), std::abs(input.getSample(1, i)));
+        }
+
+        MultiBandDynamicEq::Band bands[MultiBandDynamicEq::maxBands];
+        const float frequencies[] = { 150.0f, 700.0f, 3000.0f, 9000.0f };
+        for (int b = 0; b < MultiBandDynamicEq::maxBands; ++b)
+        {
+            bands[b].frequency = frequencies[b];
+            bands[b].resonance = 0.7f + (float)b;
+            bands[b].gain = 2.0f - (float)b;
+            bands[b].depth = -6.0f;
+            bands[b].threshold = -30.0f;
+        }
+
+        auto run = [&](juce::AudioBuffer<float>& buffer, int firstBand, int numBands)
+        {
+            MultiBandDynamicEq eq;
+            eq.prepare({ testSampleRate, 64, 2 });
+            eq.setNumBands(numBands);
+            for (int b = 0; b < numBands; ++b)
+                eq.setBand(b, bands[firstBand + b]);
+
+            for (int pos = 0; pos < length; pos += 64)
+                eq.process(juce::dsp::AudioBlock<float>(buffer).getSubBlock((size_t)pos, 64), detector.data() + pos);
+        };
+
+        juce::AudioBuffer<float> together;
+        together.makeCopyOf(input);
+        run(together, 0, MultiBandDynamicEq::maxBands);
+
+        // Input plus what each band adds on its own
+        juce::AudioBuffer<float> separate;
+        separate.makeCopyOf(input);
+
+        for (int b = 0; b < MultiBandDynamicEq::maxBands; ++b)
+        {
+            juce::AudioBuffer<float> single;
+            single.makeCopyOf(input);
+            run(single, b, 1);
+
+            for (int ch = 0; ch < 2; ++ch)
+                for (int i = 0; i < length; ++i)
+                    separate.addSample(ch, i, single.getSample(ch, i) - input.getSample(ch, i));
+        }
+
+        // The sums are rounded in a different order
+        const auto diff = maxDifference(separate, together);
+        const bool passed = diff <= 1.0e-5f;
+
+        std::cout << (passed ? "PASS " : "FAIL ") << "dynamic EQ band lanes (max difference " << diff << ")" << std::endl;
+        return passed;
+    }
+
+    // A NaN in the input is kept out of the output and the reverb comes back on its own, and
+    // a tail left to ring out never decays into denormals, with FTZ/DAZ off as they are here
+    bool testRecovery()
+    {
+        const int blockSize = 512, length = 48000 * 12;
+
+        ReverbProcessor processor;
+        processor.prepare({ testSampleRate, (juce::uint32)blockSize, 2 });
+        processor.reset();
+
+        ReverbParameters params;
+        params.feedback = 0.0f;
+        params.mix = 50.0f;
+        processor.setParameters(params);
+
+        juce::AudioBuffer<float> buffer(2, blockSize);
+        juce::Random random(3);
+        bool finite = true, recovered = false, denormals = false;
+
+        for (int pos = 0; pos < length; pos += blockSize)
+        {
+            buffer.clear();
+
+            // Noise for a second, with a NaN at the start of it and an infinity later on
+            if (pos < 48000)
+                for (int ch = 0; ch < 2; ++ch)
+                    for (int i = 0; i < blockSize; ++i)
+                        buffer.setSample(ch, i, 0.5f * (random.nextFloat() * 2.0f - 1.0f));
+
+            if (pos == 0)
+                buffer.setSample(0, 7, std::numeric_limits<float>::quiet_NaN());
+
+            if (pos == blockSize * 40)
+                buffer.setSample(1, 300, std::numeric_limits<float>::infinity());
+
+            juce::dsp::AudioBlock<float> block(buffer);
+            juce::dsp::ProcessContextReplacing<float> context(block);
+            processor.process(context);
+
+            for (int ch = 0; ch < 2; ++ch)
+            {
+                for (int i = 0; i < blockSize; ++i)
+                {
+                    const auto x = buffer.getSample(ch, i);
+                    finite &= std::isfinite(x);
+                    denormals |= std::fpclassify(x) == FP_SUBNORMAL;
+
+                    // The wet signal carries on after the infinity
+                    recovered |= pos > blockSize * 41 && pos < 48000 && std::abs(x) > 0.1f;
+                }
+            }
+        }
+
+        const auto recoveries = processor.getRecoveryCount();
+        const bool passed = finite && recovered && ! denormals && recoveries == 0;
+
+        std::cout << (passed ? "PASS " : "FAIL ") << "non-finite input and denormals (" << recoveries << " recoveries"
+                  << (finite ? "" : ", non-finite output") << (recovered ? "" : ", no wet signal")
+                  << (denormals ? ", denormal output" : "") << ")" << std::endl;
+        return passed;
+    }
+
+    // Peak of the output over numBlocks blocks of 512, with noise or silence going in
+    float processBlocks(ReverbProcessor& processor, int numBlocks, bool noise)
+    {
+        juce::AudioBuffer<float> buffer(2, 512);
+        juce::Random random(5);
+        float peak = 0.0f;
+
+        for (int b = 0; b < numBlocks; ++b)
+        {
+            buffer.clear();
+            if (noise)
+                for (int ch = 0; ch < 2; ++ch)
+                    for (int i = 0; i < 512; ++i)
+                        buffer.setSample(ch, i, 0.5f * (random.nextFloat() * 2.0f - 1.0f));
+
+            juce::dsp::AudioBlock<float> block(buffer);
+            juce::dsp::ProcessContextReplacing<float> context(block);
+            processor.process(context);
+            peak = std::max(peak, buffer.getMagnitude(0, 512));
+        }
+
+        return peak;
+    }
+
+    // Going all dry clears the wet chain, so raising the mix again doesn't bring back a tail
+    // from before
+    // clear() with a full tail going: once its fades are over, silence in gives silence out
+    bool testClearEmpties()
+    {
+        ReverbProcessor processor;
+        processor.prepare({ testSampleRate, 512, 2 });
+
+        auto params = makeTestParameters();
+        params.mix = 100.0f;
+        processor.setParameters(params);
+        const float tailPeak = processBlocks(processor, 100, true);
+
+        // Fade out, amortised zeroing and fade in all fit in the first half second
+        processor.clear();
+        processBlocks(processor, 50, false);
+        const float peak = processBlocks(processor, 20, false);
+
+        const bool passed = tailPeak > 0.01f && peak < juce::Decibels::decibelsToGain(-120.0f, -200.0f);
+        std::cout << (passed ? "PASS " : "FAIL ") << "clear empties the reverb (peak after "
+                  << juce::Decibels::gainToDecibels(peak, -400.0f) << " dB)" << std::endl;
+        return passed;
+    }
+
+    bool testAllDryClears()
+    {
+        ReverbProcessor processor;
+        processor.prepare({ testSampleRate, 512, 2 });
+
+        auto params = makeTestParameters();
+        params.mix = 100.0f;
+        processor.setParameters(params);
+        const float tailPeak = processBlocks(processor, 100, true);
+
+        // Half a second dry, then wet again with nothing going in
+        params.mix = 0.0f;
+        processor.setParameters(params);
+        processBlocks(processor, 50, false);
+
+        params.mix = 100.0f;
+        processor.setParameters(params);
+        const float peak = processBlocks(processor, 20, false);
+
+        const bool passed = tailPeak > 0.01f && peak < juce::Decibels::decibelsToGain(-120.0f, -200.0f);
+        std::cout << (passed ? "PASS " : "FAIL ") << "all dry clears the wet chain (peak after "
+                  << juce::Decibels::gainToDecibels(peak, -400.0f) << " dB)" << std::endl;
+        return passed;
+    }
+
+    // Every FastMath function within its documented bound over its whole range, against libm
+    // in double precision
+    bool testFastMath()
+    {
+        bool passed = true;
+        const int numPoints = 1000000;
+
+        // Worst error over evenly spread points, relative to the reference or absolute.
+        // logarithmic spreads them evenly over the decades instead.
+        auto check = [&](const char* name, double from, double to, double bound, bool relative, bool logarithmic,
+                         float (*approximation)(float), double (*reference)(double))
+        {
+            double worst = 0.0;
+
+            for (int i = 0; i <= numPoints; ++i)
+            {
+                const auto position = from + (to - from) * i / numPoints;
+                const auto x = (float)(logarithmic ? std::pow(10.0, position) : position);
+                const auto expected = reference((double)x);
+                auto error = std::abs((double)approximation(x) - expected);
+                if (relative)
+                    error /= std::abs(expected);
+                worst = std::max(worst, error);
+            }
+
+            const bool ok = worst < bound;
+            if (! ok)
+                std::cout << "    " << name << ": error " << worst << ", bound " << bound << std::endl;
+            passed &= ok;
+        };
+
+        check("exp2", -126.0, 126.0, 2.0e-7, true, false, FastMath::exp2, [](double x) { return std::exp2(x); });
+        check("exp", -10.0, 10.0, 6.0e-7, true, false, FastMath::exp, [](double x) { return std::exp(x); });
+        check("exp", -87.0, 87.0, 5.0e-6, true, false, FastMath::exp, [](double x) { return std::exp(x); });
+        check("log2", -5.0, 5.0, 1.2e-6, false, true, FastMath::log2, [](double x) { return std::log2(x); });
+        check("log2", -37.9, 38.0, 5.0e-6, false, true, FastMath::log2, [](double x) { return std::log2(x); });
+        check("gainToDecibels", -5.0, 5.0, 1.5e-5, false, true, [](float x) { return FastMath::gainToDecibels(x); },
+              [](double x) { return 20.0 * std::log10(x); });
+        check("decibelsToGain", -99.999, 100.0, 1.0e-6, true, false, [](float x) { return FastMath::decibelsToGain(x); },
+              [](double x) { return std::pow(10.0, x / 20.0); });
+        check("tanh", -20.0, 20.0, 2.0e-7, false, false, FastMath::tanh, [](double x) { return std::tanh(x); });
+        check("sin", -256.0, 256.0, 3.0e-7, false, false, FastMath::sin, [](double x) { return std::sin(x); });
+
+        // The edges that follow juce::Decibels
+        passed &= FastMath::gainToDecibels(0.0f) == -100.0f && FastMath::gainToDecibels(-1.0f, -80.0f) == -80.0f
+                  && FastMath::decibelsToGain(-100.0f) == 0.0f && FastMath::tanh(-2.0f) == -FastMath::tanh(2.0f);
+
+        std::cout << (passed ? "PASS " : "FAIL ") << "fast math error bounds" << std::endl;
+        return passed;
+    }
+
+    // The velvet tail of an impulse stays finite, decays, and gives the channels apart sequences
+    bool testVelvetTail()
+    {
+        const int length = 48000, blockSize = 32;
+
+        DelayArena arena;
+        VelvetTail tail;
+        arena.beginLayout();
+        tail.prepare({ testSampleRate, (juce::uint32)blockSize, 2 }, arena);
+        arena.allocate();
+
+        VelvetTail::Parameters parameters;
+        parameters.roomSize = 0.5f;
+        parameters.wetLevel = 1.0f;
+        parameters.dryLevel = 0.0f;
+        tail.setParameters(parameters);
+
+        juce::AudioBuffer<float> buffer(2, length);
+        buffer.clear();
+        buffer.setSample(0, 0, 1.0f);
+        buffer.setSample(1, 0, 1.0f);
+
+        for (int pos = 0; pos < length; pos += blockSize)
+            tail.process(juce::dsp::AudioBlock<float>(buffer).getSubBlock((size_t)pos, blockSize));
+
+        // Energy of each channel and their correlation over a stretch
+        auto measure = [&](int start, int end, double& correlation)
+        {
+            double left = 0.0, right = 0.0, product = 0.0;
+            for (int i = start; i < end; ++i)
+            {
+                const double l = buffer.getSample(0, i), r = buffer.getSample(1, i);
+                left += l * l;
+                right += r * r;
+                product += l * r;
+            }
+            correlation = product / std::sqrt(left * right + 1.0e-30);
+            return left + right;
+        };
+
+        double correlation = 0.0, lateCorrelation = 0.0;
+        const auto early = measure(4800, 14400, correlation);
+        const auto late = measure(length - 9600, length, lateCorrelation);
+
+        bool finite = true;
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = 0; i < length; ++i)
+                finite &= std::isfinite(buffer.getSample(ch, i));
+
+        const bool passed = finite && early > 1.0e-4 && late < early * 0.1 && std::abs(correlation) < 0.5;
+
+        std::cout << (passed ? "PASS " : "FAIL ") << "velvet tail (decay " << juce::Decibels::gainToDecibels((float)std::sqrt(late / early))
+                  << " dB, correlation " << correlation << ")" << std::endl;
+        return passed;
+    }
+
+    // Combs faded out by load shedding are zeroed over the following blocks. Brought back half
+    // way through that, they must still start from silence: the same as combs that were shed
+    // before anything went in, once the allpasses have forgotten the fade.
+    bool testReleasedCombs()
+    {
+        const int length = 48000, blockSize = 32;
+        const int shedAt = 9600, restoreAt = 12512, compareFrom = 36000;
+
+        DelayArena arena;
+        ReverbTail shed, reference;
+        arena.beginLayout();
+        shed.prepare({ testSampleRate, (juce::uint32)blockSize, 2 }, arena);
+        reference.prepare({ testSampleRate, (juce::uint32)blockSize, 2 }, arena);
+        arena.allocate();
+
+        ReverbTail::Parameters parameters;
+        parameters.roomSize = 0.5f;
+        parameters.wetLevel = 1.0f;
+        parameters.dryLevel = 0.0f;
+        shed.setParameters(parameters);
+        reference.setParameters(parameters);
+        reference.setReducedLines(true);
+
+        juce::AudioBuffer<float> input(2, length), shedOutput(2, length), referenceOutput(2, length);
+        juce::Random random(9);
+        input.clear();
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = 4800; i < length; ++i)
+                input.setSample(ch, i, 0.5f * (random.nextFloat() * 2.0f - 1.0f));
+
+        shedOutput.makeCopyOf(input);
+        referenceOutput.makeCopyOf(input);
+
+        for (int pos = 0; pos < length; pos += blockSize)
+        {
+            if (pos == shedAt)
+                shed.setReducedLines(true);
+
+            if (pos == restoreAt)
+            {
+                shed.setReducedLines(false);
+                reference.setReducedLines(false);
+            }
+
+            shed.process(juce::dsp::AudioBlock<float>(shedOutput).getSubBlock((size_t)pos, blockSize));
+            reference.process(juce::dsp::AudioBlock<float>(referenceOutput).getSubBlock((size_t)pos, blockSize));
+        }
+
+        float difference = 0.0f;
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = compareFrom; i < length; ++i)
+                difference = std::max(difference, std::abs(shedOutput.getSample(ch, i) - referenceOutput.getSample(ch, i)));
+
+        const float peak = referenceOutput.getMagnitude(compareFrom, length - compareFrom);
+        const bool passed = peak > 0.01f && difference < peak * 1.0e-5f;
+        std::cout << (passed ? "PASS " : "FAIL ") << "shed combs restored from silence (difference "
+                  << juce::Decibels::gainToDecibels(difference / peak, -400.0f) << " dB)" << std::endl;
+        return passed;
+    }
+
+    // The ring must hand over every event in order while a consumer drains it concurrently,
+    // and drop, not overwrite, when it is full
+    bool testEventLog()
+    {
+        EventLog log;
+        log.push(EventLog::Type::clear, 0);
+        bool passed = log.drain([](const EventLog::Event&) {}) == 0; // disabled
+
+        log.setEnabled(true);
+
+        const int numEvents = 200000;
+        std::atomic<bool> done { false };
+
+        std::thread producer([&] {
+            for (int i = 0; i < numEvents; ++i)
+            {
+                log.push(EventLog::Type::overrun, i, i);
+
+                // Bursts, like blocks
+                if (i % 256 == 255)
+                    std::this_thread::yield();
+            }
+            done = true;
+        });
+
+        // Events the consumer is too slow for are dropped, everything else must come through
+        int received = 0, last = -1;
+        bool inOrder = true;
+        auto check = [&](const EventLog::Event& e) {
+            inOrder &= e.intValue > last && e.ticks == e.intValue;
+            last = e.intValue;
+            ++received;
+        };
+
+        while (! done)
+            log.drain(check);
+
+        producer.join();
+        log.drain(check);
+
+        passed &= inOrder && received + (int)log.takeDroppedCount() == numEvents;
+
+        for (uint32_t i = 0; i < EventLog::capacity + 10; ++i)
+            log.push(EventLog::Type::modeChange, 0, (int)i);
+
+        int first = -1, count = 0;
+        log.drain([&](const EventLog::Event& e) { if (count++ == 0) first = e.intValue; });
+        passed &= count == (int)EventLog::capacity && first == 0 && log.takeDroppedCount() == 10;
+
+        std::cout << (passed ? "PASS " : "FAIL ") << "event log (" << received << " of " << numEvents << " events through)" << std::endl;
+        return passed;
+    }
+
+    // A capture replayed block for block through a fresh processor must give back the captured
+    // output exactly. Once the rings wrap, only blocks still whole in them may be offered.
+    bool testFlightRecorder()
+    {
+        const auto file = juce::File::getSpecialLocation(juce::File::tempDirectory).getChildFile("fdnr-flight-test.fdnrrec");
+        const juce::dsp::ProcessSpec spec { testSampleRate, 512, 2 };
+        const int length = testLength;
+
+        // A sine of the absolute frame, so any block's input can be checked, with the captured
+        // parameters changing and a clear on the way
+        auto record = [&](double seconds)
+        {
+            FlightRecorder recorder;
+            if (! recorder.open(file, spec, DelayStorage::float32, seconds))
+                return false;
+
+            ReverbProcessor processor;
+            processor.prepare(spec);
+
+            auto params = makeTestParameters();
+            juce::AudioBuffer<float> buffer(2, 512);
+            juce::Random random(77);
+
+            for (int pos = 0, blockIndex = 0; pos < length; ++blockIndex)
+            {
+                const int len = std::min(length - pos, 1 + random.nextInt(512));
+                for (int ch = 0; ch < 2; ++ch)
+                    for (int i = 0; i < len; ++i)
+                        buffer.setSample(ch, i, 0.5f * (float)std::sin(0.01 * (pos + i) + ch));
+
+                params.feedback = blockIndex % 200 < 100 ? 80.0f : 40.0f;
+                params.mode = (blockIndex / 50) % 3;
+                processor.setParameters(params);
+
+                int flags = 0;
+                if (blockIndex == 150)
+                {
+                    processor.clear();
+                    flags |= FlightRecorder::clearFlag;
+                }
+
+                juce::dsp::AudioBlock<float> block(buffer.getArrayOfWritePointers(), 2, 0, (size_t)len);
+                juce::dsp::ProcessContextReplacing<float> context(block);
+                recorder.recordInput(block, params, flags);
+                processor.process(context);
+                recorder.recordOutput(block);
+                pos += len;
+            }
+
+            return true;
+        };
+
+        // Largest difference of the replayed output, -1 if a block's input isn't the one recorded
+        auto replay = [](const FlightRecording& recording)
+        {
+            ReverbProcessor processor;
+            processor.prepare({ recording.getSampleRate(), (juce::uint32)recording.getMaxBlockSize(), 2 });
+
+            juce::AudioBuffer<float> buffer(2, 512), captured(2, 512);
+            float diff = 0.0f;
+
+            for (auto i = recording.getFirstBlock(); i < recording.getEndBlock(); ++i)
+            {
+                const auto block = recording.getBlock(i);
+                recording.readAudio(block, false, buffer);
+                recording.readAudio(block, true, captured);
+
+                for (int ch = 0; ch < 2; ++ch)
+                    for (int s = 0; s < block.numSamples; ++s)
+                        if (buffer.getSample(ch, s) != 0.5f * (float)std::sin(0.01 * (double)(block.firstFrame + (uint64_t)s) + ch))
+                            return -1.0f;
+
+                processor.setParameters(block.params);
+                if ((block.flags & FlightRecorder::clearFlag) != 0)
+                    processor.clear();
+
+                juce::dsp::AudioBlock<float> audioBlock(buffer.getArrayOfWritePointers(), 2, 0, (size_t)block.numSamples);
+                juce::dsp::ProcessContextReplacing<float> context(audioBlock);
+                processor.process(context);
+
+                for (int ch = 0; ch < 2; ++ch)
+                    for (int s = 0; s < block.numSamples; ++s)
+                        diff = std::max(diff, std::abs(buffer.getSample(ch, s) - captured.getSample(ch, s)));
+            }
+
+            return diff;
+        };
+
+        FlightRecording whole, wrapped;
+        bool passed = record(10.0) && whole.open(file) && whole.startsAtPrepare();
+        const float wholeDiff = passed ? replay(whole) : -1.0f;
+        passed &= wholeDiff == 0.0f;
+
+        // Half a second of a two second session
+        passed &= record(0.5) && wrapped.open(file) && ! wrapped.startsAtPrepare();
+        uint64_t windowFrames = 0;
+        if (passed)
+        {
+            const auto last = wrapped.getBlock(wrapped.getEndBlock() - 1);
+            windowFrames = last.firstFrame + (uint64_t)last.numSamples - wrapped.getBlock(wrapped.getFirstBlock()).firstFrame;
+            passed &= windowFrames >= 24000 && windowFrames <= 24512 && replay(wrapped) >= 0.0f;
+        }
+
+        file.deleteFile();
+
+        std::cout << (passed ? "PASS " : "FAIL ") << "flight recorder (replay difference " << wholeDiff << ", wrapped window "
+                  << windowFrames << " frames)" << std::endl;
+        return passed;
+    }
+    // The C API must give what ReverbProcessor gives with the same settings, whatever the
+    // block size it is handed
+    bool testCApi()
+    {
+        const int length = testLength;
+        juce::AudioBuffer<float> input(2, length);
+        for (int ch = 0; ch < 2; ++ch)
+            for (int i = 0; i < length; ++i)
+                input.setSample(ch, i, 0.5f * (float)std::sin(0.01 * i + ch));
+
+        const char* ids[] = { "MIX", "FEEDBACK", "NOT_A_PARAMETER" };
+        const float values[] = { 70.0f, 80.0f, 1.0f };
+
+        auto* reverb = fdnr_create();
+        bool passed = reverb != nullptr && fdnr_prepare(reverb, testSampleRate, 256, 2) == 0
+                   && fdnr_set_mode(reverb, 3) == 0 && fdnr_set_params(reverb, ids, values, 3) == 1
+                   && fdnr_set_mode(reverb, ReverbModes::numModes) == -1
+                   && fdnr_set_params(nullptr, ids, values, 3) == -1 && fdnr_set_params(reverb, nullptr, values, 3) == -1
+                   && fdnr_set_params(reverb, ids, values, -1) == -1;
+
+        // Longer than prepared, so it is split
+        juce::AudioBuffer<float> output(input);
+        for (int pos = 0; passed && pos < length; pos += 1000)
+        {
+            float* channels[] = { output.getWritePointer(0, pos), output.getWritePointer(1, pos) };
+            passed &= fdnr_process_planar(reverb, channels, 2, std::min(1000, length - pos)) == 0;
+        }
+
+        ReverbProcessor processor;
+        processor.prepare({ testSampleRate, 256, 2 });
+        passed &= fdnr_get_latency(reverb) == processor.getLatencySamples();
+        fdnr_destroy(reverb);
+
+        auto settings = ReverbModes::getSettings(3);
+        settings.push_back({ "MODE", 3.0f });
+        settings.push_back({ "MIX", 70.0f });
+        settings.push_back({ "FEEDBACK", 80.0f });
+
+        processor.setParameters(ReverbParameters::fromParameterValues([&](juce::StringRef id, float fallback) {
+            for (auto it = settings.rbegin(); it != settings.rend(); ++it)
+                if (std::strcmp(id, it->parameterID) == 0)
+                    return it->value;
+            return fallback;
+        }));
+
+        juce::AudioBuffer<float> reference(input);
+        for (int pos = 0; pos < length; pos += 256)
+        {
+            juce::dsp::AudioBlock<float> block(reference.getArrayOfWritePointers(), 2, (size_t)pos, (size_t)std::min(256, length - pos));
+            juce::dsp::ProcessContextReplacing<float> context(block);
+            processor.process(context);
+        }
+
+        return passed && expectMatch("C API", reference, output);
+    }
+}
+
+int main()
+{
+    bool passed = true;
+
+    std::cout << "Selected kernels: " << DSPKernels::get().name << std::endl;
+
+    const RenderOptions defaults;
+    auto reference = render(defaults);
+
+    // Each variant this CPU can run must match the baseline
+    for (auto isa : { DSPKernels::Isa::avx2, DSPKernels::Isa::avx512 })
+    {
+        if (auto* kernels = DSPKernels::getVariant(isa))
+            passed &= expectMatch(juce::String(kernels->name) + " kernels", reference, render(withKernels(defaults, *kernels)));
+        else
+            std::cout << "SKIP variant " << (int)isa << " (not available)" << std::endl;
+    }
+
+    // Output must not depend on the host block size
+    for (int blockSize : { 1, 37, 4096 })
+        passed &= expectMatch("host block size " + juce::String(blockSize), reference, render(withBlockSize(defaults, blockSize)));
+
+    // Same for the reduced-rate tail
+    RenderOptions eco;
+    eco.eco = 2;
+    auto ecoReference = render(eco);
+    for (int blockSize : { 1, 37 })
+        passed &= expectMatch("eco, host block size " + juce::String(blockSize), ecoReference, render(withBlockSize(eco, blockSize)));
+
+    // And for the offline profile, with its oversampling and per-sample ramps
+    RenderOptions offline;
+    offline.quality = ReverbProcessor::Quality::offline;
+    auto offlineReference = render(offline);
+    for (int blockSize : { 1, 37 })
+        passed &= expectMatch("offline, host block size " + juce::String(blockSize), offlineReference, render(withBlockSize(offline, blockSize)));
+
+    // And through an amortised clear
+    RenderOptions clear;
+    clear.clearHalfWay = true;
+    auto clearReference = render(clear);
+    for (int blockSize : { 1, 37 })
+        passed &= expectMatch("clear, host block size " + juce::String(blockSize), clearReference, render(withBlockSize(clear, blockSize)));
+
+    // And through load shedding down to the half rate tail
+    RenderOptions shed;
+    shed.qualityTierHalfWay = QualityController::low;
+    auto shedReference = render(shed);
+    for (int blockSize : { 1, 37 })
+        passed &= expectMatch("load shedding, host block size " + juce::String(blockSize), shedReference, render(withBlockSize(shed, blockSize)));
+
+    // And with 16-bit delay memory, whose dither must follow the samples, not the blocks
+    for (auto storage : { DelayStorage::float16, DelayStorage::int16 })
+    {
+        const auto name = juce::String(storage == DelayStorage::float16 ? "float16" : "int16") + " storage";
+        RenderOptions compact;
+        compact.storage = storage;
+        auto storageReference = render(compact);
+
+        if (auto* kernels = DSPKernels::getVariant(DSPKernels::Isa::avx2))
+            passed &= expectMatch(name + ", AVX2 kernels", storageReference, render(withKernels(compact, *kernels)));
+
+        for (int blockSize : { 1, 37 })
+            passed &= expectMatch(name + ", host block size " + juce::String(blockSize), storageReference,
+                                  render(withBlockSize(compact, blockSize)));
+    }
+
+    // And with the velvet tail, through its kernels
+    RenderOptions velvet;
+    velvet.engine = 1;
+    auto velvetReference = render(velvet);
+    for (auto isa : { DSPKernels::Isa::avx2, DSPKernels::Isa::avx512 })
+        if (auto* kernels = DSPKernels::getVariant(isa))
+            passed &= expectMatch(juce::String("velvet, ") + kernels->name + " kernels", velvetReference,
+                                  render(withKernels(velvet, *kernels)));
+
+    for (int blockSize : { 1, 37 })
+        passed &= expectMatch("velvet, host block size " + juce::String(blockSize), velvetReference,
+                              render(withBlockSize(velvet, blockSize)));
+
+    passed &= testLimiter();
+    passed &= testDelayStorage();
+    passed &= testDelayArena();
+    passed &= testPreDelay();
+    passed &= testWetOnset();
+    passed &= testOutputKernels();
+    passed &= testQualityController();
+
+    // Lane groups of 2, and of 4 + 2
+    for (int numChannels : { 2, 6 })
+        passed &= testLaneFilters(numChannels);
+
+    passed &= testDynamicEqBands();
+    passed &= testVelvetTail();
+    passed &= testReleasedCombs();
+    passed &= testFastMath();
+    passed &= testRecovery();
+    passed &= testClearEmpties();
+    passed &= testAllDryClears();
+    passed &= testEventLog();
+    passed &= testFlightRecorder();
+    passed &= testCApi();
+
+    return passed ? 0 : 1;
+}
@@ -2,6 +2,7 @@
 #include <juce_audio_processors/juce_audio_processors.h>
 #include "../Source/PluginProcessor.h"
 #include "../Source/PluginEditor.h"
+#include <iostream>
 // cmake --build build --config Debug --target ScreenshotTest
 class ScreenshotTestApp : public juce::JUCEApplication
 {
@@ -15,6 +16,10 @@ public:
     {
         // Create the plugin
         auto plugin = std::make_unique<FDNRAudioProcessor>();
+
+        // Editor open time, the first one pays for the font lookups
+        timeEditorOpen(*plugin, "first open");
+        timeEditorOpen(*plugin, "second open");
         
         // Create the editor
         // Note: createEditor returns a pointer that we own (usually) or is managed by the processor?
@@ -38,6 +43,10 @@ public:
         
         // Force a repaint/layout
         editor->setVisible(true);
+
+        // Controls are built after the first paint, build them all now for the snapshot
+        if (auto* fdnrEditor = dynamic_cast<FDNRAudioProcessorEditor*>(editor))
+            fdnrEditor->finishBuilding();
         
         // We might need to let the message loop run for a moment if there are async updates?
         // But for a simple snapshot, it might be immediate.
@@ -89,6 +98,26 @@ public:
     }
 
     void shutdown() override {}
+
+private:
+    // Constructor, first paint (what the user waits for) and the deferred control groups
+    static void timeEditorOpen(FDNRAudioProcessor& plugin, const char* name)
+    {
+        auto start = juce::Time::getMillisecondCounterHiRes();
+        std::unique_ptr<juce::AudioProcessorEditor> editor(plugin.createEditor());
+        auto constructed = juce::Time::getMillisecondCounterHiRes();
+
+        editor->setVisible(true);
+        editor->createComponentSnapshot(editor->getLocalBounds());
+        auto painted = juce::Time::getMillisecondCounterHiRes();
+
+        if (auto* fdnrEditor = dynamic_cast<FDNRAudioProcessorEditor*>(editor.get()))
+            fdnrEditor->finishBuilding();
+        auto built = juce::Time::getMillisecondCounterHiRes();
+
+        std::cout << "Editor " << name << ": constructor " << constructed - start << " ms, first paint "
+                  << painted - constructed << " ms, controls " << built - painted << " ms" << std::endl;
+    }
 };
 
 START_JUCE_APPLICATION(ScreenshotTestApp)
@@ -0,0 +1,506 @@
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#if JUCE_MAC
+ #include <mach/mach.h>
+#elif JUCE_WINDOWS
+ #include <windows.h>
+ #include <psapi.h>
+ #pragma comment(lib, "psapi.lib")
+#endif
+// cmake --build build --config Release --target StressHost
+// Loads the built VST3 N times and runs the instances from a thread pool, the way a DAW runs a
+// parallel graph, while the message thread automates them. Reports per-callback times, deadline
+// misses and memory growth.
+//
+//   StressHost [--plugin <path>] [--instances 1-512] [--threads N] [--seconds S]
+//              [--rate Hz] [--block N] [--events-per-second N] [--report-interval S]
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct Options
+    {
+        juce::String pluginPath { FDNR_VST3_PATH };
+        int numInstances = 16;
+        int numThreads = juce::jmax(1, (int)std::thread::hardware_concurrency() - 1);
+        double seconds = 30.0;
+        double sampleRate = 48000.0;
+        int blockSize = 256;
+        double eventsPerSecond = 200.0;
+        double reportInterval = 10.0;
+    };
+
+    Options parseOptions(const juce::StringArray& args)
+    {
+        Options options;
+
+        for (int i = 0; i + 1 < args.size(); i += 2)
+        {
+            const auto& name = args[i];
+            const auto& value = args[i + 1];
+
+            if (name == "--plugin")                 options.pluginPath = value;
+            else if (name == "--instances")         options.numInstances = value.getIntValue();
+            else if (name == "--threads")           options.numThreads = value.getIntValue();
+            else if (name == "--seconds")           options.seconds = value.getDoubleValue();
+            else if (name == "--rate")              options.sampleRate = value.getDoubleValue();
+            else if (name == "--block")             options.blockSize = value.getIntValue();
+            else if (name == "--events-per-second") options.eventsPerSecond = value.getDoubleValue();
+            else if (name == "--report-interval")   options.reportInterval = value.getDoubleValue();
+            else std::cerr << "Ignoring unknown option " << name << std::endl;
+        }
+
+        options.numInstances = juce::jlimit(1, 512, options.numInstances);
+        options.numThreads = juce::jlimit(1, 64, options.numThreads);
+        options.blockSize = juce::jlimit(16, 8192, options.blockSize);
+        return options;
+    }
+
+    // Resident set size of this process, 0 where it can't be read
+    size_t getResidentBytes()
+    {
+       #if JUCE_LINUX
+        auto status = juce::File("/proc/self/status").loadFileAsString();
+        auto line = status.fromFirstOccurrenceOf("VmRSS:", false, false).upToFirstOccurrenceOf("\n", false, false);
+        return (size_t)line.trim().getLargeIntValue() * 1024;
+       #elif JUCE_MAC
+        mach_task_basic_info info;
+        mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+        if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) == KERN_SUCCESS)
+            return (size_t)info.resident_size;
+        return 0;
+       #elif JUCE_WINDOWS
+        PROCESS_MEMORY_COUNTERS counters;
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+            return (size_t)counters.WorkingSetSize;
+        return 0;
+       #else
+        return 0;
+       #endif
+    }
+
+    double toMegabytes(size_t bytes) { return (double)bytes / (1024.0 * 1024.0); }
+
+    // Times in microseconds, 1 us buckets up to 100 ms. Each thread fills its own.
+    struct Histogram
+    {
+        static constexpr int numBuckets = 100000;
+
+        std::vector<juce::uint64> counts = std::vector<juce::uint64>((size_t)numBuckets + 1, 0);
+        juce::uint64 total = 0;
+        double maxMicros = 0.0;
+
+        void add(double micros)
+        {
+            counts[(size_t)juce::jlimit(0, numBuckets, (int)micros)]++;
+            total++;
+            maxMicros = juce::jmax(maxMicros, micros);
+        }
+
+        void merge(const Histogram& other)
+        {
+            for (size_t i = 0; i < counts.size(); ++i)
+                counts[i] += other.counts[i];
+
+            total += other.total;
+            maxMicros = juce::jmax(maxMicros, other.maxMicros);
+        }
+
+        double percentile(double p) const
+        {
+            auto target = (juce::uint64)std::ceil(p * (double)total);
+            juce::uint64 seen = 0;
+
+            for (size_t i = 0; i < counts.size(); ++i)
+            {
+                seen += counts[i];
+                if (seen >= target && seen > 0)
+                    return (double)i;
+            }
+
+            return maxMicros;
+        }
+    };
+
+    struct Instance
+    {
+        std::unique_ptr<juce::AudioPluginInstance> plugin;
+        juce::AudioBuffer<float> buffer;
+        juce::MidiBuffer midi;
+        int noisePosition = 0;
+
+        // Host-side automation targets, found by name
+        juce::Array<juce::AudioProcessorParameter*> automatable;
+        juce::AudioProcessorParameter* mode = nullptr;
+
+        // A/B compare the way a DAW does it, by swapping two saved states
+        juce::MemoryBlock otherState;
+    };
+
+    //==============================================================================
+    // One audio thread drives the cycle, the pool's helpers and the audio thread itself take
+    // instances off a shared counter until the whole graph for the block has run
+    class Graph
+    {
+    public:
+        Graph(std::vector<Instance>& instancesToRun, const Options& options)
+            : instances(instancesToRun),
+              budget(std::chrono::duration<double>(options.blockSize / options.sampleRate)),
+              threadHistograms((size_t)options.numThreads)
+        {
+            // A few seconds of noise, read at a different offset by each instance
+            juce::Random random(42);
+            noise.resize((size_t)(options.sampleRate * 4.0));
+            for (auto& sample : noise)
+                sample = (random.nextFloat() * 2.0f - 1.0f) * 0.25f;
+
+            for (int i = 0; i < (int)instances.size(); ++i)
+                instances[(size_t)i].noisePosition = (i * 7919) % (int)(noise.size() - (size_t)options.blockSize);
+
+            numHelpers = options.numThreads - 1;
+        }
+
+        ~Graph() { stop(); }
+
+        void start()
+        {
+            running = true;
+
+            for (int i = 0; i < numHelpers; ++i)
+                threads.emplace_back([this, i] { helperLoop(threadHistograms[(size_t)i + 1]); });
+
+            threads.emplace_back([this] { audioLoop(); });
+        }
+
+        void stop()
+        {
+            running = false;
+
+            for (auto& thread : threads)
+                thread.join();
+
+            threads.clear();
+        }
+
+        juce::int64 getNumCycles() const { return numCycles.load(); }
+        juce::int64 getNumDeadlineMisses() const { return numMisses.load(); }
+        juce::int64 getNumNonFiniteBlocks() const { return numNonFinite.load(); }
+
+        // Only valid once stopped
+        Histogram getCallbackTimes() const
+        {
+            Histogram result;
+            for (auto& histogram : threadHistograms)
+                result.merge(histogram);
+            return result;
+        }
+
+        const Histogram& getCycleTimes() const { return cycleTimes; }
+
+    private:
+        void audioLoop()
+        {
+            auto deadline = Clock::now();
+
+            while (running)
+            {
+                const auto cycleStart = Clock::now();
+
+                // done first, nothing can be taken until next is reset
+                done = 0;
+                next = 0;
+                generation.fetch_add(1, std::memory_order_release);
+
+                runAvailable(threadHistograms[0]);
+
+                while (done.load(std::memory_order_acquire) < (int)instances.size())
+                    std::this_thread::yield();
+
+                const std::chrono::duration<double, std::micro> cycleTime = Clock::now() - cycleStart;
+                cycleTimes.add(cycleTime.count());
+                numCycles++;
+
+                // A cycle that takes longer than its block is a dropout. Like a driver, the
+                // schedule restarts from now after one instead of trying to catch up.
+                deadline += std::chrono::duration_cast<Clock::duration>(budget);
+                if (Clock::now() > deadline)
+                {
+                    numMisses++;
+                    deadline = Clock::now();
+                }
+                else
+                {
+                    std::this_thread::sleep_until(deadline);
+                }
+            }
+
+            // Release the helpers
+            generation.fetch_add(1, std::memory_order_release);
+        }
+
+        void helperLoop(Histogram& histogram)
+        {
+            auto seen = generation.load(std::memory_order_acquire);
+
+            while (running)
+            {
+                auto current = generation.load(std::memory_order_acquire);
+                if (current == seen)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                seen = current;
+                runAvailable(histogram);
+            }
+        }
+
+        void runAvailable(Histogram& histogram)
+        {
+            for (int index = next++; index < (int)instances.size(); index = next++)
+            {
+                processInstance(instances[(size_t)index], histogram);
+                done.fetch_add(1, std::memory_order_release);
+            }
+        }
+
+        void processInstance(Instance& instance, Histogram& histogram)
+        {
+            auto& buffer = instance.buffer;
+            const int numSamples = buffer.getNumSamples();
+
+            if (instance.noisePosition + numSamples > (int)noise.size())
+                instance.noisePosition = 0;
+
+            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                buffer.copyFrom(ch, 0, noise.data() + instance.noisePosition, numSamples);
+            instance.noisePosition += numSamples;
+
+            // Held like AudioProcessorPlayer does, so resets and state loads can suspend the instance
+            const juce::ScopedLock lock(instance.plugin->getCallbackLock());
+
+            if (instance.plugin->isSuspended())
+            {
+                buffer.clear();
+                return;
+            }
+
+            const auto start = Clock::now();
+            instance.plugin->processBlock(buffer, instance.midi);
+            const std::chrono::duration<double, std::micro> elapsed = Clock::now() - start;
+            histogram.add(elapsed.count());
+
+            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            {
+                auto range = juce::FloatVectorOperations::findMinAndMax(buffer.getReadPointer(ch), numSamples);
+                if (! std::isfinite(range.getStart()) || ! std::isfinite(range.getEnd()))
+                {
+                    numNonFinite++;
+                    break;
+                }
+            }
+        }
+
+        std::vector<Instance>& instances;
+        std::vector<float> noise;
+        const std::chrono::duration<double> budget;
+        int numHelpers = 0;
+
+        std::atomic<bool> running { false };
+        std::atomic<juce::uint64> generation { 0 };
+        std::atomic<int> next { 0 }, done { 0 };
+        std::atomic<juce::int64> numCycles { 0 }, numMisses { 0 }, numNonFinite { 0 };
+
+        std::vector<Histogram> threadHistograms;
+        Histogram cycleTimes;
+        std::vector<std::thread> threads;
+    };
+
+    //==============================================================================
+    // Automation, mode changes, A/B toggles, clears and state save/load, weighted towards
+    // automation as in a typical session
+    void applyRandomEvent(Instance& instance, juce::Random& random)
+    {
+        auto& plugin = *instance.plugin;
+        const int roll = random.nextInt(100);
+
+        if (roll < 85 && ! instance.automatable.isEmpty())
+        {
+            auto* parameter = instance.automatable[random.nextInt(instance.automatable.size())];
+            parameter->beginChangeGesture();
+            parameter->setValueNotifyingHost(random.nextFloat());
+            parameter->endChangeGesture();
+        }
+        else if (roll < 90 && instance.mode != nullptr)
+        {
+            instance.mode->setValueNotifyingHost(random.nextFloat());
+        }
+        else if (roll < 95)
+        {
+            juce::MemoryBlock current;
+            plugin.getStateInformation(current);
+
+            if (instance.otherState.getSize() > 0)
+                plugin.setStateInformation(instance.otherState.getData(), (int)instance.otherState.getSize());
+
+            instance.otherState = std::move(current);
+        }
+        else if (roll < 98)
+        {
+            // The plugin's Clear button isn't reachable from a host, a reset clears the same state
+            plugin.suspendProcessing(true);
+            plugin.reset();
+            plugin.suspendProcessing(false);
+        }
+        else
+        {
+            juce::MemoryBlock state;
+            plugin.getStateInformation(state);
+            plugin.setStateInformation(state.getData(), (int)state.getSize());
+        }
+    }
+
+    std::unique_ptr<juce::AudioPluginInstance> loadPlugin(juce::AudioPluginFormatManager& formatManager,
+                                                         const Options& options, juce::String& error)
+    {
+        juce::OwnedArray<juce::PluginDescription> types;
+
+        for (auto* format : formatManager.getFormats())
+            if (format->fileMightContainThisPluginType(options.pluginPath))
+                format->findAllTypesForFile(types, options.pluginPath);
+
+        if (types.isEmpty())
+        {
+            error = "no plugin found in " + options.pluginPath;
+            return nullptr;
+        }
+
+        return formatManager.createPluginInstance(*types[0], options.sampleRate, options.blockSize, error);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::StringArray args;
+    for (int i = 1; i < argc; ++i)
+        args.add(argv[i]);
+
+    const auto options = parseOptions(args);
+
+    juce::AudioPluginFormatManager formatManager;
+    formatManager.addDefaultFormats();
+
+    std::cout << "Loading " << options.numInstances << " instances of " << options.pluginPath << std::endl;
+
+    const auto residentBeforeLoad = getResidentBytes();
+    std::vector<Instance> instances((size_t)options.numInstances);
+
+    for (auto& instance : instances)
+    {
+        juce::String error;
+        instance.plugin = loadPlugin(formatManager, options, error);
+
+        if (instance.plugin == nullptr)
+        {
+            std::cerr << "Failed to load plugin: " << error << std::endl;
+            return 1;
+        }
+
+        auto& plugin = *instance.plugin;
+        plugin.setPlayConfigDetails(2, 2, options.sampleRate, options.blockSize);
+        plugin.setNonRealtime(false);
+        plugin.prepareToPlay(options.sampleRate, options.blockSize);
+
+        instance.buffer.setSize(2, options.blockSize);
+
+        for (auto* parameter : plugin.getParameters())
+        {
+            auto name = parameter->getName(64);
+
+            if (name == "Mode")
+                instance.mode = parameter;
+            else if (name != "A/B" && parameter->isAutomatable())
+                instance.automatable.add(parameter);
+        }
+    }
+
+    const auto residentAfterLoad = getResidentBytes();
+    std::cout << "Loaded, " << toMegabytes(residentAfterLoad > residentBeforeLoad ? residentAfterLoad - residentBeforeLoad : 0)
+              << " MB for all instances" << std::endl
+              << "Running " << options.seconds << " s on " << options.numThreads << " threads, "
+              << options.blockSize << " samples at " << options.sampleRate << " Hz ("
+              << 1000.0 * options.blockSize / options.sampleRate << " ms per callback)" << std::endl;
+
+    Graph graph(instances, options);
+    graph.start();
+
+    // Memory growth is measured from after the first report, once every instance has run a while
+    juce::Random random(1234);
+    const auto start = Clock::now();
+    const auto eventInterval = 1000.0 / juce::jmax(1.0, options.eventsPerSecond);
+    size_t residentBaseline = 0;
+    double nextReport = options.reportInterval;
+    double elapsed = 0.0;
+
+    while (elapsed < options.seconds)
+    {
+        applyRandomEvent(instances[(size_t)random.nextInt(options.numInstances)], random);
+
+        // Let the plugins' async updates run, as a DAW's message thread would
+        juce::MessageManager::getInstance()->runDispatchLoopUntil((int)eventInterval);
+        elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+        if (elapsed >= nextReport)
+        {
+            const auto resident = getResidentBytes();
+            if (residentBaseline == 0)
+                residentBaseline = resident;
+
+            std::cout << juce::String(elapsed, 1) << " s: " << graph.getNumCycles() << " cycles, "
+                      << graph.getNumDeadlineMisses() << " deadline misses, "
+                      << toMegabytes(resident) << " MB resident ("
+                      << (resident >= residentBaseline ? "+" : "-")
+                      << toMegabytes(resident >= residentBaseline ? resident - residentBaseline : residentBaseline - resident)
+                      << " MB)" << std::endl;
+
+            nextReport += options.reportInterval;
+        }
+    }
+
+    graph.stop();
+
+    const auto callbacks = graph.getCallbackTimes();
+    const auto& cycles = graph.getCycleTimes();
+    const auto budgetMicros = 1.0e6 * options.blockSize / options.sampleRate;
+    const auto residentEnd = getResidentBytes();
+
+    std::cout << std::endl
+              << "Callback time (us): p50 " << callbacks.percentile(0.5) << ", p99 " << callbacks.percentile(0.99)
+              << ", max " << callbacks.maxMicros << " over " << callbacks.total << " callbacks" << std::endl
+              << "Graph cycle time (us): p50 " << cycles.percentile(0.5) << ", p99 " << cycles.percentile(0.99)
+              << ", max " << cycles.maxMicros << ", budget " << budgetMicros << std::endl
+              << "Deadline misses: " << graph.getNumDeadlineMisses() << " of " << graph.getNumCycles() << " cycles" << std::endl;
+
+    if (residentBaseline > 0)
+        std::cout << "Memory growth since first report: "
+                  << (residentEnd >= residentBaseline ? toMegabytes(residentEnd - residentBaseline) : 0.0) << " MB" << std::endl;
+
+    if (graph.getNumNonFiniteBlocks() > 0)
+    {
+        std::cout << "FAIL " << graph.getNumNonFiniteBlocks() << " blocks with NaN or Inf output" << std::endl;
+        return 1;
+    }
+
+    for (auto& instance : instances)
+        instance.plugin->releaseResources();
+
+    return 0;
+}
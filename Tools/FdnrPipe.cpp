@@ -0,0 +1,270 @@
+#include <juce_dsp/juce_dsp.h>
+#include "../Source/ReverbProcessor.h"
+#include <cstdio>
+#include <iostream>
+#if JUCE_WINDOWS
+ #include <fcntl.h>
+ #include <io.h>
+#endif
+// cmake --build build --config Release --target FdnrPipe
+// FdnrPipe [options] < input.pcm > output.pcm
+//
+// Runs raw interleaved PCM from stdin through ReverbProcessor to stdout, a chunk at a time,
+// for use as a stage in a pipeline. All buffers are allocated up front. Nothing more is read
+// until a chunk has been written, so a slow reader downstream holds the pipe up rather than
+// letting memory grow. At the end of the input the tail is played out, and the output is
+// shifted back by the limiter's latency so it lines up with the input.
+
+namespace
+{
+    // Flush at the end stops once a chunk is all below this, or after the --tail limit. Only
+    // chunks after the wet signal can have arrived count, see getWetArrivalSamples().
+    constexpr float silenceThreshold = 1.0e-5f;
+
+    enum class SampleFormat { float32, int16 };
+
+    struct Options
+    {
+        double sampleRate = 48000.0;
+        int numChannels = 2;
+        int chunkFrames = 1024;
+        double tailSeconds = 10.0;
+        SampleFormat format = SampleFormat::float32;
+        ReverbProcessor::Quality quality = ReverbProcessor::Quality::realtime;
+        juce::String presetPath;
+        juce::StringArray overrides;
+    };
+
+    void printUsage()
+    {
+        std::cerr << "usage: FdnrPipe [options] < input.pcm > output.pcm\n"
+                     "  --rate <Hz>               sample rate (48000)\n"
+                     "  --channels <1|2>          interleaved channels (2)\n"
+                     "  --format <f32|s16>        native-endian float32 or int16 samples (f32)\n"
+                     "  --chunk <frames>          frames read and written at a time (1024)\n"
+                     "  --preset <file.json>      preset saved from the plugin\n"
+                     "  --set <ID>=<value>        a parameter by its ID, over the preset, e.g. MIX=30\n"
+                     "  --tail <seconds>          longest tail played out after the input ends (10)\n"
+                     "  --quality <realtime|offline>  processing profile (realtime)\n";
+    }
+
+    bool parseOptions(int argc, char* argv[], Options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const juce::String arg(argv[i]);
+            if (i + 1 >= argc)
+                return false;
+
+            const juce::String value(argv[++i]);
+
+            if (arg == "--rate")
+                options.sampleRate = value.getDoubleValue();
+            else if (arg == "--channels")
+                options.numChannels = value.getIntValue();
+            else if (arg == "--chunk")
+                options.chunkFrames = value.getIntValue();
+            else if (arg == "--tail")
+                options.tailSeconds = value.getDoubleValue();
+            else if (arg == "--preset")
+                options.presetPath = value;
+            else if (arg == "--set" && value.containsChar('='))
+                options.overrides.add(value);
+            else if (arg == "--format" && (value == "f32" || value == "s16"))
+                options.format = value == "f32" ? SampleFormat::float32 : SampleFormat::int16;
+            else if (arg == "--quality" && (value == "realtime" || value == "offline"))
+                options.quality = value == "offline" ? ReverbProcessor::Quality::offline : ReverbProcessor::Quality::realtime;
+            else
+                return false;
+        }
+
+        return options.sampleRate >= 8000.0 && options.sampleRate <= 384000.0
+            && options.numChannels >= 1 && options.numChannels <= 2
+            && options.chunkFrames >= 1 && options.chunkFrames <= 65536
+            && options.tailSeconds >= 0.0;
+    }
+
+    // Preset values, then the --set overrides, by parameter ID
+    bool makeParameters(const Options& options, ReverbParameters& params)
+    {
+        juce::var values;
+
+        if (options.presetPath.isNotEmpty())
+        {
+            const auto file = juce::File::getCurrentWorkingDirectory().getChildFile(options.presetPath);
+            values = juce::JSON::parse(file).getProperty("parameters", juce::var());
+
+            if (! values.isObject())
+            {
+                std::cerr << options.presetPath << ": not a preset" << std::endl;
+                return false;
+            }
+        }
+
+        params = ReverbParameters::fromParameterValues([&](juce::StringRef id, float fallback) {
+            for (const auto& setting : options.overrides)
+                if (setting.upToFirstOccurrenceOf("=", false, false) == juce::String(id))
+                    return setting.fromFirstOccurrenceOf("=", false, false).getFloatValue();
+
+            return (float)values.getProperty(juce::Identifier(juce::String(id)), fallback);
+        });
+
+        return true;
+    }
+
+    void decode(const char* raw, SampleFormat format, int numChannels, int numFrames, juce::AudioBuffer<float>& buffer)
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto* dest = buffer.getWritePointer(ch);
+
+            if (format == SampleFormat::float32)
+            {
+                const auto* source = reinterpret_cast<const float*>(raw) + ch;
+                for (int i = 0; i < numFrames; ++i)
+                    dest[i] = source[i * numChannels];
+            }
+            else
+            {
+                const auto* source = reinterpret_cast<const int16_t*>(raw) + ch;
+                for (int i = 0; i < numFrames; ++i)
+                    dest[i] = (float)source[i * numChannels] * (1.0f / 32768.0f);
+            }
+        }
+    }
+
+    void encode(const juce::AudioBuffer<float>& buffer, int startFrame, int numFrames, SampleFormat format, int numChannels, char* raw)
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const auto* source = buffer.getReadPointer(ch, startFrame);
+
+            if (format == SampleFormat::float32)
+            {
+                auto* dest = reinterpret_cast<float*>(raw) + ch;
+                for (int i = 0; i < numFrames; ++i)
+                    dest[i * numChannels] = source[i];
+            }
+            else
+            {
+                auto* dest = reinterpret_cast<int16_t*>(raw) + ch;
+                for (int i = 0; i < numFrames; ++i)
+                    dest[i * numChannels] = (int16_t)std::lrint(juce::jlimit(-1.0f, 1.0f, source[i]) * 32767.0f);
+            }
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    ReverbParameters params;
+
+    if (! parseOptions(argc, argv, options))
+    {
+        printUsage();
+        return 2;
+    }
+
+    if (! makeParameters(options, params))
+        return 2;
+
+   #if JUCE_WINDOWS
+    _setmode(_fileno(stdin), _O_BINARY);
+    _setmode(_fileno(stdout), _O_BINARY);
+   #endif
+
+    const int numChannels = options.numChannels;
+    const int chunkFrames = options.chunkFrames;
+    const size_t frameBytes = (size_t)numChannels * (options.format == SampleFormat::float32 ? sizeof(float) : sizeof(int16_t));
+    const size_t chunkBytes = frameBytes * (size_t)chunkFrames;
+
+    std::vector<char> inputBytes(chunkBytes), outputBytes(chunkBytes);
+    juce::AudioBuffer<float> buffer(numChannels, chunkFrames);
+
+    // Whole chunks through stdio, no line buffering on either side
+    std::setvbuf(stdin, nullptr, _IOFBF, chunkBytes);
+    std::setvbuf(stdout, nullptr, _IOFBF, chunkBytes);
+
+    ReverbProcessor processor;
+    processor.prepare({ options.sampleRate, (juce::uint32)chunkFrames, (juce::uint32)numChannels });
+    processor.setQuality(options.quality);
+    processor.setParameters(params);
+
+    juce::ScopedNoDenormals noDenormals;
+
+    const int latency = processor.getLatencySamples();
+    int framesToSkip = latency;
+    bool inputEnded = false;
+    juce::int64 flushFrames = 0, flushedFrames = 0, wetArrival = 0;
+
+    while (! inputEnded || flushFrames > 0)
+    {
+        int numFrames = 0;
+
+        if (! inputEnded)
+        {
+            // fread only comes back short at the end of the input, or on an error
+            const auto bytesRead = std::fread(inputBytes.data(), 1, chunkBytes, stdin);
+            if (bytesRead < chunkBytes && std::ferror(stdin))
+            {
+                std::cerr << "FdnrPipe: error reading the input" << std::endl;
+                return 1;
+            }
+
+            numFrames = (int)(bytesRead / frameBytes);
+            decode(inputBytes.data(), options.format, numChannels, numFrames, buffer);
+
+            if (bytesRead < chunkBytes)
+            {
+                if (bytesRead % frameBytes != 0)
+                    std::cerr << "FdnrPipe: dropped a partial frame at the end of the input" << std::endl;
+
+                inputEnded = true;
+                flushFrames = latency + (juce::int64)(options.tailSeconds * options.sampleRate);
+                wetArrival = processor.getWetArrivalSamples();
+            }
+        }
+
+        // The tail, from silence, in whatever is left of the chunk once the input has ended
+        const int flushStart = numFrames;
+        const auto flushedBefore = flushedFrames;
+        if (inputEnded)
+        {
+            const auto flush = (int)juce::jmin((juce::int64)(chunkFrames - numFrames), flushFrames);
+            for (int ch = 0; ch < numChannels; ++ch)
+                buffer.clear(ch, numFrames, flush);
+
+            numFrames += flush;
+            flushFrames -= flush;
+            flushedFrames += flush;
+        }
+
+        if (numFrames == 0)
+            break;
+
+        auto block = juce::dsp::AudioBlock<float>(buffer).getSubBlock(0, (size_t)numFrames);
+        juce::dsp::ProcessContextReplacing<float> context(block);
+        processor.process(context);
+
+        // Done once the last input has had time to reach the output, through the pre-delay and
+        // the early reflections, and a whole chunk of the tail after that is silent
+        if (flushStart == 0 && flushedBefore >= wetArrival && buffer.getMagnitude(0, numFrames) < silenceThreshold)
+            flushFrames = 0;
+
+        const int skip = juce::jmin(framesToSkip, numFrames);
+        framesToSkip -= skip;
+
+        const int framesOut = numFrames - skip;
+        encode(buffer, skip, framesOut, options.format, numChannels, outputBytes.data());
+
+        if (std::fwrite(outputBytes.data(), frameBytes, (size_t)framesOut, stdout) != (size_t)framesOut)
+        {
+            std::cerr << "FdnrPipe: output closed" << std::endl;
+            return 1;
+        }
+    }
+
+    std::fflush(stdout);
+    return 0;
+}
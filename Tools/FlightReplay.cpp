@@ -0,0 +1,129 @@
+#include <juce_dsp/juce_dsp.h>
+#include "../Source/ReverbProcessor.h"
+#include "../Source/FlightRecorder.h"
+#include <iostream>
+// cmake --build build --config Release --target FlightReplay
+// FlightReplay <capture.fdnrrec> [--tolerance <linear>]
+//
+// Feeds a flight recorder capture back through ReverbProcessor, block for block with the
+// captured parameters, and diffs the result against the captured output. A capture that
+// starts at prepare() replays from the same state, so any difference is a reproduction. One
+// whose start was written over began in a state that is lost, so only the part after the
+// reverb has had time to forget it tells anything.
+
+int main(int argc, char* argv[])
+{
+    juce::String path;
+    float tolerance = 0.0f;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const juce::String arg(argv[i]);
+
+        if (arg == "--tolerance" && i + 1 < argc)
+            tolerance = juce::String(argv[++i]).getFloatValue();
+        else if (path.isEmpty() && ! arg.startsWith("--"))
+            path = arg;
+        else
+            path = {};
+    }
+
+    if (path.isEmpty())
+    {
+        std::cerr << "usage: FlightReplay <capture.fdnrrec> [--tolerance <linear>]" << std::endl;
+        return 2;
+    }
+
+    FlightRecording recording;
+    if (! recording.open(juce::File::getCurrentWorkingDirectory().getChildFile(path)))
+    {
+        std::cerr << path << ": " << recording.getError() << std::endl;
+        return 2;
+    }
+
+    const auto first = recording.getFirstBlock();
+    const auto end = recording.getEndBlock();
+    if (first == end)
+    {
+        std::cerr << path << ": no blocks recorded" << std::endl;
+        return 2;
+    }
+
+    // Room for the largest block, hosts can go past the size they prepared with
+    int largestBlock = recording.getMaxBlockSize();
+    for (auto i = first; i < end; ++i)
+        largestBlock = juce::jmax(largestBlock, recording.getBlock(i).numSamples);
+
+    const int numChannels = recording.getNumChannels();
+    const double sampleRate = recording.getSampleRate();
+    const auto startFrame = recording.getBlock(first).firstFrame;
+
+    std::cout << "Capture: " << sampleRate << " Hz, " << numChannels << " channels, " << (end - first) << " blocks, "
+              << (double)(recording.getBlock(end - 1).firstFrame - startFrame) / sampleRate << " s"
+              << (recording.startsAtPrepare() ? ", from prepare" : ", start written over") << std::endl;
+
+    ReverbProcessor processor;
+    processor.setDelayStorage(recording.getDelayStorage());
+    processor.prepare({ sampleRate, (juce::uint32)recording.getMaxBlockSize(), (juce::uint32)numChannels });
+
+    juce::AudioBuffer<float> buffer(numChannels, largestBlock), captured(numChannels, largestBlock);
+    juce::ScopedNoDenormals noDenormals;
+
+    float maxDiff = 0.0f, settledMaxDiff = 0.0f;
+    uint64_t firstDiffBlock = end, lastDiffBlock = end;
+
+    for (auto i = first; i < end; ++i)
+    {
+        const auto block = recording.getBlock(i);
+
+        recording.readAudio(block, false, buffer);
+        recording.readAudio(block, true, captured);
+
+        processor.setParameters(block.params);
+        processor.setQuality((block.flags & FlightRecorder::offlineFlag) != 0 ? ReverbProcessor::Quality::offline
+                                                                                : ReverbProcessor::Quality::realtime);
+        processor.setQualityTier(block.flags >> FlightRecorder::tierShift);
+
+        if ((block.flags & FlightRecorder::clearFlag) != 0)
+            processor.clear();
+
+        auto audioBlock = juce::dsp::AudioBlock<float>(buffer).getSubBlock(0, (size_t)block.numSamples);
+        juce::dsp::ProcessContextReplacing<float> context(audioBlock);
+        processor.process(context);
+
+        float blockDiff = 0.0f;
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int s = 0; s < block.numSamples; ++s)
+                blockDiff = juce::jmax(blockDiff, std::abs(buffer.getSample(ch, s) - captured.getSample(ch, s)));
+
+        maxDiff = juce::jmax(maxDiff, blockDiff);
+
+        // The second half of a capture whose start was lost
+        if (recording.startsAtPrepare() || block.firstFrame - startFrame >= (recording.getBlock(end - 1).firstFrame - startFrame) / 2)
+            settledMaxDiff = juce::jmax(settledMaxDiff, blockDiff);
+
+        if (blockDiff > tolerance)
+        {
+            if (firstDiffBlock == end)
+                firstDiffBlock = i;
+            lastDiffBlock = i;
+        }
+    }
+
+    std::cout << "Max difference: " << maxDiff << " (" << juce::Decibels::gainToDecibels(maxDiff) << " dB)" << std::endl;
+
+    if (firstDiffBlock == end)
+    {
+        std::cout << "Replay matches the capture" << std::endl;
+        return 0;
+    }
+
+    auto timeOf = [&](uint64_t index) { return (double)(recording.getBlock(index).firstFrame - startFrame) / sampleRate; };
+    std::cout << "Differs from block " << firstDiffBlock - first << " (" << timeOf(firstDiffBlock) << " s) to block "
+              << lastDiffBlock - first << " (" << timeOf(lastDiffBlock) << " s)" << std::endl;
+
+    if (! recording.startsAtPrepare())
+        std::cout << "Max difference over the second half: " << settledMaxDiff << std::endl;
+
+    return settledMaxDiff > tolerance ? 1 : 0;
+}